@@ -0,0 +1,155 @@
+#ifndef CYBER_BASE_CHASE_LEV_DEQUE_H_
+#define CYBER_BASE_CHASE_LEV_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "cyber/base/macros.h"
+
+namespace apollo {
+namespace cyber {
+namespace base {
+
+/**
+ * @brief Work-stealing deque of Chase and Lev, with the memory orders of
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.).
+ *
+ * Only the owner thread calls Push and Pop, at the bottom, any thread may
+ * Steal from the top. The array grows when full, the old arrays are kept
+ * until the deque goes away since a thief may still read from them.
+ */
+template <typename T>
+class ChaseLevDeque {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "ChaseLevDeque holds trivially copyable items, e.g. pointers");
+
+ public:
+  explicit ChaseLevDeque(size_t capacity = 256);
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+  ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+  void Push(T item);
+  bool Pop(T* item);
+  bool Steal(T* item);
+
+  size_t Size() const {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+  bool Empty() const { return Size() == 0; }
+
+ private:
+  class Array {
+   public:
+    explicit Array(size_t capacity)
+        : mask_(capacity - 1), items_(new std::atomic<T>[capacity]) {}
+
+    size_t capacity() const { return mask_ + 1; }
+    T Get(int64_t index) const {
+      return items_[static_cast<size_t>(index) & mask_].load(
+          std::memory_order_relaxed);
+    }
+    void Put(int64_t index, T item) {
+      items_[static_cast<size_t>(index) & mask_].store(
+          item, std::memory_order_relaxed);
+    }
+
+   private:
+    size_t mask_;
+    std::unique_ptr<std::atomic<T>[]> items_;
+  };
+
+  Array* Grow(Array* array, int64_t bottom, int64_t top);
+
+  alignas(CACHELINE_SIZE) std::atomic<int64_t> top_;
+  alignas(CACHELINE_SIZE) std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  // owner only, every array ever used, array_ is the last one
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+template <typename T>
+ChaseLevDeque<T>::ChaseLevDeque(size_t capacity) : top_(0), bottom_(0) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  arrays_.emplace_back(new Array(size));
+  array_.store(arrays_.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+void ChaseLevDeque<T>::Push(T item) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const int64_t top = top_.load(std::memory_order_acquire);
+  Array* array = array_.load(std::memory_order_relaxed);
+  if (bottom - top > static_cast<int64_t>(array->capacity()) - 1) {
+    array = Grow(array, bottom, top);
+  }
+  array->Put(bottom, item);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool ChaseLevDeque<T>::Pop(T* item) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Array* array = array_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+  if (top > bottom) {
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+  *item = array->Get(bottom);
+  if (top == bottom) {
+    // the last item, race the thieves for it
+    const bool won = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+template <typename T>
+bool ChaseLevDeque<T>::Steal(T* item) {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom) {
+    return false;
+  }
+  Array* array = array_.load(std::memory_order_acquire);
+  const T stolen = array->Get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return false;
+  }
+  *item = stolen;
+  return true;
+}
+
+template <typename T>
+auto ChaseLevDeque<T>::Grow(Array* array, int64_t bottom, int64_t top)
+    -> Array* {
+  auto bigger = new Array(array->capacity() * 2);
+  for (int64_t i = top; i < bottom; ++i) {
+    bigger->Put(i, array->Get(i));
+  }
+  arrays_.emplace_back(bigger);
+  array_.store(bigger, std::memory_order_release);
+  return bigger;
+}
+
+}  // namespace base
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_BASE_CHASE_LEV_DEQUE_H_
@@ -11,7 +11,7 @@
  * 更倾向于执行条件为真的分支，从而提高程序的执行效率
 */
 #define cyber_likely(x) (__builtin_expect((x), 1))
-#define cyber_unlikely(x) (_builtin_expect(x), 0) 
+#define cyber_unlikely(x) (__builtin_expect((x), 0))
 #else
 #define cyber_likely(x) (x)
 #define cyber_unlikely(x) (x)
@@ -33,7 +33,7 @@
       return true;                                                \
     }                                                        \
     template <typename>                                      \
-    static constexpr bool Test(...) {                        \  
+    static constexpr bool Test(...) {                        \
       return false;                                          \
     }                                                        \
                                                              \
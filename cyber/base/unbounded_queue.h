@@ -1,4 +1,4 @@
-#ifndef CYBER_BASE_UNDOUNDED_QUEUE_H
+#ifndef CYBER_BASE_UNBOUNDED_QUEUE_H_
 #define CYBER_BASE_UNBOUNDED_QUEUE_H_
 
 #include <unistd.h>
@@ -11,6 +11,12 @@ namespace apollo {
 namespace cyber {
 namespace base {
 
+/**
+ * @brief Lock-free unbounded FIFO for many producers and ONE consumer.
+ *
+ * Dequeue must not run on two threads at once. A consumer frees the node it
+ * leaves behind, a second consumer may still be reading it.
+ */
 template <typename T>
 class UnboundedQueue {
   public:
@@ -36,41 +42,46 @@ class UnboundedQueue {
       */
       while (true) {
         if(tail_.compare_exchange_strong(old_tail, node)) {
-          old_tail->next = node;
-          old_tail->release();
+          // counted before the consumer can see the node, so Size never
+          // drops below zero
           size_.fetch_add(1);
+          old_tail->next.store(node, std::memory_order_release);
+          old_tail->release();
           break;
         }
       } 
     }
 
+    // single consumer only, see the class comment
     bool Dequeue(T* element) {
-      Node* old_head = head_.load();
-      Node* head_next = nullptr;
-      do {
-        head_next = old_head->next;
-        if(head_next == nullptr) {
-            return false;
-        }
-      } while(!head_.compare_exchange_strong(old_head, head_next));
+      Node* old_head = head_.load(std::memory_order_relaxed);
+      Node* head_next = old_head->next.load(std::memory_order_acquire);
+      if(head_next == nullptr) {
+        return false;
+      }
+      // head_next stays alive until the next Dequeue releases it
       *element = head_next->data;
+      head_.store(head_next, std::memory_order_release);
       size_.fetch_sub(1);
       old_head->release();
       return true;
     }
     
 
-    size_t Szie() {return size_.load(); }
-    bool Empty() { return size_.load() == }
+    size_t Size() { return size_.load(); }
+    bool Empty() { return size_.load() == 0; }
 
   private:
     struct Node {
+      T data;
       std::atomic<uint32_t> ref_count;
-      Node* next = nullptr;
+      // read by a consumer while the producer links the node
+      std::atomic<Node*> next{nullptr};
       Node() {ref_count.store(2); }
+      // the producer and the consumer both release a node, only the one
+      // that drops the last reference may delete it
       void release() {
-        ref_count.fet_sub(1);
-        if(ref_count.load() == 0) {
+        if(ref_count.fetch_sub(1) == 1) {
           delete this;
         }
       }
@@ -83,11 +94,11 @@ class UnboundedQueue {
       size_.store(0);
     }
 
-    void Destory() {
+    void Destroy() {
       auto iter = head_.load();
       Node* tmp = nullptr;
       while(iter != nullptr) {
-        tmp = iter->next;
+        tmp = iter->next.load();
         delete iter;
         iter = tmp;
       }
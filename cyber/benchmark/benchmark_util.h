@@ -0,0 +1,111 @@
+#ifndef CYBER_BENCHMARK_BENCHMARK_UTIL_H_
+#define CYBER_BENCHMARK_BENCHMARK_UTIL_H_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark/benchmark.h"
+
+namespace apollo {
+namespace cyber {
+namespace benchmark {
+
+/**
+ * @brief Hardware counters of the calling thread for the lifetime of the
+ *        object, reported per iteration as user counters of state
+ *
+ * Construct it right before the benchmark loop. Counters the kernel refuses
+ * (no PMU in a VM, perf_event_paranoid too strict, not Linux) are left out
+ * of the report, the benchmark itself still runs.
+ */
+class PerfEventCounters {
+ public:
+  explicit PerfEventCounters(::benchmark::State* state) : state_(state) {
+#if defined(__linux__)
+    fds_[kCacheMisses] = Open(PERF_COUNT_HW_CACHE_MISSES);
+    fds_[kCacheReferences] = Open(PERF_COUNT_HW_CACHE_REFERENCES);
+    fds_[kInstructions] = Open(PERF_COUNT_HW_INSTRUCTIONS);
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  ~PerfEventCounters() {
+    static const char* const kNames[kCounterNum] = {
+        "cache_misses", "cache_references", "instructions"};
+    for (int i = 0; i < kCounterNum; ++i) {
+      uint64_t value = 0;
+      if (!Read(fds_[i], &value)) {
+        continue;
+      }
+      state_->counters[kNames[i]] = ::benchmark::Counter(
+          static_cast<double>(value), ::benchmark::Counter::kAvgIterations);
+    }
+  }
+
+  PerfEventCounters(const PerfEventCounters&) = delete;
+  PerfEventCounters& operator=(const PerfEventCounters&) = delete;
+
+ private:
+  enum { kCacheMisses = 0, kCacheReferences, kInstructions, kCounterNum };
+
+  static int Open(uint64_t config) {
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+    (void)config;
+    return -1;
+#endif
+  }
+
+  static bool Read(int fd, uint64_t* value) {
+#if defined(__linux__)
+    if (fd < 0) {
+      return false;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    const bool ok = read(fd, value, sizeof(*value)) == sizeof(*value);
+    close(fd);
+    return ok;
+#else
+    (void)fd;
+    (void)value;
+    return false;
+#endif
+  }
+
+  ::benchmark::State* state_;
+  int fds_[kCounterNum] = {-1, -1, -1};
+};
+
+// message of a fixed size for the benchmarks, copied by value
+template <size_t N>
+struct Payload {
+  char data[N];
+};
+
+}  // namespace benchmark
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_BENCHMARK_BENCHMARK_UTIL_H_
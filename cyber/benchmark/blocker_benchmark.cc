@@ -0,0 +1,107 @@
+// Publish and Observe cost of blocker::Blocker and BlockerManager.
+
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/benchmark/benchmark_util.h"
+#include "cyber/blocker/blocker_manager.h"
+
+namespace apollo {
+namespace cyber {
+namespace benchmark {
+namespace {
+
+using blocker::Blocker;
+using blocker::BlockerAttr;
+using blocker::BlockerManager;
+
+// Publish with range(0) subscribers and capacity range(1), the message is
+// copied into a new shared_ptr as in Publish(const MessageType&). Capacity 1
+// takes the keep latest slot.
+template <size_t N>
+void BM_BlockerPublish(::benchmark::State& state) {
+  Blocker<Payload<N>> blocker(
+      BlockerAttr(static_cast<size_t>(state.range(1)), "blocker_publish"));
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    blocker.Subscribe(std::to_string(i),
+                      [](const std::shared_ptr<Payload<N>>& msg) {
+                        ::benchmark::DoNotOptimize(msg->data[0]);
+                      });
+  }
+  const Payload<N> payload = {};
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    blocker.Publish(payload);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * N);
+}
+
+// Observe copies the published queue, range(0) is the capacity
+template <size_t N>
+void BM_BlockerObserve(::benchmark::State& state) {
+  const size_t capacity = static_cast<size_t>(state.range(0));
+  Blocker<Payload<N>> blocker(BlockerAttr(capacity, "blocker_observe"));
+  for (size_t i = 0; i < capacity; ++i) {
+    blocker.Publish(Payload<N>{});
+  }
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    blocker.Observe();
+    ::benchmark::DoNotOptimize(blocker.GetLatestObservedPtr());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Publish by channel name through the manager, with range(0) subscribers
+// and range(1) other channels in the manager
+template <size_t N>
+void BM_BlockerManagerPublish(::benchmark::State& state) {
+  auto manager = BlockerManager::Instance();
+  manager->Reset();
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    manager->GetOrCreateBlocker<Payload<N>>(
+        BlockerAttr(10, "other_channel_" + std::to_string(i)));
+  }
+  const std::string channel = "blocker_manager_publish";
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    manager->Subscribe<Payload<N>>(
+        channel, 10, std::to_string(i),
+        [](const std::shared_ptr<Payload<N>>& msg) {
+          ::benchmark::DoNotOptimize(msg->data[0]);
+        });
+  }
+  const Payload<N> payload = {};
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    manager->Publish<Payload<N>>(channel, payload);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * N);
+  manager->Reset();
+}
+
+#define CYBER_BLOCKER_BENCHMARK(N)                                        \
+  BENCHMARK_TEMPLATE(BM_BlockerPublish, N)                                \
+      ->ArgNames({"subscribers", "capacity"})                             \
+      ->ArgsProduct({{0, 1, 10}, {1, 10}});                               \
+  BENCHMARK_TEMPLATE(BM_BlockerObserve, N)                                \
+      ->ArgName("capacity")                                               \
+      ->RangeMultiplier(10)                                               \
+      ->Range(1, 1000);                                                   \
+  BENCHMARK_TEMPLATE(BM_BlockerManagerPublish, N)                         \
+      ->ArgNames({"subscribers", "channels"})                             \
+      ->ArgsProduct({{0, 1, 10}, {0, 100}})
+
+CYBER_BLOCKER_BENCHMARK(8);
+CYBER_BLOCKER_BENCHMARK(256);
+CYBER_BLOCKER_BENCHMARK(4096);
+
+#undef CYBER_BLOCKER_BENCHMARK
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,90 @@
+// Endpoint lookup by transport::Identity: IdentityMap against the
+// std::unordered_map keyed by the identity bytes as a string, and against
+// std::unordered_map<Identity> with the std::hash specialization.
+// range(0) is the number of endpoints in the table, every iteration looks
+// up one endpoint that is in it.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/benchmark/benchmark_util.h"
+#include "cyber/transport/common/identity.h"
+#include "cyber/transport/common/identity_map.h"
+
+namespace apollo {
+namespace cyber {
+namespace benchmark {
+namespace {
+
+using transport::ID_SIZE;
+using transport::Identity;
+using transport::IdentityMap;
+
+std::vector<Identity> MakeIds(int64_t count) {
+  std::vector<Identity> ids;
+  ids.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    ids.emplace_back(true);
+  }
+  return ids;
+}
+
+void BM_IdentityMapFind(::benchmark::State& state) {
+  const auto ids = MakeIds(state.range(0));
+  IdentityMap<uint64_t> map;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    map.Insert(ids[i], i);
+  }
+  size_t next = 0;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(map.Find(ids[next]));
+    next = next + 1 == ids.size() ? 0 : next + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_UnorderedMapIdentityFind(::benchmark::State& state) {
+  const auto ids = MakeIds(state.range(0));
+  std::unordered_map<Identity, uint64_t> map;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    map.emplace(ids[i], i);
+  }
+  size_t next = 0;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(map.find(ids[next]));
+    next = next + 1 == ids.size() ? 0 : next + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// the key is built from the identity on every lookup, as the endpoint
+// tables keyed by string do
+void BM_UnorderedMapStringFind(::benchmark::State& state) {
+  const auto ids = MakeIds(state.range(0));
+  std::unordered_map<std::string, uint64_t> map;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    map.emplace(std::string(ids[i].data(), ID_SIZE), i);
+  }
+  size_t next = 0;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(
+        map.find(std::string(ids[next].data(), ID_SIZE)));
+    next = next + 1 == ids.size() ? 0 : next + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_IdentityMapFind)->ArgName("endpoints")->Range(16, 16384);
+BENCHMARK(BM_UnorderedMapIdentityFind)->ArgName("endpoints")->Range(16, 16384);
+BENCHMARK(BM_UnorderedMapStringFind)->ArgName("endpoints")->Range(16, 16384);
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,116 @@
+// Load balance of scheduler::SchedulerWorkStealing under bursty components.
+//
+// Every component has the same home worker, as if the static config had
+// put radar and lidar on one processor. One iteration is a burst: each
+// component gets range(2) messages at once, each message spins range(1)
+// microseconds, and the iteration ends when all of them are processed.
+// range(0) turns stealing off (the pinned baseline) or on.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/scheduler/policy/scheduler_work_stealing.h"
+
+namespace apollo {
+namespace cyber {
+namespace benchmark {
+namespace {
+
+using scheduler::SchedulerWorkStealing;
+using scheduler::WorkStealingAttr;
+using scheduler::WorkStealingTaskAttr;
+
+constexpr uint32_t kWorkerNum = 4;
+constexpr int kComponentNum = 8;
+
+void SpinFor(std::chrono::microseconds duration) {
+  const auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+struct SyntheticComponent {
+  std::atomic<int64_t> pending{0};
+  uint64_t task_id = 0;
+};
+
+void BM_SchedulerBurst(::benchmark::State& state) {
+  WorkStealingAttr attr;
+  attr.worker_num = kWorkerNum;
+  attr.enable_steal = state.range(0) != 0;
+  SchedulerWorkStealing sched(attr);
+
+  const std::chrono::microseconds work(state.range(1));
+  const int64_t burst = state.range(2);
+  std::atomic<int64_t> done{0};
+  std::vector<std::unique_ptr<SyntheticComponent>> components;
+  for (int i = 0; i < kComponentNum; ++i) {
+    auto component = std::make_unique<SyntheticComponent>();
+    const std::string name = "component_" + std::to_string(i);
+    component->task_id = SchedulerWorkStealing::TaskId(name);
+    WorkStealingTaskAttr task_attr;
+    task_attr.worker = 0;
+    // half of them stand in for the lidar, which may not wait for radar
+    task_attr.priority = i % 2 == 0 ? scheduler::WS_PRIORITY_HIGH
+                                    : scheduler::WS_PRIORITY_NORMAL;
+    auto raw = component.get();
+    sched.CreateTask(
+        [&sched, &done, raw, work]() {
+          SpinFor(work);
+          done.fetch_add(1, std::memory_order_relaxed);
+          if (raw->pending.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+            sched.NotifyTask(raw->task_id);
+          }
+        },
+        name, task_attr);
+    components.push_back(std::move(component));
+  }
+
+  int64_t expected = 0;
+  for (auto _ : state) {
+    expected += burst * kComponentNum;
+    for (auto& component : components) {
+      component->pending.fetch_add(burst, std::memory_order_acq_rel);
+      sched.NotifyTask(component->task_id);
+    }
+    while (done.load(std::memory_order_acquire) < expected) {
+      std::this_thread::yield();
+    }
+  }
+  sched.Shutdown();
+
+  uint64_t executed_max = 0;
+  uint64_t executed_sum = 0;
+  uint64_t stolen = 0;
+  for (const auto& stats : sched.GetStats()) {
+    executed_max = std::max(executed_max, stats.executed);
+    executed_sum += stats.executed;
+    stolen += stats.stolen;
+  }
+  // 1.0 is a perfect spread, kWorkerNum is everything on one worker
+  state.counters["imbalance"] =
+      executed_sum == 0
+          ? 0.0
+          : static_cast<double>(executed_max) * kWorkerNum / executed_sum;
+  state.counters["stolen_per_burst"] = ::benchmark::Counter(
+      static_cast<double>(stolen), ::benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(expected);
+}
+
+BENCHMARK(BM_SchedulerBurst)
+    ->ArgNames({"steal", "work_us", "burst"})
+    ->ArgsProduct({{0, 1}, {10, 100}, {1, 16}})
+    ->UseRealTime()
+    ->Unit(::benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace cyber
+}  // namespace apollo
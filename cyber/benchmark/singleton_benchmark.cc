@@ -0,0 +1,89 @@
+// Access cost of a singleton once it exists: DECLARE_SINGLETON against the
+// std::call_once accessor it replaced and the function-local static
+// shared_ptr of BlockerManager::Instance. BM_SingletonReset measures a fresh
+// instance per iteration, as a test fixture gets it.
+
+#include <memory>
+#include <mutex>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/benchmark/benchmark_util.h"
+#include "cyber/common/macros.h"
+
+namespace apollo {
+namespace cyber {
+namespace benchmark {
+namespace {
+
+class Counter {
+ public:
+  void Add() { ++count_; }
+
+ private:
+  uint64_t count_ = 0;
+
+  DECLARE_SINGLETON(Counter)
+};
+
+Counter::Counter() {}
+
+class CallOnceCounter {
+ public:
+  static CallOnceCounter* Instance(bool create_if_needed = true) {
+    static CallOnceCounter* instance = nullptr;
+    if (!instance && create_if_needed) {
+      static std::once_flag flag;
+      std::call_once(flag, [&] { instance = new CallOnceCounter(); });
+    }
+    return instance;
+  }
+
+  void Add() { ++count_; }
+
+ private:
+  uint64_t count_ = 0;
+};
+
+class StaticSharedCounter {
+ public:
+  static const std::shared_ptr<StaticSharedCounter>& Instance() {
+    static auto instance = std::make_shared<StaticSharedCounter>();
+    return instance;
+  }
+
+  void Add() { ++count_; }
+
+ private:
+  uint64_t count_ = 0;
+};
+
+template <typename T>
+void BM_Instance(::benchmark::State& state) {
+  T::Instance();
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    auto instance = T::Instance();
+    ::benchmark::DoNotOptimize(instance);
+    ::benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SingletonReset(::benchmark::State& state) {
+  for (auto _ : state) {
+    Counter::Instance()->Add();
+    Counter::Reset();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Instance, Counter)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Instance, CallOnceCounter)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Instance, StaticSharedCounter)->ThreadRange(1, 8);
+BENCHMARK(BM_SingletonReset);
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,79 @@
+// Enqueue/dequeue throughput of base::UnboundedQueue.
+//
+// BM_UnboundedQueueNP1C runs one consumer and threads - 1 producers, which
+// includes 1P1C. There are no multi-consumer cases, the queue allows a
+// single consumer. One iteration is one Enqueue on a producer and one
+// successful Dequeue on the consumer, which spins until it gets an element.
+
+#include <memory>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/base/unbounded_queue.h"
+#include "cyber/benchmark/benchmark_util.h"
+
+namespace apollo {
+namespace cyber {
+namespace benchmark {
+namespace {
+
+template <size_t N>
+base::UnboundedQueue<Payload<N>>* queue = nullptr;
+
+template <size_t N>
+void SetupQueue(const ::benchmark::State&) {
+  queue<N> = new base::UnboundedQueue<Payload<N>>();
+}
+
+template <size_t N>
+void TeardownQueue(const ::benchmark::State&) {
+  delete queue<N>;
+  queue<N> = nullptr;
+}
+
+template <size_t N>
+void BM_UnboundedQueueNP1C(::benchmark::State& state) {
+  // the last thread is the consumer
+  const bool producer = state.thread_index() < state.threads() - 1;
+  Payload<N> payload = {};
+  PerfEventCounters counters(&state);
+  if (producer) {
+    for (auto _ : state) {
+      queue<N>->Enqueue(payload);
+    }
+  } else {
+    for (auto _ : state) {
+      // yield so an oversubscribed machine still runs the producers
+      while (!queue<N>->Dequeue(&payload)) {
+        std::this_thread::yield();
+      }
+      ::benchmark::DoNotOptimize(payload);
+    }
+    // items are the elements that made it through the queue
+    state.SetItemsProcessed(state.iterations());
+  }
+}
+
+// Threads() values of one benchmark are crossed with its args, so the
+// producer count comes from the thread count and not from an arg
+#define CYBER_QUEUE_BENCHMARK(N)                                        \
+  BENCHMARK_TEMPLATE(BM_UnboundedQueueNP1C, N)                          \
+      ->Setup(SetupQueue<N>)                                            \
+      ->Teardown(TeardownQueue<N>)                                      \
+      ->Threads(2)                                                      \
+      ->Threads(3)                                                      \
+      ->Threads(5)                                                      \
+      ->Threads(9)                                                      \
+      ->UseRealTime()
+
+CYBER_QUEUE_BENCHMARK(8);
+CYBER_QUEUE_BENCHMARK(256);
+CYBER_QUEUE_BENCHMARK(4096);
+
+#undef CYBER_QUEUE_BENCHMARK
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace cyber
+}  // namespace apollo
@@ -1,15 +1,23 @@
 #ifndef CYBER_BLOCKER_BLOCKER_H_
 #define CYBER_BLOCKER_BLOCKER_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "cyber/blocker/memory_budget.h"
+#include "cyber/message/message_size.h"
+
 namespace apollo {
 namespace cyber {
 namespace blocker {
@@ -23,25 +31,52 @@ class BlockerBase {
   virtual void ClearPublished() = 0;
   virtual void Observe() = 0;
   virtual bool IsObservedEmpty() const = 0;
+  virtual bool IsPublishedEmpty() const = 0;
   virtual bool Unsubscribe(const std::string& callback_id) = 0;
 
   virtual size_t capacity() const = 0;
   virtual void set_capacity(size_t capacity) = 0;
+  virtual size_t byte_capacity() const = 0;
+  virtual void set_byte_capacity(size_t byte_capacity) = 0;
   virtual const std::string& channel_name() const = 0;
 };
 
 struct BlockerAttr {
-  BlockerAttr() : capacity(10), channel_name("") {}
+  BlockerAttr() : capacity(10), byte_capacity(0), channel_name("") {}
   explicit BlockerAttr(const std::string& channel) 
-      : capacity(10), channel_name(channel) {}
-  explicit BlockerAttr(size_t cap, std::string& channel)
-      : capacity(cap), channel_name(channel) {}
-  explicit BlockerAttr(const BlockerAttr& attr) 
-      : capacity(attr.capacity), channel_name(attr.channel_name) {}
+      : capacity(10), byte_capacity(0), channel_name(channel) {}
+  BlockerAttr(size_t cap, const std::string& channel)
+      : capacity(cap), byte_capacity(0), channel_name(channel) {}
+  BlockerAttr(size_t cap, size_t bytes, const std::string& channel)
+      : capacity(cap), byte_capacity(bytes), channel_name(channel) {}
+  BlockerAttr(const BlockerAttr& attr) 
+      : capacity(attr.capacity),
+        byte_capacity(attr.byte_capacity),
+        channel_name(attr.channel_name) {}
   size_t capacity;
+  // bytes the published history may hold, by message::MessageSize, 0 is no
+  // limit. The newest message is kept even if it alone is larger.
+  size_t byte_capacity;
   std::string channel_name;
 };
 
+/**
+ * @brief Keeps the last `capacity` published messages per channel.
+ *
+ * With capacity 1, the default of Reader, the two lists are replaced by
+ * shared_ptr slots accessed through std::atomic_load/std::atomic_store:
+ * Publish is one store and the latest message getters are one load, none of
+ * them takes msg_mutex_. This is not lock free, libstdc++ guards those
+ * functions with a small pool of mutexes hashed by address, so a store is a
+ * short critical section of its own instead of one shared with every
+ * Observe and getter of the channel. The observed list is still kept so
+ * ObservedBegin/ObservedEnd iterate the same way.
+ *
+ * The published history is charged to the process wide MemoryBudget. It
+ * holds at most `capacity` messages and `byte_capacity` bytes, the oldest
+ * messages go first; over the process budget the channel holding the most
+ * bytes gives up its oldest ones.
+ */
 template <typename T>
 class Blocker : public BlockerBase {
   friend class BlockerManager;
@@ -79,29 +114,73 @@ class Blocker : public BlockerBase {
 
   size_t capacity() const override;
   void set_capacity(size_t capacity) override;
+  size_t byte_capacity() const override;
+  void set_byte_capacity(size_t byte_capacity) override;
   const std::string& channel_name() const override;
 
+  // bytes of the published history, as charged to the MemoryBudget
+  uint64_t published_bytes() const { return account_->bytes(); }
+
  private:
   void Reset() override;
   void Enqueue(const MessagePtr& msg);
+  // an empty message still takes a slot, 0 is no message
+  static size_t SizeOf(const MessagePtr& msg) {
+    return std::max<size_t>(1, message::MessageSize(*msg));
+  }
+  // drops from the back past the limits, with msg_mutex_ held
+  void TrimPublished();
+  void ClearPublishedLocked();
+  // for the MemoryBudget
+  size_t EvictOldest();
   void Notify(const MessagePtr& msg);
+  bool keep_latest() const {
+    return keep_latest_.load(std::memory_order_acquire);
+  }
 
   BlockerAttr attr_;
+  // capacity == 1, the slots below are used instead of the lists
+  std::atomic<bool> keep_latest_;
+  // Enqueues writing the slots, set_capacity waits for them to finish
+  // before it moves the slot into the lists
+  std::atomic<int> slot_writers_;
+  MessagePtr latest_published_;
+  MessagePtr latest_observed_;
   MessageQueue observed_msg_queue_;
   MessageQueue published_msg_queue_;
+  // SizeOf of the published_msg_queue_ messages, in the same order
+  std::deque<size_t> published_sizes_;
+  size_t published_bytes_ = 0;
+  // SizeOf latest_published_, 0 if none
+  std::atomic<size_t> latest_size_;
   mutable std::mutex msg_mutex_;
+  std::unique_ptr<ChannelMemoryAccount> account_;
 
   CallbackMap published_callbacks_;
-  mutable std::mutex cb_mutex;
+  mutable std::mutex cb_mutex_;
+  // lets Notify skip cb_mutex_ when nobody subscribed
+  std::atomic<bool> has_callbacks_;
 
   MessageType dummy_msg_;
 };
 
 template <typename T>
-Blocker<T>::Blocker(const BlockerAttr& attr) : attr_(atrr), dummy_msg_() {}
+Blocker<T>::Blocker(const BlockerAttr& attr)
+    : attr_(attr),
+      keep_latest_(attr.capacity == 1),
+      slot_writers_(0),
+      latest_size_(0),
+      account_(new ChannelMemoryAccount(attr.channel_name,
+                                        [this] { return EvictOldest(); })),
+      has_callbacks_(false),
+      dummy_msg_() {
+  account_->set_byte_capacity(attr.byte_capacity);
+}
 
 template <typename T>
 Blocker<T>::~Blocker() {
+  // first, waits for the MemoryBudget if it is evicting from us
+  account_.reset();
   published_callbacks_.clear();
   observed_msg_queue_.clear();
   published_msg_queue_.clear();
@@ -115,6 +194,10 @@ void Blocker<T>::Publish(const MessageType& msg) {
 template <typename T>
 void Blocker<T>::Publish(const MessagePtr& msg) {
   Enqueue(msg);
+  auto budget = MemoryBudget::Instance();
+  if (budget->ShouldReclaim()) {
+    budget->Reclaim();
+  }
   Notify(msg);
 }
 
@@ -123,11 +206,13 @@ void Blocker<T>::Reset() {
   {
     std::lock_guard<std::mutex> lock(msg_mutex_);
     observed_msg_queue_.clear();
-    published_msg_queue_.clear();
+    std::atomic_store(&latest_observed_, MessagePtr());
+    ClearPublishedLocked();
   }
   {
     std::lock_guard<std::mutex> lock(cb_mutex_);
     published_callbacks_.clear();
+    has_callbacks_.store(false, std::memory_order_release);
   }
 }
 
@@ -135,34 +220,60 @@ template <typename T>
 void Blocker<T>::ClearObserved() {
   std::lock_guard<std::mutex> lock(msg_mutex_);
   observed_msg_queue_.clear();
+  std::atomic_store(&latest_observed_, MessagePtr());
 }
 
 template <typename T>
-void Blocker<T>::ClearObserved() {
+void Blocker<T>::ClearPublished() {
   std::lock_guard<std::mutex> lock(msg_mutex_);
-  observed_msg_queue_.clear();
+  ClearPublishedLocked();
 }
 
 template <typename T>
-void Blocker<T>::ClearPublished() {
-  std::lock_guard<std::mutex> lock(msg_mutex_);
-  published_callbacks_.clear();
+void Blocker<T>::ClearPublishedLocked() {
+  for (size_t size : published_sizes_) {
+    account_->Remove(size, false);
+  }
+  published_msg_queue_.clear();
+  published_sizes_.clear();
+  published_bytes_ = 0;
+  std::atomic_store(&latest_published_, MessagePtr());
+  account_->Replace(latest_size_.exchange(0), 0);
 }
 
 template <typename T>
 void Blocker<T>::Observe() {
-  std::lock_guard<std::mutex> lock(,sg_mutex_);
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  if (keep_latest()) {
+    auto msg = std::atomic_load(&latest_published_);
+    if (msg == nullptr) {
+      observed_msg_queue_.clear();
+    } else if (observed_msg_queue_.size() == 1) {
+      // reuse the list node, Observe runs every cycle
+      observed_msg_queue_.front() = msg;
+    } else {
+      observed_msg_queue_.assign(1, msg);
+    }
+    std::atomic_store(&latest_observed_, std::move(msg));
+    return;
+  }
   observed_msg_queue_ = published_msg_queue_;
 }
 
 template <typename T>
 bool Blocker<T>::IsObservedEmpty() const {
+  if (keep_latest()) {
+    return std::atomic_load(&latest_observed_) == nullptr;
+  }
   std::lock_guard<std::mutex> lock(msg_mutex_);
-  return published_msg_queue_.empty();
+  return observed_msg_queue_.empty();
 }
 
 template <typename T>
 bool Blocker<T>::IsPublishedEmpty() const {
+  if (keep_latest()) {
+    return std::atomic_load(&latest_published_) == nullptr;
+  }
   std::lock_guard<std::mutex> lock(msg_mutex_);
   return published_msg_queue_.empty();
 }
@@ -171,18 +282,22 @@ template <typename T>
 bool Blocker<T>::Subscribe(const std::string& callback_id,
                            const Callback& callback) {
   std::lock_guard<std::mutex> lock(cb_mutex_);
-  if(published_callback_.find(callback_id) != published_callbacks_.end()) {
+  if(published_callbacks_.find(callback_id) != published_callbacks_.end()) {
     return false;
   } 
   published_callbacks_[callback_id] = callback;
+  has_callbacks_.store(true, std::memory_order_release);
   return true;
 }
 
 template <typename T>
 bool Blocker<T>::Unsubscribe(const std::string& callback_id) {
-  std::lock_guard<std::mutex> lock(cb_mutex);
+  std::lock_guard<std::mutex> lock(cb_mutex_);
   //如果成功删除了一个回调函数，则返回1；如果没有找到具有指定回调ID的回调函数，则返回0。
-  return published_callbacks_.erase(callback_id) != 0;
+  const bool erased = published_callbacks_.erase(callback_id) != 0;
+  has_callbacks_.store(!published_callbacks_.empty(),
+                       std::memory_order_release);
+  return erased;
 }
 /**
  * 这部分代码是函数的尾置返回类型声明，用于指定函数返回值的类型。
@@ -191,6 +306,12 @@ bool Blocker<T>::Unsubscribe(const std::string& callback_id) {
 */
 template <typename T>
 auto Blocker<T>::GetLatestObserved() const -> const MessageType& {
+  if (keep_latest()) {
+    // latest_observed_ owns the message until the next Observe, the same
+    // lifetime a list element has
+    auto msg = std::atomic_load(&latest_observed_);
+    return msg == nullptr ? dummy_msg_ : *msg;
+  }
   std::lock_guard<std::mutex> lock(msg_mutex_);
   if(observed_msg_queue_.empty()) {
     return dummy_msg_;
@@ -200,6 +321,9 @@ auto Blocker<T>::GetLatestObserved() const -> const MessageType& {
 
 template <typename T>
 auto Blocker<T>::GetLatestObservedPtr() const -> const MessagePtr {
+  if (keep_latest()) {
+    return std::atomic_load(&latest_observed_);
+  }
   std::lock_guard<std::mutex> lock(msg_mutex_);
   if(observed_msg_queue_.empty()) {
     return nullptr;
@@ -209,6 +333,10 @@ auto Blocker<T>::GetLatestObservedPtr() const -> const MessagePtr {
 
 template <typename T>
 auto Blocker<T>::GetOldestObservedPtr() const -> const MessagePtr {
+  if (keep_latest()) {
+    return std::atomic_load(&latest_observed_);
+  }
+  std::lock_guard<std::mutex> lock(msg_mutex_);
   if(observed_msg_queue_.empty()) {
     return nullptr;
   }
@@ -217,6 +345,10 @@ auto Blocker<T>::GetOldestObservedPtr() const -> const MessagePtr {
 
 template <typename T>
 auto Blocker<T>::GetLatestPublishedPtr() const -> const MessagePtr {
+  if (keep_latest()) {
+    return std::atomic_load(&latest_published_);
+  }
+  std::lock_guard<std::mutex> lock(msg_mutex_);
   if(published_msg_queue_.empty()) {
     return nullptr;
   }
@@ -240,13 +372,94 @@ size_t Blocker<T>::capacity() const {
 
 template <typename T>
 void Blocker<T>::set_capacity(size_t capacity) {
-  std::lock_guard<std::mutex> lock(msg_mutex);
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  const bool was_keep_latest = keep_latest();
   attr_.capacity = capacity;
-  while(published_msg_queue_.size() > capacity) {
+  if (was_keep_latest && capacity != 1) {
+    // new Enqueues go to the lists, the ones already past their check finish
+    // their slot store first, then the slots move back into the lists
+    keep_latest_.store(false, std::memory_order_seq_cst);
+    while (slot_writers_.load(std::memory_order_seq_cst) != 0) {
+      std::this_thread::yield();
+    }
+    auto published = std::atomic_load(&latest_published_);
+    const size_t size = latest_size_.exchange(0);
+    published_msg_queue_.clear();
+    published_sizes_.clear();
+    published_bytes_ = 0;
+    if (published != nullptr) {
+      // the account already holds it
+      published_msg_queue_.push_front(published);
+      published_sizes_.push_front(size);
+      published_bytes_ = size;
+    }
+    std::atomic_store(&latest_published_, MessagePtr());
+    std::atomic_store(&latest_observed_, MessagePtr());
+  } else if (!was_keep_latest && capacity == 1) {
+    // the newest message moves to the slot, the others are dropped
+    while (published_msg_queue_.size() > 1) {
+      account_->Remove(published_sizes_.back(), false);
+      published_msg_queue_.pop_back();
+      published_sizes_.pop_back();
+    }
+    std::atomic_store(&latest_published_,
+                      published_msg_queue_.empty()
+                          ? MessagePtr()
+                          : published_msg_queue_.front());
+    latest_size_.store(
+        published_sizes_.empty() ? 0 : published_sizes_.front());
+    std::atomic_store(&latest_observed_,
+                      observed_msg_queue_.empty()
+                          ? MessagePtr()
+                          : observed_msg_queue_.front());
+    published_msg_queue_.clear();
+    published_sizes_.clear();
+    published_bytes_ = 0;
+    keep_latest_.store(true, std::memory_order_release);
+  }
+  TrimPublished();
+}
+
+template <typename T>
+size_t Blocker<T>::byte_capacity() const {
+  return attr_.byte_capacity;
+}
+
+template <typename T>
+void Blocker<T>::set_byte_capacity(size_t byte_capacity) {
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  attr_.byte_capacity = byte_capacity;
+  account_->set_byte_capacity(byte_capacity);
+  TrimPublished();
+}
+
+template <typename T>
+void Blocker<T>::TrimPublished() {
+  while (published_msg_queue_.size() > attr_.capacity ||
+         (attr_.byte_capacity != 0 && published_msg_queue_.size() > 1 &&
+          published_bytes_ > attr_.byte_capacity)) {
+    const size_t size = published_sizes_.back();
     published_msg_queue_.pop_back();
+    published_sizes_.pop_back();
+    published_bytes_ -= size;
+    account_->Remove(size, true);
   }
 }
 
+template <typename T>
+size_t Blocker<T>::EvictOldest() {
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  if (keep_latest() || published_msg_queue_.size() <= 1) {
+    return 0;
+  }
+  const size_t size = published_sizes_.back();
+  published_msg_queue_.pop_back();
+  published_sizes_.pop_back();
+  published_bytes_ -= size;
+  account_->Remove(size, true);
+  return size;
+}
+
 template <typename T>
 const std::string& Blocker<T>::channel_name() const {
   return attr_.channel_name;
@@ -254,19 +467,42 @@ const std::string& Blocker<T>::channel_name() const {
 
 template <typename T>
 void Blocker<T>::Enqueue(const MessagePtr& msg) {
-  if(attr_.capacity == 0) {
+  const size_t size = SizeOf(msg);
+  while (true) {
+    // either set_capacity sees us in slot_writers_ and waits, or we see its
+    // keep_latest_ = false and take the lists
+    slot_writers_.fetch_add(1, std::memory_order_seq_cst);
+    if (keep_latest_.load(std::memory_order_seq_cst)) {
+      std::atomic_store(&latest_published_, msg);
+      account_->Replace(latest_size_.exchange(size), size);
+      slot_writers_.fetch_sub(1, std::memory_order_release);
+      return;
+    }
+    slot_writers_.fetch_sub(1, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(msg_mutex_);
+    // set_capacity switches to the slots under msg_mutex_
+    if (keep_latest()) {
+      continue;
+    }
+    if (attr_.capacity == 0) {
+      return;
+    }
+    published_msg_queue_.push_front(msg);
+    published_sizes_.push_front(size);
+    published_bytes_ += size;
+    account_->Add(size);
+    TrimPublished();
     return;
   }
-  std::lock_guard<std::mutex> lock(msg_mutex_);
-  published_msg_queue_.push_front(msg);
-  while(published_msg_queue_.size() > attr_.capacity) {
-    published_msg_queue_.pop_back();
-  }
 }
 
 template <typename T>
 void Blocker<T>::Notify(const MessagePtr& msg) {
-  std::lock_guard<std::mutex> lock(cb_mutex);
+  if (!has_callbacks_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cb_mutex_);
   for(const auto& item : published_callbacks_) {
     item.second(msg);
   }
@@ -274,4 +510,6 @@ void Blocker<T>::Notify(const MessagePtr& msg) {
 
 }
 }
-}
\ No newline at end of file
+}
+
+#endif  // CYBER_BLOCKER_BLOCKER_H_
@@ -25,8 +25,8 @@ class BlockerManager {
   }
 
   template <typename T>
-  bool Publish(const std::string channel_name,
-               const typename Blocker<T>::MessgePtr& msg);
+  bool Publish(const std::string& channel_name,
+               const typename Blocker<T>::MessagePtr& msg);
   
   template <typename T>
   bool Publish(const std::string& channel_name,
@@ -60,8 +60,8 @@ class BlockerManager {
 };
 
 template <typename T>
-bool BlockerManager::Publish(const std::string channel_name,
-                     const typename Blocker<T>::MessgePtr& msg){
+bool BlockerManager::Publish(const std::string& channel_name,
+                     const typename Blocker<T>::MessagePtr& msg){
   auto blocker = GetOrCreateBlocker<T>(BlockerAttr(channel_name));
   if((blocker == nullptr)) {
     return false;
@@ -109,7 +109,7 @@ std::shared_ptr<Blocker<T>> BlockerManager::GetBlocker(const std::string&channel
     std::lock_guard<std::mutex> lock(blocker_mutex_);
     auto search = blockers_.find(channel_name);
     if(search != blockers_.end()) {
-        blocker = sd::dynamic_pointer_cast<Blocker<T>>(sercher->second);
+        blocker = std::dynamic_pointer_cast<Blocker<T>>(search->second);
     }
   }
   return blocker;
@@ -117,11 +117,11 @@ std::shared_ptr<Blocker<T>> BlockerManager::GetBlocker(const std::string&channel
 
 template <typename T>
 std::shared_ptr<Blocker<T>> BlockerManager::GetOrCreateBlocker(const BlockerAttr& attr) {
-  std::shared_ptr<Blokcer<T>> blocker = nullptr;
+  std::shared_ptr<Blocker<T>> blocker = nullptr;
   {
-    std::locker_guard<std::mutex>> lock(blocker_mutex_);
+    std::lock_guard<std::mutex> lock(blocker_mutex_);
     auto search = blockers_.find(attr.channel_name);
-    if(search != blocks_.end()) {
+    if(search != blockers_.end()) {
       blocker = std::dynamic_pointer_cast<Blocker<T>>(search->second);
     }else {
       blocker = std::make_shared<Blocker<T>>(attr);
@@ -136,4 +136,6 @@ std::shared_ptr<Blocker<T>> BlockerManager::GetOrCreateBlocker(const BlockerAttr
 
 }
 }
-}
\ No newline at end of file
+}
+
+#endif  // CYBER_BLOCKER_BLOCKER_MANAGER_H_
@@ -0,0 +1,134 @@
+#include "cyber/blocker/memory_budget.h"
+
+#include <algorithm>
+
+namespace apollo {
+namespace cyber {
+namespace blocker {
+
+DEFINE_uint64(blocker_memory_budget, 0,
+              "bytes all blocker histories of the process may hold, 0 is no "
+              "limit");
+
+ChannelMemoryAccount::ChannelMemoryAccount(const std::string& channel_name,
+                                           const EvictFunc& evict_oldest)
+    : channel_name_(channel_name),
+      evict_oldest_(evict_oldest),
+      budget_(MemoryBudget::Instance()) {
+  budget_->Register(this);
+}
+
+ChannelMemoryAccount::~ChannelMemoryAccount() {
+  budget_->Unregister(this);
+  budget_->Charge(-static_cast<int64_t>(bytes()));
+}
+
+void ChannelMemoryAccount::Add(size_t bytes) {
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  const uint64_t messages = messages_.fetch_add(1, std::memory_order_relaxed);
+  budget_->Charge(static_cast<int64_t>(bytes));
+  if (messages > 0) {
+    budget_->MarkReclaimable();
+  }
+}
+
+void ChannelMemoryAccount::Remove(size_t bytes, bool evicted) {
+  bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+  messages_.fetch_sub(1, std::memory_order_relaxed);
+  budget_->Charge(-static_cast<int64_t>(bytes));
+  if (evicted) {
+    evicted_messages_.fetch_add(1, std::memory_order_relaxed);
+    evicted_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+
+void ChannelMemoryAccount::Replace(size_t old_bytes, size_t new_bytes) {
+  const int64_t delta =
+      static_cast<int64_t>(new_bytes) - static_cast<int64_t>(old_bytes);
+  bytes_.fetch_add(static_cast<uint64_t>(delta), std::memory_order_relaxed);
+  if (old_bytes == 0 && new_bytes != 0) {
+    messages_.fetch_add(1, std::memory_order_relaxed);
+  } else if (old_bytes != 0 && new_bytes == 0) {
+    messages_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  budget_->Charge(delta);
+}
+
+ChannelMemoryMetrics ChannelMemoryAccount::Metrics() const {
+  ChannelMemoryMetrics metrics;
+  metrics.channel_name = channel_name_;
+  metrics.bytes = bytes();
+  metrics.messages = messages_.load(std::memory_order_relaxed);
+  metrics.byte_capacity = byte_capacity_.load(std::memory_order_relaxed);
+  metrics.evicted_messages = evicted_messages_.load(std::memory_order_relaxed);
+  metrics.evicted_bytes = evicted_bytes_.load(std::memory_order_relaxed);
+  return metrics;
+}
+
+MemoryBudget::MemoryBudget() : limit_(FLAGS_blocker_memory_budget) {}
+
+void MemoryBudget::set_limit(uint64_t bytes) {
+  limit_.store(bytes, std::memory_order_relaxed);
+  MarkReclaimable();
+  Reclaim();
+}
+
+uint64_t MemoryBudget::Reclaim() {
+  uint64_t reclaimed = 0;
+  if (!OverLimit()) {
+    return reclaimed;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // an Add from now on marks it again and is not overwritten below
+  reclaimable_.store(false, std::memory_order_relaxed);
+  // accounts that are down to their newest message
+  std::vector<ChannelMemoryAccount*> exhausted;
+  while (OverLimit()) {
+    ChannelMemoryAccount* largest = nullptr;
+    for (auto account : accounts_) {
+      if ((largest == nullptr || account->bytes() > largest->bytes()) &&
+          std::find(exhausted.begin(), exhausted.end(), account) ==
+              exhausted.end()) {
+        largest = account;
+      }
+    }
+    if (largest == nullptr) {
+      break;
+    }
+    const size_t bytes = largest->evict_oldest_();
+    if (bytes == 0) {
+      exhausted.push_back(largest);
+    }
+    reclaimed += bytes;
+  }
+  if (!OverLimit()) {
+    // under the limit by dropping, the channels may still hold more
+    MarkReclaimable();
+  }
+  return reclaimed;
+}
+
+void MemoryBudget::GetMetrics(
+    std::vector<ChannelMemoryMetrics>* metrics) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  metrics->clear();
+  metrics->reserve(accounts_.size());
+  for (auto account : accounts_) {
+    metrics->push_back(account->Metrics());
+  }
+}
+
+void MemoryBudget::Register(ChannelMemoryAccount* account) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  accounts_.push_back(account);
+}
+
+void MemoryBudget::Unregister(ChannelMemoryAccount* account) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  accounts_.erase(std::remove(accounts_.begin(), accounts_.end(), account),
+                  accounts_.end());
+}
+
+}  // namespace blocker
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,140 @@
+#ifndef CYBER_BLOCKER_MEMORY_BUDGET_H_
+#define CYBER_BLOCKER_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "cyber/common/macros.h"
+
+namespace apollo {
+namespace cyber {
+namespace blocker {
+
+DECLARE_uint64(blocker_memory_budget);
+
+class MemoryBudget;
+
+struct ChannelMemoryMetrics {
+  std::string channel_name;
+  uint64_t bytes = 0;
+  uint64_t messages = 0;
+  // 0 if the channel has no byte limit of its own
+  uint64_t byte_capacity = 0;
+  // dropped for the byte limit of the channel or the process budget
+  uint64_t evicted_messages = 0;
+  uint64_t evicted_bytes = 0;
+};
+
+/**
+ * @class ChannelMemoryAccount
+ * @brief The bytes the history of one Blocker holds, registered with the
+ * MemoryBudget for its lifetime.
+ *
+ * The counters are atomics, a Blocker updates them under its own lock and
+ * never takes the budget's. `evict_oldest` drops the oldest message of the
+ * Blocker, keeping the newest one, and returns its bytes, 0 if there is
+ * nothing to drop. The budget calls it to get back under its limit.
+ */
+class ChannelMemoryAccount {
+ public:
+  using EvictFunc = std::function<size_t()>;
+
+  ChannelMemoryAccount(const std::string& channel_name,
+                       const EvictFunc& evict_oldest);
+  // waits for an eviction in progress, so the Blocker may go away after it
+  ~ChannelMemoryAccount();
+
+  void Add(size_t bytes);
+  void Remove(size_t bytes, bool evicted);
+  // one message replaced by another of `new_bytes`, 0 is no message
+  void Replace(size_t old_bytes, size_t new_bytes);
+
+  void set_byte_capacity(size_t bytes) {
+    byte_capacity_.store(bytes, std::memory_order_relaxed);
+  }
+  uint64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+  ChannelMemoryMetrics Metrics() const;
+
+ private:
+  friend class MemoryBudget;
+
+  std::string channel_name_;
+  EvictFunc evict_oldest_;
+  MemoryBudget* budget_;
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> byte_capacity_{0};
+  std::atomic<uint64_t> evicted_messages_{0};
+  std::atomic<uint64_t> evicted_bytes_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(ChannelMemoryAccount)
+};
+
+/**
+ * @class MemoryBudget
+ * @brief Process wide limit on the bytes held by all Blocker histories.
+ *
+ * Over the limit, Reclaim drops the oldest messages of the channel holding
+ * the most bytes until the total fits again. The newest message of every
+ * channel is always kept. The limit starts at FLAGS_blocker_memory_budget,
+ * 0 is no limit. Every ChannelMemoryAccount keeps a pointer to the budget,
+ * so it is never reset.
+ */
+class MemoryBudget {
+ public:
+  void set_limit(uint64_t bytes);
+  uint64_t limit() const { return limit_.load(std::memory_order_relaxed); }
+  uint64_t used() const { return used_.load(std::memory_order_relaxed); }
+  bool OverLimit() const {
+    const uint64_t limit = this->limit();
+    return limit != 0 && used() > limit;
+  }
+  // over the limit and some channel may have an old message to give up,
+  // false while every channel is down to its newest message
+  bool ShouldReclaim() const {
+    return OverLimit() && reclaimable_.load(std::memory_order_relaxed);
+  }
+
+  // call without any Blocker lock held, returns the bytes it dropped
+  uint64_t Reclaim();
+
+  // one entry per live Blocker
+  void GetMetrics(std::vector<ChannelMemoryMetrics>* metrics) const;
+
+ private:
+  friend class ChannelMemoryAccount;
+
+  void Register(ChannelMemoryAccount* account);
+  void Unregister(ChannelMemoryAccount* account);
+  void Charge(int64_t bytes) {
+    used_.fetch_add(static_cast<uint64_t>(bytes), std::memory_order_relaxed);
+  }
+  // a channel holds a message besides its newest one
+  void MarkReclaimable() {
+    if (!reclaimable_.load(std::memory_order_relaxed)) {
+      reclaimable_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uint64_t> limit_{0};
+  std::atomic<uint64_t> used_{0};
+  // cleared by a Reclaim that found nothing left to drop, so Publish stops
+  // calling it until a channel grows a history again
+  std::atomic<bool> reclaimable_{true};
+  mutable std::mutex mutex_;
+  std::vector<ChannelMemoryAccount*> accounts_;
+
+  DECLARE_SINGLETON_NO_RESET(MemoryBudget)
+};
+
+}  // namespace blocker
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_BLOCKER_MEMORY_BUDGET_H_
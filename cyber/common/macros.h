@@ -1,6 +1,7 @@
 #ifndef CYBER_COMMON_MACROS_H_
 #define CYBER_COMMON_MACROS_H_
 
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -8,6 +9,7 @@
 #include <utility>
 
 #include "cyber/base/macros.h"
+#include "cyber/common/singleton_registry.h"
 
 DEFINE_TYPE_TRAIT(HasShutdown, Shutdown)
 /**
@@ -33,31 +35,76 @@ typename std::enable_if<!HasShutdown<T>::value>::type CallShutdown(T* instance)
   classname(const classname &) = delete;              \
   classname& operator=(const classname&) = delete;
 
-//这段代码尝试使用 std::call_once 函数来保证多线程环境下只有一个线程执行某个任务。具体来说，它的作用是：
-//1、定义了一个静态的 std::once_flag 变量 flag，用于标记是否已经执行过某个任务。
-//2、使用 std::call_once 函数来执行一个 lambda 函数，该 lambda 函数中创建了一个对象实例，但只会在第一次调用时执行。
-#define DECLARE_SINGLETON(classname)                                              \
-  public:                                                                         \
-    statc classname* instance(bool create_if_needed = true) {                     \
-      static classname* instance = nullptr;                                       \
-      if(!instance && create_if_needed) {                                         \                                       
-        static std::once_flag flag;                                               \
-        std::call_once(flag, [&]{ instance = new (std::nothrow) classname(); });  \
-      }                                                                           \
-      return instance;                                                            \
-    }                                                                             \
-                                                                                  \
-    static void CleanUp() {                                                       \
-      auto instance = Instance(false);                                            \
-      if(instance != nullptr) {                                                   \
-        CallShutdown(instance);                                                   \
-      }                                                                           \
-    }                                                                             \
-                                                                                  \
-  private:                                                                        \
-    classname();                                                                  \
-    DISALLOW_COPY_AND_ASSIGN(classname);
+// The instance pointer lives in a constant-initialized std::atomic, so once
+// the instance exists Instance() is a single acquire load. The first call
+// creates it under a per-class mutex and records it in SingletonRegistry,
+// which shuts the instances down newest first at exit.
+//
+// Reset() shuts down and deletes the instance, the next Instance() creates
+// a fresh one. It is for tests and benchmarks only. A singleton whose
+// instance, or anything inside it, is pointed to from elsewhere must use
+// DECLARE_SINGLETON_NO_RESET, which has no Reset().
+#define DECLARE_SINGLETON(classname)                                        \
+ public:                                                                    \
+  static void Reset() {                                                     \
+    std::lock_guard<std::mutex> lock(SingletonMutex());                     \
+    auto instance =                                                         \
+        SingletonSlot().exchange(nullptr, std::memory_order_acq_rel);       \
+    if (instance != nullptr) {                                              \
+      ::apollo::cyber::common::SingletonRegistry::Get()->Remove(instance);  \
+      CallShutdown(instance);                                               \
+      delete instance;                                                      \
+    }                                                                       \
+  }                                                                         \
+                                                                            \
+  DECLARE_SINGLETON_IMPL(classname)
 
+#define DECLARE_SINGLETON_NO_RESET(classname) DECLARE_SINGLETON_IMPL(classname)
+
+#define DECLARE_SINGLETON_IMPL(classname)                                   \
+ public:                                                                    \
+  static classname* Instance(bool create_if_needed = true) {                \
+    classname* instance = SingletonSlot().load(std::memory_order_acquire);  \
+    if (cyber_unlikely(instance == nullptr) && create_if_needed) {          \
+      instance = CreateSingleton();                                         \
+    }                                                                       \
+    return instance;                                                        \
+  }                                                                         \
+                                                                            \
+  static void CleanUp() {                                                   \
+    auto instance = Instance(false);                                        \
+    if (instance != nullptr) {                                              \
+      CallShutdown(instance);                                               \
+    }                                                                       \
+  }                                                                         \
+                                                                            \
+ private:                                                                   \
+  static std::atomic<classname*>& SingletonSlot() {                         \
+    static std::atomic<classname*> slot{nullptr};                           \
+    return slot;                                                            \
+  }                                                                         \
+                                                                            \
+  static std::mutex& SingletonMutex() {                                     \
+    static std::mutex mutex;                                                \
+    return mutex;                                                           \
+  }                                                                         \
+                                                                            \
+  static classname* CreateSingleton() {                                     \
+    std::lock_guard<std::mutex> lock(SingletonMutex());                     \
+    auto instance = SingletonSlot().load(std::memory_order_relaxed);        \
+    if (instance == nullptr) {                                              \
+      instance = new (std::nothrow) classname();                            \
+      if (instance != nullptr) {                                            \
+        ::apollo::cyber::common::SingletonRegistry::Get()->Add(             \
+            instance, [instance] { CallShutdown(instance); });              \
+        SingletonSlot().store(instance, std::memory_order_release);         \
+      }                                                                     \
+    }                                                                       \
+    return instance;                                                        \
+  }                                                                         \
+                                                                            \
+  classname();                                                              \
+  DISALLOW_COPY_AND_ASSIGN(classname)
 
 #endif
 /**知识点：std::enable_if<>
@@ -0,0 +1,88 @@
+#ifndef CYBER_COMMON_SINGLETON_REGISTRY_H_
+#define CYBER_COMMON_SINGLETON_REGISTRY_H_
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace apollo {
+namespace cyber {
+namespace common {
+
+/**
+ * @class SingletonRegistry
+ * @brief Every instance created through DECLARE_SINGLETON, in the order
+ * they finished construction.
+ *
+ * A singleton that uses another one in its constructor is registered after
+ * it, so walking the registry backwards shuts down the users before what
+ * they use. ShutdownAll runs at exit, the instances themselves are never
+ * deleted there.
+ */
+class SingletonRegistry {
+ public:
+  // never destroyed, singletons may still be reset from static destructors
+  static SingletonRegistry* Get() {
+    static auto* registry = [] {
+      std::atexit([] { Get()->ShutdownAll(); });
+      return new SingletonRegistry();
+    }();
+    return registry;
+  }
+
+  void Add(const void* instance, std::function<void()> shutdown) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back({instance, std::move(shutdown)});
+  }
+
+  void Remove(const void* instance) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [instance](const Entry& entry) {
+                                    return entry.instance == instance;
+                                  }),
+                   entries_.end());
+  }
+
+  /**
+   * @brief CallShutdown on every live singleton, newest first. The
+   * instances stay alive. Runs at exit, a Shutdown must be safe to call
+   * again.
+   */
+  void ShutdownAll() {
+    for (const auto& entry : Snapshot()) {
+      entry.shutdown();
+    }
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    const void* instance;
+    std::function<void()> shutdown;
+  };
+
+  SingletonRegistry() = default;
+
+  // newest first, called without the lock as a Shutdown may create or
+  // reset another singleton
+  std::vector<Entry> Snapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<Entry>(entries_.rbegin(), entries_.rend());
+  }
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace common
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_COMMON_SINGLETON_REGISTRY_H_
@@ -0,0 +1,197 @@
+#include "cyber/component/parallel_component_initializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace cyber {
+
+DEFINE_bool(parallel_component_init, false,
+            "initialize independent components of a launch file at once");
+DEFINE_int32(component_init_threads, 0,
+             "threads for parallel component init, 0 is one per core");
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+}  // namespace
+
+void ParallelComponentInitializer::AddComponent(
+    const ComponentInitTask& task) {
+  tasks_.push_back(task);
+}
+
+bool ParallelComponentInitializer::BuildGraph(
+    std::vector<std::vector<size_t>>* dependents,
+    std::vector<uint32_t>* waiting) const {
+  std::unordered_map<std::string, std::vector<size_t>> writers;
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    for (const auto& channel : tasks_[i].output_channels) {
+      writers[channel].push_back(i);
+    }
+  }
+  dependents->assign(tasks_.size(), {});
+  waiting->assign(tasks_.size(), 0);
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    std::vector<size_t> deps;
+    for (const auto& channel : tasks_[i].input_channels) {
+      auto iter = writers.find(channel);
+      if (iter == writers.end()) {
+        continue;
+      }
+      for (size_t writer : iter->second) {
+        if (writer != i) {
+          deps.push_back(writer);
+        }
+      }
+    }
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    for (size_t dep : deps) {
+      (*dependents)[dep].push_back(i);
+    }
+    (*waiting)[i] = static_cast<uint32_t>(deps.size());
+  }
+
+  // Kahn, every component has to become ready once
+  std::vector<uint32_t> left = *waiting;
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    if (left[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t visited = 0;
+  while (!ready.empty()) {
+    const size_t i = ready.back();
+    ready.pop_back();
+    ++visited;
+    for (size_t next : (*dependents)[i]) {
+      if (--left[next] == 0) {
+        ready.push_back(next);
+      }
+    }
+  }
+  if (visited != tasks_.size()) {
+    for (size_t i = 0; i < tasks_.size(); ++i) {
+      if (left[i] != 0) {
+        AERROR << "component " << tasks_[i].name
+               << " is in a channel dependency cycle.";
+      }
+    }
+    return false;
+  }
+  return true;
+}
+
+bool ParallelComponentInitializer::Run() {
+  reports_.assign(tasks_.size(), ComponentInitReport());
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    reports_[i].name = tasks_[i].name;
+  }
+  std::vector<std::vector<size_t>> dependents;
+  std::vector<uint32_t> waiting;
+  if (!BuildGraph(&dependents, &waiting)) {
+    return false;
+  }
+
+  size_t thread_num = 1;
+  if (FLAGS_parallel_component_init) {
+    thread_num = FLAGS_component_init_threads > 0
+                     ? FLAGS_component_init_threads
+                     : std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_num = std::max<size_t>(1, std::min(thread_num, tasks_.size()));
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<size_t> ready;
+  // a component one of its dependencies failed for
+  std::vector<bool> blocked(tasks_.size(), false);
+  size_t done = 0;
+  bool success = true;
+  for (size_t i = 0; i < tasks_.size(); ++i) {
+    if (waiting[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  const auto start = Clock::now();
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cv.wait(lock, [&] { return !ready.empty() || done == tasks_.size(); });
+      if (ready.empty()) {
+        return;
+      }
+      const size_t i = ready.front();
+      ready.pop_front();
+      auto& report = reports_[i];
+      bool ok = false;
+      if (blocked[i]) {
+        report.skipped = true;
+        AERROR << "skip init of component " << tasks_[i].name
+               << ", a component it depends on failed.";
+      } else {
+        lock.unlock();
+        report.start_ms = MsSince(start);
+        ok = tasks_[i].init != nullptr && tasks_[i].init();
+        report.duration_ms = MsSince(start) - report.start_ms;
+        lock.lock();
+        if (!ok) {
+          AERROR << "component " << tasks_[i].name << " init failed.";
+        }
+      }
+      report.success = ok;
+      success = success && ok;
+      ++done;
+      for (size_t next : dependents[i]) {
+        blocked[next] = blocked[next] || !ok;
+        if (--waiting[next] == 0) {
+          ready.push_back(next);
+        }
+      }
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_num; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  total_ms_ = MsSince(start);
+  LogReports();
+  return success;
+}
+
+void ParallelComponentInitializer::LogReports() const {
+  double sum_ms = 0.0;
+  for (const auto& report : reports_) {
+    sum_ms += report.duration_ms;
+    AINFO << "component " << report.name << " init "
+          << (report.skipped ? "skipped"
+                             : (report.success ? "ok" : "failed"))
+          << ", start " << report.start_ms << " ms, took "
+          << report.duration_ms << " ms";
+  }
+  AINFO << reports_.size() << " components initialized in " << total_ms_
+        << " ms, " << sum_ms << " ms one after another";
+}
+
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,81 @@
+#ifndef CYBER_COMPONENT_PARALLEL_COMPONENT_INITIALIZER_H_
+#define CYBER_COMPONENT_PARALLEL_COMPONENT_INITIALIZER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+namespace apollo {
+namespace cyber {
+
+DECLARE_bool(parallel_component_init);
+DECLARE_int32(component_init_threads);
+
+/**
+ * @brief One component to initialize, e.g.
+ * `[component, config] { return component->Initialize(config); }`
+ */
+struct ComponentInitTask {
+  std::string name;
+  std::function<bool()> init;
+  // channels this component reads and needs the writers of while it
+  // initializes, it starts after the components that write them
+  std::vector<std::string> input_channels;
+  // channels this component writes
+  std::vector<std::string> output_channels;
+};
+
+struct ComponentInitReport {
+  std::string name;
+  bool success = false;
+  // not run since a component it depends on failed
+  bool skipped = false;
+  // from the start of Run
+  double start_ms = 0.0;
+  double duration_ms = 0.0;
+};
+
+/**
+ * @class ParallelComponentInitializer
+ * @brief Initializes the components of a launch file on a pool of threads.
+ *
+ * A component waits for the components writing its input channels, all
+ * others initialize at the same time. With FLAGS_parallel_component_init
+ * off, or one thread, the components initialize one after another in an
+ * order that respects the dependencies.
+ */
+class ParallelComponentInitializer {
+ public:
+  void AddComponent(const ComponentInitTask& task);
+
+  /**
+   * @brief Initialize every added component
+   *
+   * @return false if one failed or the dependencies have a cycle
+   */
+  bool Run();
+
+  // one per added component, in the order they were added
+  const std::vector<ComponentInitReport>& reports() const {
+    return reports_;
+  }
+  double total_ms() const { return total_ms_; }
+
+ private:
+  // the components each one waits for, false on a cycle
+  bool BuildGraph(std::vector<std::vector<size_t>>* dependents,
+                  std::vector<uint32_t>* waiting) const;
+  void LogReports() const;
+
+  std::vector<ComponentInitTask> tasks_;
+  std::vector<ComponentInitReport> reports_;
+  double total_ms_ = 0.0;
+};
+
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_COMPONENT_PARALLEL_COMPONENT_INITIALIZER_H_
@@ -0,0 +1,49 @@
+#ifndef CYBER_MESSAGE_MESSAGE_SIZE_H_
+#define CYBER_MESSAGE_MESSAGE_SIZE_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include "cyber/base/macros.h"
+
+namespace apollo {
+namespace cyber {
+namespace message {
+
+DEFINE_TYPE_TRAIT(HasByteSizeLong, ByteSizeLong)
+
+/**
+ * @brief Bytes a message holds, used to budget the history of a channel.
+ *
+ * Protobuf messages report their serialized size, which is close to what
+ * the parsed message keeps in memory. Anything else counts as sizeof(T);
+ * specialize this for types that own heap memory, e.g. a point cloud:
+ * `template <> struct MessageSizeEstimator<PointCloud> {
+ *    static size_t Size(const PointCloud& c) { return c.size() * 16; } };`
+ */
+template <typename T, typename Enable = void>
+struct MessageSizeEstimator {
+  static size_t Size(const T& message) {
+    (void)message;
+    return sizeof(T);
+  }
+};
+
+template <typename T>
+struct MessageSizeEstimator<
+    T, typename std::enable_if<HasByteSizeLong<T>::value>::type> {
+  static size_t Size(const T& message) {
+    return static_cast<size_t>(message.ByteSizeLong());
+  }
+};
+
+template <typename T>
+size_t MessageSize(const T& message) {
+  return MessageSizeEstimator<T>::Size(message);
+}
+
+}  // namespace message
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_MESSAGE_MESSAGE_SIZE_H_
@@ -0,0 +1,75 @@
+#include "cyber/message/proto_desc_cache.h"
+
+#include <mutex>
+#include <utility>
+
+namespace apollo {
+namespace cyber {
+namespace message {
+
+ProtoDescCache::ProtoDescCache() {}
+
+uint64_t ProtoDescCache::Hash(const std::string& desc) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : desc) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t ProtoDescCache::Intern(const std::string& desc) {
+  const uint64_t hash = Hash(desc);
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    if (descs_.count(hash) != 0) {
+      return hash;
+    }
+  }
+  auto ptr = std::make_shared<const std::string>(desc);
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (descs_.emplace(hash, std::move(ptr)).second) {
+    byte_size_ += desc.size();
+  }
+  return hash;
+}
+
+auto ProtoDescCache::Find(uint64_t hash) const -> DescPtr {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  auto iter = descs_.find(hash);
+  return iter == descs_.end() ? nullptr : iter->second;
+}
+
+void ProtoDescCache::Dedup(proto::RoleAttributes* attr) {
+  if (!attr->has_proto_desc()) {
+    return;
+  }
+  attr->set_proto_desc_hash(Intern(attr->proto_desc()));
+  attr->clear_proto_desc();
+}
+
+bool ProtoDescCache::Expand(proto::RoleAttributes* attr) const {
+  if (attr->has_proto_desc() || !attr->has_proto_desc_hash()) {
+    return true;
+  }
+  auto desc = Find(attr->proto_desc_hash());
+  if (desc == nullptr) {
+    return false;
+  }
+  attr->set_proto_desc(*desc);
+  return true;
+}
+
+size_t ProtoDescCache::Size() const {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  return descs_.size();
+}
+
+size_t ProtoDescCache::ByteSize() const {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  return byte_size_;
+}
+
+}  // namespace message
+}  // namespace cyber
+}  // namespace apollo
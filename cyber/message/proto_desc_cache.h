@@ -0,0 +1,62 @@
+#ifndef CYBER_MESSAGE_PROTO_DESC_CACHE_H_
+#define CYBER_MESSAGE_PROTO_DESC_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "cyber/proto/role_attributes.pb.h"
+
+#include "cyber/common/macros.h"
+
+namespace apollo {
+namespace cyber {
+namespace message {
+
+/**
+ * @class ProtoDescCache
+ * @brief Content addressed store of the proto_desc bytes of RoleAttributes.
+ *
+ * Every reader and writer of a message type carries the same descriptor.
+ * The attributes kept in process are deduped, they hold proto_desc_hash
+ * and the bytes live here once. Expand puts the bytes back on a copy that
+ * leaves the process, e.g. the attributes a Reader joins the topology with,
+ * so peers always get the descriptor itself.
+ */
+class ProtoDescCache {
+ public:
+  using DescPtr = std::shared_ptr<const std::string>;
+
+  // FNV-1a, the same in every process so the hash can go on the wire
+  static uint64_t Hash(const std::string& desc);
+
+  // stores `desc` once and returns its hash
+  uint64_t Intern(const std::string& desc);
+  // nullptr if not known
+  DescPtr Find(uint64_t hash) const;
+
+  // moves proto_desc into the cache, keeps proto_desc_hash
+  void Dedup(proto::RoleAttributes* attr);
+  // fills proto_desc back in, false if it is not cached
+  bool Expand(proto::RoleAttributes* attr) const;
+
+  size_t Size() const;
+  // bytes of the stored descriptors
+  size_t ByteSize() const;
+
+ private:
+  mutable std::shared_timed_mutex mutex_;
+  std::unordered_map<uint64_t, DescPtr> descs_;
+  size_t byte_size_ = 0;
+
+  DECLARE_SINGLETON(ProtoDescCache)
+};
+
+}  // namespace message
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_MESSAGE_PROTO_DESC_CACHE_H_
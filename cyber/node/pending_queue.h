@@ -0,0 +1,296 @@
+#ifndef CYBER_NODE_PENDING_QUEUE_H_
+#define CYBER_NODE_PENDING_QUEUE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace apollo {
+namespace cyber {
+
+enum class BackpressurePolicy {
+  // the fixed size queue, a full queue drops its oldest message
+  DROP_OLDEST,
+  // CoDel for message queues: once the queue has not been empty for a whole
+  // interval, heads that waited longer than the target are dropped. A
+  // publisher does not slow down on drops as a TCP sender does, so the
+  // control law rate would fall behind, the age limit holds the latency.
+  CODEL,
+  // a head older than the target skips to the newest message
+  CONFLATE,
+};
+
+struct BackpressureConfig {
+  BackpressurePolicy policy = BackpressurePolicy::DROP_OLDEST;
+  // messages the queue holds at most, whatever the policy
+  size_t capacity = 1;
+  // the time a message may wait for the callback
+  uint64_t target_us = 5000;
+  // how long the queue has to stay non-empty before CoDel drops
+  uint64_t interval_us = 100000;
+};
+
+/**
+ * @brief Sent when the Reader starts dropping for latency and when it
+ * stops. It goes to the callback of this process only, a Writer of the
+ * channel learns about it if that callback tells it, e.g. in the same
+ * process or over a channel of its own.
+ */
+struct BackpressureSignal {
+  std::string channel_name;
+  bool congested = false;
+  // the wait of the message that decided it
+  uint64_t sojourn_us = 0;
+  // messages dropped for latency since the congestion started
+  uint64_t dropped = 0;
+};
+
+using BackpressureCallback = std::function<void(const BackpressureSignal&)>;
+
+struct BackpressureMetrics {
+  uint64_t enqueued = 0;
+  uint64_t delivered = 0;
+  // pushed out of a full queue
+  uint64_t overflow_dropped = 0;
+  uint64_t codel_dropped = 0;
+  // skipped to the newest by CONFLATE
+  uint64_t conflated = 0;
+  uint64_t congestion_signals = 0;
+  uint64_t last_sojourn_us = 0;
+  bool congested = false;
+};
+
+/**
+ * @class PendingQueue
+ * @brief The messages a Reader received and has not run its callback for.
+ *
+ * Push is called on receive, Pop right before the callback and decides what
+ * to drop from how long the head waited, so the decision follows the real
+ * latency and not the queue length. Every decision is counted in Metrics.
+ */
+template <typename M>
+class PendingQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using MessagePtr = std::shared_ptr<M>;
+
+  PendingQueue(const std::string& channel_name,
+               const BackpressureConfig& config,
+               const BackpressureCallback& callback = nullptr)
+      : channel_name_(channel_name), config_(config), callback_(callback) {}
+
+  void Push(const MessagePtr& msg, Clock::time_point now = Clock::now());
+
+  // the message to run the callback for, nullptr if there is none
+  MessagePtr Pop(Clock::time_point now = Clock::now());
+
+  void set_config(const BackpressureConfig& config);
+  void set_callback(const BackpressureCallback& callback);
+  size_t Size() const;
+  void Clear();
+  BackpressureMetrics Metrics() const;
+
+ private:
+  struct Item {
+    MessagePtr msg;
+    Clock::time_point enqueue_time;
+  };
+
+  uint64_t SojournUs(const Item& item, Clock::time_point now) const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            now - item.enqueue_time)
+            .count());
+  }
+  MessagePtr PopCoDel(Clock::time_point now, BackpressureSignal* signal);
+  MessagePtr PopConflate(Clock::time_point now, BackpressureSignal* signal);
+  // fills `signal` if the state changes, with mutex_ held
+  void SetCongested(bool congested, uint64_t sojourn_us,
+                    BackpressureSignal* signal);
+
+  std::string channel_name_;
+  BackpressureConfig config_;
+  BackpressureCallback callback_;
+  std::deque<Item> queue_;
+  mutable std::mutex mutex_;
+
+  // when queue_ last turned non-empty
+  Clock::time_point standing_since_;
+  uint64_t episode_dropped_ = 0;
+
+  BackpressureMetrics metrics_;
+};
+
+template <typename M>
+void PendingQueue<M>::Push(const MessagePtr& msg, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++metrics_.enqueued;
+  if (config_.capacity == 0) {
+    ++metrics_.overflow_dropped;
+    return;
+  }
+  while (queue_.size() >= config_.capacity) {
+    queue_.pop_front();
+    ++metrics_.overflow_dropped;
+  }
+  if (queue_.empty()) {
+    standing_since_ = now;
+  }
+  queue_.push_back({msg, now});
+}
+
+template <typename M>
+auto PendingQueue<M>::Pop(Clock::time_point now) -> MessagePtr {
+  BackpressureSignal signal;
+  MessagePtr msg;
+  BackpressureCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (config_.policy) {
+      case BackpressurePolicy::CODEL:
+        msg = PopCoDel(now, &signal);
+        break;
+      case BackpressurePolicy::CONFLATE:
+        msg = PopConflate(now, &signal);
+        break;
+      default:
+        if (!queue_.empty()) {
+          metrics_.last_sojourn_us = SojournUs(queue_.front(), now);
+          msg = std::move(queue_.front().msg);
+          queue_.pop_front();
+        }
+        break;
+    }
+    if (msg != nullptr) {
+      ++metrics_.delivered;
+    }
+    if (!signal.channel_name.empty()) {
+      callback = callback_;
+    }
+  }
+  // outside the lock, the callback may well look at the queue
+  if (callback != nullptr) {
+    callback(signal);
+  }
+  return msg;
+}
+
+template <typename M>
+auto PendingQueue<M>::PopCoDel(Clock::time_point now,
+                               BackpressureSignal* signal) -> MessagePtr {
+  if (queue_.empty()) {
+    SetCongested(false, 0, signal);
+    return nullptr;
+  }
+  const bool standing =
+      now - standing_since_ >= std::chrono::microseconds(config_.interval_us);
+  if (!metrics_.congested) {
+    episode_dropped_ = 0;
+  }
+  auto head = std::move(queue_.front());
+  queue_.pop_front();
+  uint64_t sojourn_us = SojournUs(head, now);
+  bool dropped = false;
+  // the last message is never dropped, there is nothing newer to run
+  while (standing && sojourn_us > config_.target_us && !queue_.empty()) {
+    ++metrics_.codel_dropped;
+    ++episode_dropped_;
+    dropped = true;
+    head = std::move(queue_.front());
+    queue_.pop_front();
+    sojourn_us = SojournUs(head, now);
+  }
+  // a standing queue below the target is fine, only a drop or a late
+  // message of a standing queue is congestion
+  if (dropped || (standing && sojourn_us > config_.target_us)) {
+    SetCongested(true, sojourn_us, signal);
+  } else if (sojourn_us <= config_.target_us) {
+    SetCongested(false, sojourn_us, signal);
+  }
+  metrics_.last_sojourn_us = sojourn_us;
+  return std::move(head.msg);
+}
+
+template <typename M>
+auto PendingQueue<M>::PopConflate(Clock::time_point now,
+                                  BackpressureSignal* signal) -> MessagePtr {
+  if (queue_.empty()) {
+    return nullptr;
+  }
+  const uint64_t head_sojourn_us = SojournUs(queue_.front(), now);
+  if (head_sojourn_us >= config_.target_us) {
+    const size_t stale = queue_.size() - 1;
+    metrics_.conflated += stale;
+    episode_dropped_ = metrics_.congested ? episode_dropped_ + stale : stale;
+    queue_.erase(queue_.begin(), queue_.end() - 1);
+    if (stale != 0) {
+      SetCongested(true, head_sojourn_us, signal);
+    }
+  } else if (queue_.size() == 1) {
+    // caught up
+    SetCongested(false, head_sojourn_us, signal);
+  }
+  auto head = std::move(queue_.front());
+  queue_.pop_front();
+  metrics_.last_sojourn_us = SojournUs(head, now);
+  return std::move(head.msg);
+}
+
+template <typename M>
+void PendingQueue<M>::SetCongested(bool congested, uint64_t sojourn_us,
+                                   BackpressureSignal* signal) {
+  if (metrics_.congested == congested) {
+    return;
+  }
+  metrics_.congested = congested;
+  ++metrics_.congestion_signals;
+  signal->channel_name = channel_name_;
+  signal->congested = congested;
+  signal->sojourn_us = sojourn_us;
+  signal->dropped = episode_dropped_;
+}
+
+template <typename M>
+void PendingQueue<M>::set_config(const BackpressureConfig& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_ = config;
+  while (queue_.size() > config_.capacity) {
+    queue_.pop_front();
+    ++metrics_.overflow_dropped;
+  }
+}
+
+template <typename M>
+void PendingQueue<M>::set_callback(const BackpressureCallback& callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = callback;
+}
+
+template <typename M>
+size_t PendingQueue<M>::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+template <typename M>
+void PendingQueue<M>::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.clear();
+}
+
+template <typename M>
+BackpressureMetrics PendingQueue<M>::Metrics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return metrics_;
+}
+
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_NODE_PENDING_QUEUE_H_
@@ -0,0 +1,140 @@
+#include "cyber/node/pending_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace cyber {
+
+namespace {
+
+using Queue = PendingQueue<int>;
+using std::chrono::microseconds;
+
+BackpressureConfig MakeConfig(BackpressurePolicy policy, size_t capacity) {
+  BackpressureConfig config;
+  config.policy = policy;
+  config.capacity = capacity;
+  config.target_us = 1000;
+  config.interval_us = 10000;
+  return config;
+}
+
+// pushes `count` messages `step_us` apart starting at `start`, numbered
+// from `first`
+void PushAll(Queue* queue, Queue::Clock::time_point start, int first,
+             int count, int64_t step_us) {
+  for (int i = 0; i < count; ++i) {
+    queue->Push(std::make_shared<int>(first + i),
+                start + microseconds(i * step_us));
+  }
+}
+
+}  // namespace
+
+TEST(PendingQueueTest, DropOldestKeepsTheNewest) {
+  Queue queue("/channel", MakeConfig(BackpressurePolicy::DROP_OLDEST, 2));
+  const auto t0 = Queue::Clock::now();
+  PushAll(&queue, t0, 0, 3, 0);
+  EXPECT_EQ(2, queue.Size());
+  // never dropped for latency
+  const auto later = t0 + microseconds(1000000);
+  EXPECT_EQ(1, *queue.Pop(later));
+  EXPECT_EQ(2, *queue.Pop(later));
+  EXPECT_EQ(nullptr, queue.Pop(later));
+
+  const auto metrics = queue.Metrics();
+  EXPECT_EQ(3, metrics.enqueued);
+  EXPECT_EQ(2, metrics.delivered);
+  EXPECT_EQ(1, metrics.overflow_dropped);
+  EXPECT_EQ(0, metrics.codel_dropped);
+  EXPECT_FALSE(metrics.congested);
+}
+
+TEST(PendingQueueTest, CoDelDropsOnlyLateHeadsOfAStandingQueue) {
+  std::vector<BackpressureSignal> signals;
+  Queue queue("/channel", MakeConfig(BackpressurePolicy::CODEL, 100),
+              [&signals](const BackpressureSignal& signal) {
+                signals.push_back(signal);
+              });
+  const auto t0 = Queue::Clock::now();
+  PushAll(&queue, t0, 0, 10, 100);
+
+  // late but not standing for an interval yet: nothing is dropped
+  auto msg = queue.Pop(t0 + microseconds(5000));
+  EXPECT_EQ(0, *msg);
+  EXPECT_EQ(0, queue.Metrics().codel_dropped);
+
+  // standing and late, the heads above the target go
+  msg = queue.Pop(t0 + microseconds(10500));
+  EXPECT_EQ(9, *msg);
+  auto metrics = queue.Metrics();
+  EXPECT_EQ(8, metrics.codel_dropped);
+  EXPECT_TRUE(metrics.congested);
+  ASSERT_EQ(1, signals.size());
+  EXPECT_TRUE(signals[0].congested);
+  EXPECT_EQ(8, signals[0].dropped);
+
+  // emptied, the congestion ends
+  EXPECT_EQ(nullptr, queue.Pop(t0 + microseconds(10600)));
+  ASSERT_EQ(2, signals.size());
+  EXPECT_FALSE(signals[1].congested);
+  EXPECT_EQ(8, signals[1].dropped);
+}
+
+TEST(PendingQueueTest, CoDelStandingBelowTargetIsNotCongested) {
+  std::vector<BackpressureSignal> signals;
+  Queue queue("/channel", MakeConfig(BackpressurePolicy::CODEL, 100),
+              [&signals](const BackpressureSignal& signal) {
+                signals.push_back(signal);
+              });
+  const auto t0 = Queue::Clock::now();
+  // the queue never drains, one message always waits, but each is served
+  // 600us after it came, within the target
+  queue.Push(std::make_shared<int>(0), t0);
+  for (int i = 1; i < 50; ++i) {
+    const auto now = t0 + microseconds(i * 500);
+    queue.Push(std::make_shared<int>(i), now);
+    auto msg = queue.Pop(now + microseconds(100));
+    ASSERT_NE(nullptr, msg);
+    EXPECT_EQ(i - 1, *msg);
+  }
+  const auto metrics = queue.Metrics();
+  EXPECT_EQ(1, queue.Size());
+  EXPECT_EQ(0, metrics.codel_dropped);
+  EXPECT_FALSE(metrics.congested);
+  EXPECT_TRUE(signals.empty());
+}
+
+TEST(PendingQueueTest, ConflateSkipsToTheNewest) {
+  std::vector<BackpressureSignal> signals;
+  Queue queue("/channel", MakeConfig(BackpressurePolicy::CONFLATE, 100),
+              [&signals](const BackpressureSignal& signal) {
+                signals.push_back(signal);
+              });
+  const auto t0 = Queue::Clock::now();
+  PushAll(&queue, t0, 0, 5, 10);
+
+  // the head is fresh, it is served in order
+  EXPECT_EQ(0, *queue.Pop(t0 + microseconds(100)));
+  EXPECT_TRUE(signals.empty());
+
+  EXPECT_EQ(4, *queue.Pop(t0 + microseconds(2000)));
+  auto metrics = queue.Metrics();
+  EXPECT_EQ(3, metrics.conflated);
+  EXPECT_TRUE(metrics.congested);
+  ASSERT_EQ(1, signals.size());
+  EXPECT_TRUE(signals[0].congested);
+  EXPECT_EQ(3, signals[0].dropped);
+
+  // a single fresh message is caught up
+  queue.Push(std::make_shared<int>(5), t0 + microseconds(3000));
+  EXPECT_EQ(5, *queue.Pop(t0 + microseconds(3100)));
+  ASSERT_EQ(2, signals.size());
+  EXPECT_FALSE(signals[1].congested);
+}
+
+}  // namespace cyber
+}  // namespace apollo
@@ -2,6 +2,8 @@
 #define CYBER_NODE_READER_H_
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -16,6 +18,9 @@
 #include "cyber/common/global_data.h"
 #include "cyber/croutine/routine_factory.h"
 #include "cyber/data/data_visitor.h"
+#include "cyber/message/message_traits.h"
+#include "cyber/node/pending_queue.h"
+#include "cyber/node/reader_awaiter.h"
 #include "cyber/node/reader_base.h"
 #include "cyber/scheduler/scheduler_factory.h"
 #include "cyber/service_discovery/topology_manager.h"
@@ -30,7 +35,9 @@ using CallbackFunc = std::function<void(const std::shared_ptr<M0>&)>;
 
 using proto::RoleType;
 
-const uint32_t DEFAULT_PENDING_QUEUE_SIZE = 1;//默认等待处理的消息队列大小
+// 默认等待处理的消息队列大小, with 1 the blocker_ keeps only the latest
+// message in an atomic slot and Publish/GetLatestObserved take no lock
+const uint32_t DEFAULT_PENDING_QUEUE_SIZE = 1;
 
 /**
  * @class Reader
@@ -47,9 +54,9 @@ const uint32_t DEFAULT_PENDING_QUEUE_SIZE = 1;//默认等待处理的消息队
 template <typename MessageT>
 class Reader : public ReaderBase {
  public:
-  using BlockerPtr = std::unique_ptr<blocker::Blocker<MessaeT>>;
+  using BlockerPtr = std::unique_ptr<blocker::Blocker<MessageT>>;
   using ReceiverPtr = std::shared_ptr<transport::Receiver<MessageT>>;
-  using ChangeConnectiong = typename service_discovery::Manager::ChangeConnection;
+  using ChangeConnection = typename service_discovery::Manager::ChangeConnection;
   using Iterator = typename std::list<std::shared_ptr<MessageT>>::const_iterator;
 
   /**
@@ -127,6 +134,46 @@ class Reader : public ReaderBase {
    */
   virtual void Enqueue(const std::shared_ptr<MessageT>& msg);
 
+  /**
+   * @brief Queue a received message for ProcessPending, the receive side
+   * calls this
+   *
+   * @param msg the received message
+   */
+  void PushPending(const std::shared_ptr<MessageT>& msg);
+
+  /**
+   * @brief `Enqueue` and run the callback for the pending messages the
+   * backpressure policy lets through, the croutine of the Reader calls this
+   *
+   * Handles at most the messages pending on entry, messages that arrive
+   * meanwhile wait for the next call, so a publisher as fast as the
+   * callback cannot keep the croutine here for ever.
+   *
+   * @return size_t the number of messages handled
+   */
+  size_t ProcessPending();
+
+  /**
+   * @brief Choose how the pending messages are dropped when the callback
+   * falls behind, the default is DROP_OLDEST with `pending_queue_size`
+   *
+   * @param config policy, capacity and latency target
+   * @param callback told when the Reader starts and stops dropping for
+   * latency, on the thread of ProcessPending. It is only a local call,
+   * nothing reaches the Writers of the channel, a process that wants them
+   * to slow down has to forward the signal itself.
+   */
+  void SetBackpressure(const BackpressureConfig& config,
+                       const BackpressureCallback& callback = nullptr);
+
+  /**
+   * @brief Get the counters of every backpressure decision
+   *
+   * @return BackpressureMetrics the counters
+   */
+  BackpressureMetrics GetBackpressureMetrics() const;
+
   /**
    * @brief Set Blocker's `PublishQueue`'s capacity to `depth`
    *
@@ -141,6 +188,22 @@ class Reader : public ReaderBase {
    */
   virtual uint32_t GetHistoryDepth() const;
 
+  /**
+   * @brief Limit Blocker's `PublishQueue` to `bytes` of messages, as
+   * estimated by message::MessageSize, the oldest are dropped first. The
+   * history depth still caps the count, raise it to keep more small messages.
+   *
+   * @param bytes the byte limit, 0 is no limit
+   */
+  virtual void SetHistoryBytes(const uint64_t& bytes);
+
+  /**
+   * @brief Get the byte limit of Blocker's `PublishQueue`
+   *
+   * @return uint64_t the byte limit, 0 if there is none
+   */
+  virtual uint64_t GetHistoryBytes() const;
+
   /**
    * @brief Get the latest message we `Observe`
    *
@@ -171,7 +234,7 @@ class Reader : public ReaderBase {
 
   /**
    * @brief Is there is at least one writer publish the channel that we
-   * subscribes?
+   * subscribes? One atomic load of the cached writer set.
    *
    * @return true if the channel has writer
    * @return false if the channel has no writer
@@ -179,32 +242,311 @@ class Reader : public ReaderBase {
   bool HasWriter() override;
 
   /**
-   * @brief Get all writers pushlish the channel we subscribes
+   * @brief Get all writers pushlish the channel we subscribes, a copy of the
+   * cached writer set. proto_desc is left out, message::ProtoDescCache
+   * expands it from proto_desc_hash.
    *
    * @param writers result vector of RoleAttributes
    */
   void GetWriters(std::vector<proto::RoleAttributes>* writers) override;
 
+  /**
+   * @brief Apply the changes of one ChangeMsgBatch, as handed back by
+   * service_discovery::ChangeBatchApplier, the writer set is updated once
+   * for all of them
+   *
+   * @param changes full changes of the whole topology, the ones of other
+   * channels are skipped
+   */
+  void OnChannelChanges(const std::vector<proto::ChangeMsg>& changes);
+
+#if CYBER_HAS_COROUTINE
+  /**
+   * @brief Wait for the next message inside a coroutine:
+   * `auto msg = co_await reader->Read();`
+   *
+   * A message that arrived since the last Read() is returned at once, else
+   * the coroutine suspends without a thread or an allocation and is resumed
+   * by the AwaitExecutor when the message comes. Returns nullptr once the
+   * Reader shuts down.
+   */
+  ReadAwaiter<MessageT> Read();
+
+  /**
+   * @brief Like Read(), but returns nullptr when nothing arrived before
+   * `deadline`
+   */
+  ReadAwaiter<MessageT> ReadUntil(const AwaitClock::time_point& deadline);
+
+  /**
+   * @brief Where suspended Read() calls resume, the AwaitResumer threads by
+   * default. Set it before the first Read().
+   */
+  void SetAwaitExecutor(AwaitExecutor* executor);
+#endif
+
  protected:
   double latest_recv_time_sec_ = -1.0;
   double second_to_lastest_recv_time_sec_ = -1.0;
   uint32_t pending_queue_size_;
+  // after pending_queue_size_, it is built from it
+  PendingQueue<MessageT> pending_queue_{
+      this->role_attr_.channel_name(),
+      BackpressureConfig{BackpressurePolicy::DROP_OLDEST, pending_queue_size_}};
 
  private:
   void JoinTheTopology();
   void LeaveTheTopology();
   void OnChannelChange(const proto::ChangeMsg& changes_msg);
-  
+  // a writer and whether it joined
+  using WriterChange = std::pair<const proto::RoleAttributes*, bool>;
+  void UpdateWriters(const std::vector<WriterChange>& changes);
+  void UpdateWriters(const proto::RoleAttributes& writer, bool join) {
+    UpdateWriters(std::vector<WriterChange>{{&writer, join}});
+  }
+  void ResetWriters();
+
   CallbackFunc<MessageT> reader_func_;
   ReceiverPtr receiver_ = nullptr;
   std::string croutine_name_;
 
+#if CYBER_HAS_COROUTINE
+  // before blocker_, so the blocker callback feeding it goes away first
+  AwaitQueue<MessageT> await_queue_;
+  std::once_flag await_flag_;
+  void SubscribeAwaitQueue();
+#endif
+
   BlockerPtr blocker_ = nullptr;
 
   ChangeConnection change_conn_;
   service_discovery::ChannelManagerPtr channel_manager_ = nullptr;
+
+  // Writers of our channel, kept from the ChangeMsg join/leave events and
+  // replaced as a whole, so HasWriter/GetWriters never ask the
+  // ChannelManager. Only read through std::atomic_load.
+  std::shared_ptr<const std::vector<proto::RoleAttributes>> writers_;
+  std::atomic<bool> has_writer_{false};
+  // serializes the writers_ updates
+  std::mutex writers_mutex_;
 };
 
+template <typename MessageT>
+void Reader<MessageT>::PushPending(const std::shared_ptr<MessageT>& msg) {
+  pending_queue_.Push(msg);
+}
+
+template <typename MessageT>
+size_t Reader<MessageT>::ProcessPending() {
+  size_t handled = 0;
+  // Pop measures the wait of every message, the callbacks before it count.
+  // A Pop takes at least one message, so this is bounded by the entry size.
+  for (size_t pops = pending_queue_.Size(); pops > 0; --pops) {
+    auto msg = pending_queue_.Pop();
+    if (msg == nullptr) {
+      break;
+    }
+    Enqueue(msg);
+    if (reader_func_ != nullptr) {
+      reader_func_(msg);
+    }
+    ++handled;
+  }
+  return handled;
+}
+
+template <typename MessageT>
+void Reader<MessageT>::SetBackpressure(const BackpressureConfig& config,
+                                       const BackpressureCallback& callback) {
+  pending_queue_size_ = static_cast<uint32_t>(config.capacity);
+  pending_queue_.set_config(config);
+  pending_queue_.set_callback(callback);
+}
+
+template <typename MessageT>
+BackpressureMetrics Reader<MessageT>::GetBackpressureMetrics() const {
+  return pending_queue_.Metrics();
+}
+
+template <typename MessageT>
+void Reader<MessageT>::SetHistoryBytes(const uint64_t& bytes) {
+  blocker_->set_byte_capacity(static_cast<size_t>(bytes));
+}
+
+template <typename MessageT>
+uint64_t Reader<MessageT>::GetHistoryBytes() const {
+  return static_cast<uint64_t>(blocker_->byte_capacity());
+}
+
+template <typename MessageT>
+void Reader<MessageT>::JoinTheTopology() {
+  // add listener
+  change_conn_ = channel_manager_->AddChangeListener(std::bind(
+      &Reader<MessageT>::OnChannelChange, this, std::placeholders::_1));
+
+  // get peer writers, events that came in since the listener was added are
+  // already in writers_ and merged, not overwritten
+  const std::string& channel_name = this->role_attr_.channel_name();
+  std::vector<proto::RoleAttributes> writers;
+  channel_manager_->GetWritersOfChannel(channel_name, &writers);
+  std::vector<WriterChange> joins;
+  joins.reserve(writers.size());
+  for (auto& writer : writers) {
+    receiver_->Enable(writer);
+    joins.emplace_back(&writer, true);
+  }
+  UpdateWriters(joins);
+  // peers get the descriptor itself, only our copy is deduped
+  proto::RoleAttributes attr = this->role_attr_;
+  message::ProtoDescCache::Instance()->Expand(&attr);
+  channel_manager_->Join(attr, proto::RoleType::ROLE_READER,
+                         message::HasSerializer<MessageT>::value);
+}
+
+template <typename MessageT>
+void Reader<MessageT>::LeaveTheTopology() {
+  channel_manager_->RemoveChangeListener(change_conn_);
+  channel_manager_->Leave(this->role_attr_, proto::RoleType::ROLE_READER);
+  ResetWriters();
+}
+
+template <typename MessageT>
+void Reader<MessageT>::OnChannelChange(const proto::ChangeMsg& change_msg) {
+  if (change_msg.role_type() != proto::RoleType::ROLE_WRITER) {
+    return;
+  }
+
+  // the same check as OnChannelChanges
+  auto& writer_attr = change_msg.role_attr();
+  if (writer_attr.channel_id() != this->role_attr_.channel_id()) {
+    return;
+  }
+
+  auto operate_type = change_msg.operate_type();
+  if (operate_type == proto::OperateType::OPT_JOIN) {
+    receiver_->Enable(writer_attr);
+  } else {
+    receiver_->Disable(writer_attr);
+  }
+  UpdateWriters(writer_attr, operate_type == proto::OperateType::OPT_JOIN);
+}
+
+template <typename MessageT>
+void Reader<MessageT>::OnChannelChanges(
+    const std::vector<proto::ChangeMsg>& changes) {
+  std::vector<WriterChange> writer_changes;
+  for (const auto& change_msg : changes) {
+    if (change_msg.role_type() != proto::RoleType::ROLE_WRITER) {
+      continue;
+    }
+    auto& writer_attr = change_msg.role_attr();
+    if (writer_attr.channel_id() != this->role_attr_.channel_id()) {
+      continue;
+    }
+    const bool join =
+        change_msg.operate_type() == proto::OperateType::OPT_JOIN;
+    if (join) {
+      receiver_->Enable(writer_attr);
+    } else {
+      receiver_->Disable(writer_attr);
+    }
+    writer_changes.emplace_back(&writer_attr, join);
+  }
+  if (!writer_changes.empty()) {
+    UpdateWriters(writer_changes);
+  }
+}
+
+template <typename MessageT>
+void Reader<MessageT>::UpdateWriters(const std::vector<WriterChange>& changes) {
+  std::lock_guard<std::mutex> lock(writers_mutex_);
+  auto current = std::atomic_load(&writers_);
+  auto updated = std::make_shared<std::vector<proto::RoleAttributes>>();
+  if (current != nullptr) {
+    *updated = *current;
+  }
+  bool changed = false;
+  for (const auto& change : changes) {
+    const uint64_t id = change.first->id();
+    auto iter = std::find_if(
+        updated->begin(), updated->end(),
+        [id](const proto::RoleAttributes& attr) { return attr.id() == id; });
+    if (iter != updated->end()) {
+      // leave, or a join that replaces the old attributes
+      *iter = std::move(updated->back());
+      updated->pop_back();
+      changed = true;
+    }
+    if (change.second) {
+      updated->push_back(*change.first);
+      message::ProtoDescCache::Instance()->Dedup(&updated->back());
+      changed = true;
+    }
+  }
+  if (!changed) {
+    // only leaves of writers we never saw
+    return;
+  }
+  has_writer_.store(!updated->empty(), std::memory_order_release);
+  std::atomic_store(
+      &writers_,
+      std::shared_ptr<const std::vector<proto::RoleAttributes>>(
+          std::move(updated)));
+}
+
+template <typename MessageT>
+void Reader<MessageT>::ResetWriters() {
+  std::lock_guard<std::mutex> lock(writers_mutex_);
+  has_writer_.store(false, std::memory_order_release);
+  std::atomic_store(
+      &writers_, std::shared_ptr<const std::vector<proto::RoleAttributes>>());
+}
+
+template <typename MessageT>
+bool Reader<MessageT>::HasWriter() {
+  return has_writer_.load(std::memory_order_acquire);
+}
+
+template <typename MessageT>
+void Reader<MessageT>::GetWriters(std::vector<proto::RoleAttributes>* writers) {
+  if (writers == nullptr) {
+    return;
+  }
+  auto snapshot = std::atomic_load(&writers_);
+  if (snapshot != nullptr) {
+    writers->insert(writers->end(), snapshot->begin(), snapshot->end());
+  }
+}
+
+#if CYBER_HAS_COROUTINE
+template <typename MessageT>
+void Reader<MessageT>::SubscribeAwaitQueue() {
+  std::call_once(await_flag_, [this]() {
+    blocker_->Subscribe("reader_await",
+                        [this](const std::shared_ptr<MessageT>& msg) {
+                          await_queue_.Deliver(msg);
+                        });
+  });
+}
+
+template <typename MessageT>
+ReadAwaiter<MessageT> Reader<MessageT>::Read() {
+  SubscribeAwaitQueue();
+  return ReadAwaiter<MessageT>(&await_queue_, false, AwaitClock::time_point());
+}
+
+template <typename MessageT>
+ReadAwaiter<MessageT> Reader<MessageT>::ReadUntil(
+    const AwaitClock::time_point& deadline) {
+  SubscribeAwaitQueue();
+  return ReadAwaiter<MessageT>(&await_queue_, true, deadline);
+}
+
+template <typename MessageT>
+void Reader<MessageT>::SetAwaitExecutor(AwaitExecutor* executor) {
+  await_queue_.set_executor(executor);
+}
+#endif
 
 }
 }
\ No newline at end of file
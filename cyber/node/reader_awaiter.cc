@@ -0,0 +1,221 @@
+#include "cyber/node/reader_awaiter.h"
+
+#if CYBER_HAS_COROUTINE
+
+#include <algorithm>
+
+namespace apollo {
+namespace cyber {
+
+AwaitResumer::AwaitResumer() {
+  const size_t thread_num =
+      std::max(2u, std::thread::hardware_concurrency() / 4);
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads_.emplace_back(&AwaitResumer::ThreadFunc, this);
+  }
+}
+
+AwaitResumer::~AwaitResumer() { Shutdown(); }
+
+void AwaitResumer::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+      return;
+    }
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    // a coroutine may shut us down from one of our threads
+    if (thread.get_id() == std::this_thread::get_id()) {
+      thread.detach();
+    } else if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+void AwaitResumer::Post(std::coroutine_handle<> handle) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!shutdown_) {
+      queue_.push_back(handle);
+      handle = nullptr;
+    }
+  }
+  if (handle) {
+    // only at exit, nothing would resume it otherwise
+    handle.resume();
+    return;
+  }
+  cv_.notify_one();
+}
+
+void AwaitResumer::ThreadFunc() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return shutdown_ || !queue_.empty(); });
+    // what was posted before Shutdown is still resumed
+    if (queue_.empty()) {
+      return;
+    }
+    auto handle = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    handle.resume();
+    lock.lock();
+  }
+}
+
+AwaitTimer::AwaitTimer() {
+  thread_ = std::thread(&AwaitTimer::ThreadFunc, this);
+}
+
+AwaitTimer::~AwaitTimer() { Shutdown(); }
+
+void AwaitTimer::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+      return;
+    }
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  // Schedule refuses new nodes now, time out the pending ones
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!heap_.empty()) {
+    AwaitNode* node = heap_.front();
+    Remove(0);
+    if (node->TryFinish(AwaitNode::kTimedOut)) {
+      Fire(node, &lock);
+    }
+  }
+}
+
+bool AwaitTimer::Schedule(AwaitNode* node) {
+  bool earliest = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+      return false;
+    }
+    node->heap_index = heap_.size();
+    heap_.push_back(node);
+    SiftUp(node->heap_index);
+    earliest = heap_.front() == node;
+  }
+  if (earliest) {
+    cv_.notify_all();
+  }
+  return true;
+}
+
+void AwaitTimer::Cancel(AwaitNode* node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (node->heap_index != AwaitNode::kNoIndex) {
+    Remove(node->heap_index);
+  }
+}
+
+void AwaitTimer::WaitIdle(const void* queue) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this, queue] { return firing_queue_ != queue; });
+}
+
+void AwaitTimer::ThreadFunc() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!shutdown_) {
+    if (heap_.empty()) {
+      cv_.wait(lock);
+      continue;
+    }
+    AwaitNode* node = heap_.front();
+    // a copy, the node may be finished and freed while we wait
+    const auto deadline = node->deadline;
+    if (AwaitClock::now() < deadline) {
+      cv_.wait_until(lock, deadline);
+      continue;
+    }
+    Remove(0);
+    // lost against a message, the deliverer owns the node now
+    if (!node->TryFinish(AwaitNode::kTimedOut)) {
+      continue;
+    }
+    Fire(node, &lock);
+  }
+}
+
+void AwaitTimer::Fire(AwaitNode* node, std::unique_lock<std::mutex>* lock) {
+  // The node is ours until resumed, but its queue may be shutting down,
+  // firing_queue_ makes AwaitQueue::Shutdown wait for the unlink.
+  firing_queue_ = node->queue;
+  lock->unlock();
+  node->on_timeout(node);
+  lock->lock();
+  firing_queue_ = nullptr;
+  cv_.notify_all();
+  lock->unlock();
+  node->executor->Post(node->handle);
+  lock->lock();
+}
+
+void AwaitTimer::Swap(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  heap_[a]->heap_index = a;
+  heap_[b]->heap_index = b;
+}
+
+void AwaitTimer::SiftUp(size_t index) {
+  while (index > 0) {
+    const size_t parent = (index - 1) / 2;
+    if (heap_[parent]->deadline <= heap_[index]->deadline) {
+      break;
+    }
+    Swap(parent, index);
+    index = parent;
+  }
+}
+
+void AwaitTimer::SiftDown(size_t index) {
+  const size_t size = heap_.size();
+  while (true) {
+    size_t smallest = index;
+    const size_t left = 2 * index + 1;
+    const size_t right = left + 1;
+    if (left < size && heap_[left]->deadline < heap_[smallest]->deadline) {
+      smallest = left;
+    }
+    if (right < size && heap_[right]->deadline < heap_[smallest]->deadline) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      break;
+    }
+    Swap(index, smallest);
+    index = smallest;
+  }
+}
+
+void AwaitTimer::Remove(size_t index) {
+  AwaitNode* node = heap_[index];
+  const size_t last = heap_.size() - 1;
+  if (index != last) {
+    Swap(index, last);
+  }
+  heap_.pop_back();
+  node->heap_index = AwaitNode::kNoIndex;
+  if (index < heap_.size()) {
+    SiftDown(index);
+    SiftUp(index);
+  }
+}
+
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_HAS_COROUTINE
@@ -0,0 +1,404 @@
+#ifndef CYBER_NODE_READER_AWAITER_H_
+#define CYBER_NODE_READER_AWAITER_H_
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#define CYBER_HAS_COROUTINE 1
+#else
+#define CYBER_HAS_COROUTINE 0
+#endif
+
+#if CYBER_HAS_COROUTINE
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cyber/common/macros.h"
+
+namespace apollo {
+namespace cyber {
+
+using AwaitClock = std::chrono::steady_clock;
+
+/**
+ * @brief Resumes a suspended Read() once its message or deadline is there.
+ *
+ * Post is called from the thread delivering the message, which holds the
+ * callback lock of the channel's Blocker, and from the AwaitTimer thread.
+ * It must hand the coroutine to another thread and never resume it inline,
+ * a coroutine resumed there could not Subscribe or Unsubscribe.
+ */
+class AwaitExecutor {
+ public:
+  virtual ~AwaitExecutor() = default;
+  virtual void Post(std::coroutine_handle<> handle) = 0;
+};
+
+/**
+ * @brief The default AwaitExecutor, a fixed number of threads shared by
+ * every Reader of the process.
+ *
+ * A coroutine that blocks holds one of the threads, a scheduler that runs
+ * blocking stages sets its own executor on their readers.
+ */
+class AwaitResumer : public AwaitExecutor {
+ public:
+  ~AwaitResumer() override;
+
+  void Post(std::coroutine_handle<> handle) override;
+  // resumes what was posted, then stops; a later Post resumes inline
+  void Shutdown();
+
+  size_t ThreadNum() const { return threads_.size(); }
+
+ private:
+  void ThreadFunc();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::coroutine_handle<>> queue_;
+  bool shutdown_ = false;
+  std::vector<std::thread> threads_;
+
+  // AwaitQueue keeps a pointer to it
+  DECLARE_SINGLETON_NO_RESET(AwaitResumer)
+};
+
+/**
+ * @brief State of one suspended Read(), it lives in the coroutine frame so a
+ * wait allocates nothing.
+ *
+ * A waiter is finished exactly once, by the message or by the deadline,
+ * whoever wins the CAS on `state` resumes the coroutine.
+ */
+struct AwaitNode {
+  enum State : uint32_t { kWaiting = 0, kDelivered, kTimedOut };
+  static constexpr size_t kNoIndex = static_cast<size_t>(-1);
+
+  std::atomic<uint32_t> state{kWaiting};
+  std::coroutine_handle<> handle;
+  AwaitExecutor* executor = nullptr;
+  // AwaitQueue list, guarded by the queue mutex
+  AwaitNode* prev = nullptr;
+  AwaitNode* next = nullptr;
+  bool linked = false;
+  // AwaitTimer heap, guarded by the timer mutex
+  AwaitClock::time_point deadline;
+  size_t heap_index = kNoIndex;
+  // called by the timer once it won, unlinks the node from its queue
+  void (*on_timeout)(AwaitNode*) = nullptr;
+  void* queue = nullptr;
+
+  bool TryFinish(State to) {
+    uint32_t expected = kWaiting;
+    return state.compare_exchange_strong(expected, to,
+                                         std::memory_order_acq_rel);
+  }
+};
+
+/**
+ * @brief One thread for the deadlines of all ReadUntil() calls.
+ *
+ * The pending nodes are an indexed binary heap, so cancelling a node that
+ * got its message is O(log n) and the heap vector is the only storage.
+ * Timed out coroutines are posted to their executor, the timer thread never
+ * runs user code. After Shutdown every pending ReadUntil() times out at
+ * once and a new one does not suspend.
+ */
+class AwaitTimer {
+ public:
+  ~AwaitTimer();
+
+  // false after Shutdown, the node is not armed
+  bool Schedule(AwaitNode* node);
+  // for a node finished by its message, the timer will not touch it anymore
+  void Cancel(AwaitNode* node);
+  // waits until no timeout of `queue` is being unlinked
+  void WaitIdle(const void* queue);
+  void Shutdown();
+
+ private:
+  void ThreadFunc();
+  // times out the node the caller removed from the heap, `lock` is released
+  // meanwhile
+  void Fire(AwaitNode* node, std::unique_lock<std::mutex>* lock);
+  void Swap(size_t a, size_t b);
+  void SiftUp(size_t index);
+  void SiftDown(size_t index);
+  void Remove(size_t index);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<AwaitNode*> heap_;
+  // queue of the timed out node unlinked right now
+  const void* firing_queue_ = nullptr;
+  std::thread thread_;
+  bool shutdown_ = false;
+
+  // suspended nodes keep their heap_index into this instance
+  DECLARE_SINGLETON_NO_RESET(AwaitTimer)
+};
+
+/**
+ * @brief Hands published messages to the coroutines suspended in
+ * Reader::Read().
+ *
+ * A message that arrives with nobody waiting is kept, only the latest one,
+ * as the default pending_queue_size 1 of Reader does, and the next Read()
+ * returns it without suspending.
+ */
+template <typename MessageT>
+class AwaitQueue {
+ public:
+  using MessagePtr = std::shared_ptr<MessageT>;
+
+  AwaitQueue() = default;
+  ~AwaitQueue() { Shutdown(); }
+  AwaitQueue(const AwaitQueue&) = delete;
+  AwaitQueue& operator=(const AwaitQueue&) = delete;
+
+  void Deliver(const MessagePtr& msg);
+  // wakes every waiter with nullptr, the Reader is going away
+  void Shutdown();
+
+  void set_executor(AwaitExecutor* executor) { executor_ = executor; }
+  // AwaitResumer unless one was set
+  AwaitExecutor* executor() const {
+    return executor_ != nullptr ? executor_ : AwaitResumer::Instance();
+  }
+
+ private:
+  template <typename>
+  friend class ReadAwaiter;
+
+  struct Node : AwaitNode {
+    // written by the deliverer that won the node, before it is resumed
+    MessagePtr msg;
+  };
+
+  // the message is taken at once if one is pending
+  bool TakePending(MessagePtr* msg);
+  // registers the node, false with node->msg set if a message was pending
+  bool Suspend(Node* node);
+  void Link(AwaitNode* node);
+  void Unlink(AwaitNode* node);
+  static void OnTimeout(AwaitNode* node);
+
+  std::mutex mutex_;
+  AwaitNode* head_ = nullptr;
+  AwaitNode* tail_ = nullptr;
+  MessagePtr pending_;
+  AwaitExecutor* executor_ = nullptr;
+};
+
+/**
+ * @brief The awaitable returned by Reader::Read() and Reader::ReadUntil().
+ *
+ * `co_await` yields the next message, or nullptr once the deadline passed,
+ * the reader shut down or the AwaitTimer shut down.
+ */
+template <typename MessageT>
+class ReadAwaiter {
+ public:
+  using MessagePtr = std::shared_ptr<MessageT>;
+
+  ReadAwaiter(AwaitQueue<MessageT>* queue, bool has_deadline,
+              AwaitClock::time_point deadline)
+      : queue_(queue), has_deadline_(has_deadline) {
+    node_.deadline = deadline;
+  }
+  ReadAwaiter(const ReadAwaiter&) = delete;
+  ReadAwaiter& operator=(const ReadAwaiter&) = delete;
+
+  bool await_ready() {
+    if (queue_->TakePending(&node_.msg)) {
+      return true;
+    }
+    return has_deadline_ && AwaitClock::now() >= node_.deadline;
+  }
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    node_.handle = handle;
+    node_.executor = queue_->executor();
+    if (!has_deadline_) {
+      node_.deadline = AwaitClock::time_point::max();
+    }
+    return queue_->Suspend(&node_);
+  }
+
+  MessagePtr await_resume() { return std::move(node_.msg); }
+
+ private:
+  AwaitQueue<MessageT>* queue_;
+  bool has_deadline_;
+  typename AwaitQueue<MessageT>::Node node_;
+};
+
+/**
+ * @brief Return type of a coroutine that is started and then left running on
+ * its own, e.g. a pipeline stage looping over `co_await reader->Read()`.
+ *
+ * The frame is allocated once when the coroutine starts and freed when it
+ * returns.
+ */
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+template <typename MessageT>
+bool AwaitQueue<MessageT>::TakePending(MessagePtr* msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_ == nullptr) {
+    return false;
+  }
+  *msg = std::move(pending_);
+  pending_.reset();
+  return true;
+}
+
+template <typename MessageT>
+bool AwaitQueue<MessageT>::Suspend(Node* node) {
+  // The timer is armed under mutex_: a deliverer or the timer can only
+  // resume the coroutine after they took mutex_, i.e. after await_suspend
+  // stopped touching the frame.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_ != nullptr) {
+    node->msg = std::move(pending_);
+    pending_.reset();
+    return false;
+  }
+  node->queue = this;
+  node->on_timeout = &AwaitQueue::OnTimeout;
+  if (node->deadline != AwaitClock::time_point::max() &&
+      !AwaitTimer::Instance()->Schedule(node)) {
+    // no timer to end the wait, resume at once with nullptr
+    return false;
+  }
+  Link(node);
+  return true;
+}
+
+template <typename MessageT>
+void AwaitQueue<MessageT>::Deliver(const MessagePtr& msg) {
+  AwaitNode* woken = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AwaitNode* node = head_;
+    while (node != nullptr) {
+      AwaitNode* next = node->next;
+      Unlink(node);
+      if (node->TryFinish(AwaitNode::kDelivered)) {
+        static_cast<Node*>(node)->msg = msg;
+        // reuse prev as the list of nodes to resume
+        node->prev = woken;
+        woken = node;
+      }
+      node = next;
+    }
+    if (woken == nullptr) {
+      pending_ = msg;
+      return;
+    }
+  }
+  while (woken != nullptr) {
+    AwaitNode* next = woken->prev;
+    if (woken->deadline != AwaitClock::time_point::max()) {
+      AwaitTimer::Instance()->Cancel(woken);
+    }
+    woken->executor->Post(woken->handle);
+    woken = next;
+  }
+}
+
+template <typename MessageT>
+void AwaitQueue<MessageT>::Shutdown() {
+  AwaitNode* woken = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.reset();
+    while (head_ != nullptr) {
+      AwaitNode* node = head_;
+      Unlink(node);
+      if (node->TryFinish(AwaitNode::kTimedOut)) {
+        node->prev = woken;
+        woken = node;
+      }
+    }
+  }
+  // a node the timer won may still be about to take mutex_
+  auto timer = AwaitTimer::Instance(false);
+  if (timer != nullptr) {
+    timer->WaitIdle(this);
+  }
+  while (woken != nullptr) {
+    AwaitNode* next = woken->prev;
+    if (woken->deadline != AwaitClock::time_point::max()) {
+      AwaitTimer::Instance()->Cancel(woken);
+    }
+    woken->executor->Post(woken->handle);
+    woken = next;
+  }
+}
+
+template <typename MessageT>
+void AwaitQueue<MessageT>::OnTimeout(AwaitNode* node) {
+  auto queue = static_cast<AwaitQueue*>(node->queue);
+  std::lock_guard<std::mutex> lock(queue->mutex_);
+  queue->Unlink(node);
+}
+
+template <typename MessageT>
+void AwaitQueue<MessageT>::Link(AwaitNode* node) {
+  node->prev = tail_;
+  node->next = nullptr;
+  if (tail_ != nullptr) {
+    tail_->next = node;
+  } else {
+    head_ = node;
+  }
+  tail_ = node;
+  node->linked = true;
+}
+
+template <typename MessageT>
+void AwaitQueue<MessageT>::Unlink(AwaitNode* node) {
+  if (!node->linked) {
+    return;
+  }
+  if (node->prev != nullptr) {
+    node->prev->next = node->next;
+  } else {
+    head_ = node->next;
+  }
+  if (node->next != nullptr) {
+    node->next->prev = node->prev;
+  } else {
+    tail_ = node->prev;
+  }
+  node->prev = nullptr;
+  node->next = nullptr;
+  node->linked = false;
+}
+
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_HAS_COROUTINE
+
+#endif  // CYBER_NODE_READER_AWAITER_H_
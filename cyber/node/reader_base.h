@@ -10,6 +10,7 @@
 #include "cyber/common/macros.h"
 #include "cyber/common/util.h"
 #include "cyber/event/perf_event_cache.h"
+#include "cyber/message/proto_desc_cache.h"
 #include "cyber/transport/transport.h"
 
 namespace apollo {
@@ -29,8 +30,12 @@ using apollo::cyber::event::TransPerf;
  */
 class ReaderBase {
   public:
-    explicit ReaderBase(const proto::RoleAtrributes& role_attr)
-        : role_attr_(role_attr), init_(false) {}
+    // the descriptor goes to message::ProtoDescCache, the readers of one
+    // message type share it; JoinTheTopology expands it on the copy it sends
+    explicit ReaderBase(const proto::RoleAttributes& role_attr)
+        : role_attr_(role_attr), init_(false) {
+      message::ProtoDescCache::Instance()->Dedup(&role_attr_);
+    }
     virtual ~ReaderBase() {}
 
     /**@brif Init the Reader object
@@ -132,7 +137,7 @@ class ReaderBase {
     bool IsInit() const { return init_.load(); }
     
   protected:
-    proto::RoleAtrributes role_attr_;
+    proto::RoleAttributes role_attr_;
     std::atomic<bool> init_;
 };
 
@@ -0,0 +1,347 @@
+#include "cyber/record/mmap_record.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+namespace {
+
+size_t PageSize() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+MmapRecordWriter::MmapRecordWriter(size_t chunk_size)
+    : page_size_(PageSize()), chunk_size_(chunk_size) {}
+
+MmapRecordWriter::~MmapRecordWriter() {
+  if (fd_ >= 0) {
+    Close();
+  }
+}
+
+bool MmapRecordWriter::Open(const std::string& path) {
+  fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    AERROR << "open record " << path << " failed: " << strerror(errno);
+    return false;
+  }
+  offset_ = 0;
+  buffer_.clear();
+  channels_.clear();
+  channel_ids_.clear();
+  index_.clear();
+  // the header is written on Close
+  std::vector<char> header_page(page_size_, 0);
+  if (!WriteBytes(header_page.data(), header_page.size())) {
+    return false;
+  }
+  chunk_begin_ = offset_;
+  return true;
+}
+
+bool MmapRecordWriter::Write(const std::string& channel_name,
+                             const std::string& message_type,
+                             uint64_t timestamp, const std::string& content) {
+  if (fd_ < 0) {
+    return false;
+  }
+  // the index keeps the size in 32 bits
+  if (content.size() > std::numeric_limits<uint32_t>::max()) {
+    AERROR << "message of " << content.size() << " bytes on " << channel_name
+           << " is too large for a mmap record.";
+    return false;
+  }
+  auto iter = channel_ids_.find(channel_name);
+  if (iter == channel_ids_.end()) {
+    iter = channel_ids_
+               .emplace(channel_name, static_cast<uint32_t>(channels_.size()))
+               .first;
+    channels_.push_back({channel_name, message_type});
+  }
+  // a message does not start a chunk it would overflow, unless it is alone
+  if (offset_ != chunk_begin_ &&
+      offset_ - chunk_begin_ + content.size() > chunk_size_) {
+    if (!PadTo(page_size_)) {
+      return false;
+    }
+    chunk_begin_ = offset_;
+  }
+  index_.push_back({timestamp, offset_, static_cast<uint32_t>(content.size()),
+                    iter->second});
+  return WriteBytes(content.data(), content.size()) && PadTo(8);
+}
+
+bool MmapRecordWriter::Close() {
+  if (fd_ < 0) {
+    return false;
+  }
+  bool ok = PadTo(page_size_);
+  MmapRecordHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMmapRecordMagic, sizeof(header.magic));
+  header.version = kMmapRecordVersion;
+  header.page_size = static_cast<uint32_t>(page_size_);
+  header.message_count = index_.size();
+  header.channel_count = static_cast<uint32_t>(channels_.size());
+  header.channel_table_offset = offset_;
+  for (const auto& channel : channels_) {
+    const uint32_t name_size = static_cast<uint32_t>(channel.name.size());
+    const uint32_t type_size =
+        static_cast<uint32_t>(channel.message_type.size());
+    ok = ok && WriteBytes(&name_size, sizeof(name_size)) &&
+         WriteBytes(channel.name.data(), name_size) &&
+         WriteBytes(&type_size, sizeof(type_size)) &&
+         WriteBytes(channel.message_type.data(), type_size);
+  }
+  header.channel_table_size = offset_ - header.channel_table_offset;
+  ok = ok && PadTo(page_size_);
+
+  std::stable_sort(index_.begin(), index_.end(),
+                   [](const MmapIndexEntry& a, const MmapIndexEntry& b) {
+                     return a.timestamp < b.timestamp;
+                   });
+  header.index_offset = offset_;
+  header.begin_time = index_.empty() ? 0 : index_.front().timestamp;
+  header.end_time = index_.empty() ? 0 : index_.back().timestamp;
+  ok = ok && WriteBytes(index_.data(), index_.size() * sizeof(MmapIndexEntry));
+  ok = ok && Flush();
+  ok = ok && pwrite(fd_, &header, sizeof(header), 0) ==
+                 static_cast<ssize_t>(sizeof(header));
+  close(fd_);
+  fd_ = -1;
+  if (!ok) {
+    AERROR << "write record failed: " << strerror(errno);
+  }
+  return ok;
+}
+
+bool MmapRecordWriter::WriteBytes(const void* data, size_t size) {
+  buffer_.append(static_cast<const char*>(data), size);
+  offset_ += size;
+  return buffer_.size() < kBufferSize || Flush();
+}
+
+bool MmapRecordWriter::Flush() {
+  const char* bytes = buffer_.data();
+  size_t size = buffer_.size();
+  buffer_.clear();
+  while (size > 0) {
+    const ssize_t written = write(fd_, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      AERROR << "write record failed: " << strerror(errno);
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool MmapRecordWriter::PadTo(size_t alignment) {
+  static const char kZeros[64] = {0};
+  uint64_t padding = AlignUp(offset_, alignment) - offset_;
+  while (padding > 0) {
+    const size_t size = std::min<uint64_t>(padding, sizeof(kZeros));
+    if (!WriteBytes(kZeros, size)) {
+      return false;
+    }
+    padding -= size;
+  }
+  return true;
+}
+
+MmapRecordReader::~MmapRecordReader() { Close(); }
+
+bool MmapRecordReader::Open(const std::string& path) {
+  Close();
+  fd_ = open(path.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    AERROR << "open record " << path << " failed: " << strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(MmapRecordHeader)) {
+    AERROR << "record " << path << " is too short.";
+    Close();
+    return false;
+  }
+  length_ = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (addr == MAP_FAILED) {
+    AERROR << "mmap record " << path << " failed: " << strerror(errno);
+    base_ = nullptr;
+    Close();
+    return false;
+  }
+  base_ = static_cast<char*>(addr);
+  page_size_ = PageSize();
+  header_ = reinterpret_cast<const MmapRecordHeader*>(base_);
+  if (memcmp(header_->magic, kMmapRecordMagic, sizeof(header_->magic)) != 0 ||
+      header_->version != kMmapRecordVersion ||
+      header_->index_offset > length_ ||
+      header_->index_offset % alignof(MmapIndexEntry) != 0 ||
+      header_->message_count >
+          (length_ - header_->index_offset) / sizeof(MmapIndexEntry) ||
+      header_->channel_table_offset > length_ ||
+      header_->channel_table_size > length_ - header_->channel_table_offset) {
+    AERROR << "record " << path << " is not a mmap record or is truncated.";
+    Close();
+    return false;
+  }
+  index_ = reinterpret_cast<const MmapIndexEntry*>(base_ +
+                                                   header_->index_offset);
+  count_ = static_cast<size_t>(header_->message_count);
+
+  const char* table = base_ + header_->channel_table_offset;
+  const char* table_end = table + header_->channel_table_size;
+  auto read_string = [&table, table_end](std::string* value) {
+    uint32_t size = 0;
+    if (table + sizeof(size) > table_end) {
+      return false;
+    }
+    memcpy(&size, table, sizeof(size));
+    table += sizeof(size);
+    if (table + size > table_end) {
+      return false;
+    }
+    value->assign(table, size);
+    table += size;
+    return true;
+  };
+  channels_.resize(header_->channel_count);
+  for (auto& channel : channels_) {
+    if (!read_string(&channel.name) || !read_string(&channel.message_type)) {
+      AERROR << "record " << path << " has a broken channel table.";
+      Close();
+      return false;
+    }
+  }
+
+  // Message() and the replayer trust the index, so every entry is checked
+  // once here: its data lies between the header and the channel table, its
+  // channel exists and the index is sorted for LowerBound
+  for (size_t i = 0; i < count_; ++i) {
+    const auto& entry = index_[i];
+    if (entry.offset < sizeof(MmapRecordHeader) ||
+        entry.offset > header_->channel_table_offset ||
+        entry.size > header_->channel_table_offset - entry.offset ||
+        entry.channel >= header_->channel_count ||
+        (i > 0 && entry.timestamp < index_[i - 1].timestamp)) {
+      AERROR << "record " << path << " has a broken index entry " << i << ".";
+      Close();
+      return false;
+    }
+  }
+
+  // the index is searched on every seek, the messages are read in order
+  madvise(base_ + header_->index_offset / page_size_ * page_size_,
+          length_ - header_->index_offset / page_size_ * page_size_,
+          MADV_WILLNEED);
+  madvise(base_, header_->channel_table_offset, MADV_SEQUENTIAL);
+  return true;
+}
+
+void MmapRecordReader::Close() {
+  if (base_ != nullptr) {
+    munmap(base_, length_);
+    base_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  header_ = nullptr;
+  index_ = nullptr;
+  count_ = 0;
+  length_ = 0;
+  channels_.clear();
+}
+
+MmapMessageView MmapRecordReader::Message(size_t index) const {
+  const auto& entry = index_[index];
+  return {entry.channel, entry.timestamp, base_ + entry.offset, entry.size};
+}
+
+size_t MmapRecordReader::LowerBound(uint64_t timestamp) const {
+  return std::lower_bound(index_, index_ + count_, timestamp,
+                          [](const MmapIndexEntry& entry, uint64_t time) {
+                            return entry.timestamp < time;
+                          }) -
+         index_;
+}
+
+int MmapRecordReader::ChannelId(const std::string& name) const {
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    if (channels_[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool MmapRecordReader::DataSpan(size_t begin, size_t end, char** addr,
+                                size_t* length) const {
+  end = std::min(end, count_);
+  if (begin >= end) {
+    return false;
+  }
+  // messages written out of time order may sit anywhere in the data
+  uint64_t low = index_[begin].offset;
+  uint64_t high = low + index_[begin].size;
+  for (size_t i = begin + 1; i < end; ++i) {
+    low = std::min(low, index_[i].offset);
+    high = std::max(high, index_[i].offset + index_[i].size);
+  }
+  low = low / page_size_ * page_size_;
+  *addr = base_ + low;
+  *length = static_cast<size_t>(high - low);
+  return true;
+}
+
+void MmapRecordReader::WillNeed(size_t begin, size_t end) const {
+  char* addr = nullptr;
+  size_t length = 0;
+  if (DataSpan(begin, end, &addr, &length)) {
+    madvise(addr, length, MADV_WILLNEED);
+  }
+}
+
+void MmapRecordReader::DontNeed(size_t begin, size_t end) const {
+  char* addr = nullptr;
+  size_t length = 0;
+  if (DataSpan(begin, end, &addr, &length)) {
+    // only whole pages behind the last message, the next may share one
+    const uint64_t keep = index_[std::min(end, count_) - 1].offset;
+    const size_t whole =
+        keep <= static_cast<uint64_t>(addr - base_)
+            ? 0
+            : (keep - static_cast<uint64_t>(addr - base_)) / page_size_ *
+                  page_size_;
+    if (whole > 0) {
+      madvise(addr, std::min(whole, length), MADV_DONTNEED);
+    }
+  }
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
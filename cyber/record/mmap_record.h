@@ -0,0 +1,150 @@
+#ifndef CYBER_RECORD_MMAP_RECORD_H_
+#define CYBER_RECORD_MMAP_RECORD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+/**
+ * File layout of a mmap record, every section starts on a page:
+ *
+ *   MmapRecordHeader           page 0
+ *   message chunks             each chunk starts on a page, the messages in
+ *                              it are 8 byte aligned serialized bytes
+ *   channel table              per channel: uint32 name length, name,
+ *                              uint32 type length, type
+ *   MmapIndexEntry[]           sorted by timestamp, ties in write order
+ *
+ * The reader maps the file once, the index is searched in place and a
+ * message is parsed straight from the mapped pages.
+ */
+constexpr char kMmapRecordMagic[8] = {'C', 'Y', 'B', 'M', 'M', 'R', 'E', 'C'};
+constexpr uint32_t kMmapRecordVersion = 1;
+
+struct MmapRecordHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t page_size;
+  uint64_t message_count;
+  uint32_t channel_count;
+  uint32_t reserved;
+  uint64_t channel_table_offset;
+  uint64_t channel_table_size;
+  uint64_t index_offset;
+  uint64_t begin_time;
+  uint64_t end_time;
+};
+
+struct MmapIndexEntry {
+  uint64_t timestamp;
+  uint64_t offset;
+  uint32_t size;
+  uint32_t channel;
+};
+static_assert(sizeof(MmapIndexEntry) == 24, "the index is read in place");
+
+struct MmapChannelInfo {
+  std::string name;
+  std::string message_type;
+};
+
+/**
+ * @class MmapRecordWriter
+ * @brief Writes a mmap record, messages may come in any time order, the
+ * index is sorted on Close.
+ */
+class MmapRecordWriter {
+ public:
+  // a chunk is filled up to `chunk_size` bytes before the next page starts
+  explicit MmapRecordWriter(size_t chunk_size = 1 << 20);
+  ~MmapRecordWriter();
+
+  bool Open(const std::string& path);
+  // false if the writer is not open or `content` is 4 GiB or larger
+  bool Write(const std::string& channel_name, const std::string& message_type,
+             uint64_t timestamp, const std::string& content);
+  bool Close();
+
+ private:
+  static constexpr size_t kBufferSize = 1 << 20;
+
+  bool WriteBytes(const void* data, size_t size);
+  bool Flush();
+  bool PadTo(size_t alignment);
+
+  int fd_ = -1;
+  size_t page_size_;
+  size_t chunk_size_;
+  uint64_t offset_ = 0;
+  uint64_t chunk_begin_ = 0;
+  std::vector<MmapChannelInfo> channels_;
+  std::unordered_map<std::string, uint32_t> channel_ids_;
+  std::vector<MmapIndexEntry> index_;
+  // written to fd_ once kBufferSize is reached
+  std::string buffer_;
+};
+
+/**
+ * @brief One message, `data` points into the mapping and stays valid as
+ * long as the MmapRecordReader is open
+ */
+struct MmapMessageView {
+  uint32_t channel;
+  uint64_t timestamp;
+  const char* data;
+  size_t size;
+};
+
+/**
+ * @class MmapRecordReader
+ * @brief Maps a mmap record read only, the index is searched in place.
+ */
+class MmapRecordReader {
+ public:
+  MmapRecordReader() = default;
+  ~MmapRecordReader();
+
+  bool Open(const std::string& path);
+  void Close();
+
+  size_t MessageCount() const { return count_; }
+  MmapMessageView Message(size_t index) const;
+  const MmapIndexEntry& Entry(size_t index) const { return index_[index]; }
+  // first message at or after `timestamp`, MessageCount() if none
+  size_t LowerBound(uint64_t timestamp) const;
+
+  uint64_t BeginTime() const { return header_->begin_time; }
+  uint64_t EndTime() const { return header_->end_time; }
+  const std::vector<MmapChannelInfo>& Channels() const { return channels_; }
+  // -1 if the channel is not in the record
+  int ChannelId(const std::string& name) const;
+
+  // madvise the pages of messages [begin, end) in, or out once played
+  void WillNeed(size_t begin, size_t end) const;
+  void DontNeed(size_t begin, size_t end) const;
+
+ private:
+  // page aligned span of the data of messages [begin, end)
+  bool DataSpan(size_t begin, size_t end, char** addr, size_t* length) const;
+
+  int fd_ = -1;
+  char* base_ = nullptr;
+  size_t length_ = 0;
+  size_t page_size_ = 0;
+  const MmapRecordHeader* header_ = nullptr;
+  const MmapIndexEntry* index_ = nullptr;
+  size_t count_ = 0;
+  std::vector<MmapChannelInfo> channels_;
+};
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_RECORD_MMAP_RECORD_H_
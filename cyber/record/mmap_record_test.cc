@@ -0,0 +1,147 @@
+#include "cyber/record/mmap_record.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+namespace {
+
+class MmapRecordTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/mmap_record_test_XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    path_ = path;
+  }
+
+  void TearDown() override { unlink(path_.c_str()); }
+
+  MmapRecordHeader ReadHeader() const {
+    MmapRecordHeader header;
+    const int fd = open(path_.c_str(), O_RDONLY);
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(header)),
+              pread(fd, &header, sizeof(header), 0));
+    close(fd);
+    return header;
+  }
+
+  void WriteHeader(const MmapRecordHeader& header) const {
+    const int fd = open(path_.c_str(), O_WRONLY);
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(header)),
+              pwrite(fd, &header, sizeof(header), 0));
+    close(fd);
+  }
+
+  std::string path_;
+};
+
+std::string Payload(uint64_t i) {
+  return std::string(100 + i % 7, static_cast<char>('a' + i % 26));
+}
+
+}  // namespace
+
+TEST_F(MmapRecordTest, RoundTrip) {
+  MmapRecordWriter writer(4096);
+  ASSERT_TRUE(writer.Open(path_));
+  for (uint64_t i = 0; i < 200; ++i) {
+    ASSERT_TRUE(writer.Write("/lidar", "Scan", i * 100, Payload(i)));
+    ASSERT_TRUE(writer.Write("/pose", "Pose", i * 100 + 50,
+                             "pose" + std::to_string(i)));
+  }
+  // out of time order, sorted by the index
+  ASSERT_TRUE(writer.Write("/late", "Pose", 1051, "late"));
+  ASSERT_TRUE(writer.Close());
+
+  MmapRecordReader reader;
+  ASSERT_TRUE(reader.Open(path_));
+  ASSERT_EQ(401, reader.MessageCount());
+  ASSERT_EQ(3, reader.Channels().size());
+  EXPECT_EQ("Pose", reader.Channels()[reader.ChannelId("/pose")].message_type);
+  EXPECT_EQ(-1, reader.ChannelId("/nope"));
+  EXPECT_EQ(0, reader.BeginTime());
+  EXPECT_EQ(199 * 100 + 50, reader.EndTime());
+
+  const int lidar = reader.ChannelId("/lidar");
+  uint64_t lidar_count = 0;
+  for (size_t i = 0; i < reader.MessageCount(); ++i) {
+    const auto message = reader.Message(i);
+    if (i > 0) {
+      EXPECT_LE(reader.Entry(i - 1).timestamp, message.timestamp);
+    }
+    if (static_cast<int>(message.channel) == lidar) {
+      EXPECT_EQ(Payload(message.timestamp / 100),
+                std::string(message.data, message.size));
+      EXPECT_EQ(0, reader.Entry(i).offset % 8);
+      ++lidar_count;
+    }
+  }
+  EXPECT_EQ(200, lidar_count);
+
+  const size_t late = reader.LowerBound(1051);
+  const auto message = reader.Message(late);
+  EXPECT_EQ("late", std::string(message.data, message.size));
+  EXPECT_EQ(reader.MessageCount(), reader.LowerBound(1000000));
+}
+
+TEST_F(MmapRecordTest, RejectsABrokenIndexOffset) {
+  MmapRecordWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  ASSERT_TRUE(writer.Write("/pose", "Pose", 1, "pose"));
+  ASSERT_TRUE(writer.Close());
+  const MmapRecordHeader header = ReadHeader();
+  MmapRecordReader reader;
+  ASSERT_TRUE(reader.Open(path_));
+  reader.Close();
+
+  // a valid index moved off its 8 byte alignment
+  MmapIndexEntry entry;
+  const int fd = open(path_.c_str(), O_RDWR);
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(entry)),
+            pread(fd, &entry, sizeof(entry), header.index_offset));
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(entry)),
+            pwrite(fd, &entry, sizeof(entry), header.index_offset + 4));
+  close(fd);
+  MmapRecordHeader broken = header;
+  broken.index_offset += 4;
+  WriteHeader(broken);
+  EXPECT_FALSE(reader.Open(path_));
+
+  broken = header;
+  broken.index_offset = header.index_offset + 1024 * 1024;
+  WriteHeader(broken);
+  EXPECT_FALSE(reader.Open(path_));
+
+  // the index reaches past the end of the file
+  broken = header;
+  broken.message_count = 2;
+  WriteHeader(broken);
+  EXPECT_FALSE(reader.Open(path_));
+
+  const int restore_fd = open(path_.c_str(), O_WRONLY);
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(entry)),
+            pwrite(restore_fd, &entry, sizeof(entry), header.index_offset));
+  close(restore_fd);
+  WriteHeader(header);
+  EXPECT_TRUE(reader.Open(path_));
+}
+
+TEST_F(MmapRecordTest, WriteNeedsAnOpenRecord) {
+  MmapRecordWriter writer;
+  EXPECT_FALSE(writer.Write("/pose", "Pose", 1, "pose"));
+  EXPECT_FALSE(writer.Close());
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
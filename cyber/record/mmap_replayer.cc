@@ -0,0 +1,92 @@
+#include "cyber/record/mmap_replayer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+using Clock = std::chrono::steady_clock;
+
+MmapReplayer::MmapReplayer(const MmapRecordReader* reader, size_t readahead)
+    : reader_(reader),
+      readahead_(std::max<size_t>(1, readahead)),
+      handlers_(reader->Channels().size()) {}
+
+bool MmapReplayer::AddHandler(const std::string& channel_name,
+                              const Handler& handler) {
+  const int channel = reader_->ChannelId(channel_name);
+  if (channel < 0) {
+    AWARN << "channel " << channel_name << " is not in the record.";
+    return false;
+  }
+  auto& slot = handlers_[channel];
+  if (slot == nullptr) {
+    slot = handler;
+  } else {
+    // more than one Reader of the channel
+    Handler first = slot;
+    slot = [first, handler](const MmapMessageView& view) {
+      first(view);
+      handler(view);
+    };
+  }
+  return true;
+}
+
+void MmapReplayer::Seek(uint64_t timestamp) {
+  position_ = reader_->LowerBound(timestamp);
+}
+
+size_t MmapReplayer::Play(double rate, uint64_t end_time) {
+  const size_t count = reader_->MessageCount();
+  if (position_ >= count) {
+    return 0;
+  }
+  const auto wall_begin = Clock::now();
+  const uint64_t record_begin = reader_->Entry(position_).timestamp;
+  uint64_t record_last = record_begin;
+  size_t handed = 0;
+
+  // two windows ahead are being read in, the one behind is dropped
+  size_t window_end = position_ + readahead_;
+  reader_->WillNeed(position_, position_ + 2 * readahead_);
+  for (; position_ < count; ++position_) {
+    const auto& entry = reader_->Entry(position_);
+    if (entry.timestamp >= end_time) {
+      break;
+    }
+    if (position_ == window_end) {
+      reader_->DontNeed(window_end - readahead_, window_end);
+      reader_->WillNeed(window_end + readahead_, window_end + 2 * readahead_);
+      window_end += readahead_;
+    }
+    const auto& handler = handlers_[entry.channel];
+    if (handler == nullptr) {
+      continue;
+    }
+    if (rate > 0.0) {
+      std::this_thread::sleep_until(
+          wall_begin +
+          std::chrono::nanoseconds(static_cast<int64_t>(
+              static_cast<double>(entry.timestamp - record_begin) / rate)));
+    }
+    handler(reader_->Message(position_));
+    record_last = entry.timestamp;
+    ++handed;
+    stats_.bytes += entry.size;
+  }
+  stats_.messages += handed;
+  stats_.record_ns += record_last - record_begin;
+  stats_.wall_ns += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           wall_begin)
+          .count());
+  return handed;
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,97 @@
+#ifndef CYBER_RECORD_MMAP_REPLAYER_H_
+#define CYBER_RECORD_MMAP_REPLAYER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cyber/common/log.h"
+#include "cyber/message/message_traits.h"
+#include "cyber/node/reader.h"
+#include "cyber/record/mmap_record.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+struct ReplayStats {
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  // record time covered and wall time taken by Play, in nanoseconds
+  uint64_t record_ns = 0;
+  uint64_t wall_ns = 0;
+  uint64_t parse_failures = 0;
+};
+
+/**
+ * @class MmapReplayer
+ * @brief Replays a MmapRecordReader into Readers or handlers.
+ *
+ * Messages are parsed straight from the mapped pages, nothing is copied
+ * into a buffer first. The pages of the next `readahead` messages are
+ * madvised in while the current ones play, the played ones are dropped, so
+ * hours of recording replay in a bounded page cache footprint.
+ */
+class MmapReplayer {
+ public:
+  using Handler = std::function<void(const MmapMessageView&)>;
+
+  explicit MmapReplayer(const MmapRecordReader* reader,
+                        size_t readahead = 256);
+
+  // false if the channel is not in the record
+  bool AddHandler(const std::string& channel_name, const Handler& handler);
+
+  // every message of the Reader's channel goes to Reader::Enqueue
+  template <typename MessageT>
+  bool AddReader(const std::shared_ptr<Reader<MessageT>>& reader);
+
+  // the next Play starts at the first message at or after `timestamp`
+  void Seek(uint64_t timestamp);
+
+  /**
+   * @brief Replay up to `end_time`
+   *
+   * @param rate 1.0 keeps the recorded pace, 10.0 is ten times faster, 0 as
+   * fast as the handlers go
+   * @return size_t the messages handed out
+   */
+  size_t Play(double rate = 0.0,
+              uint64_t end_time = std::numeric_limits<uint64_t>::max());
+
+  const ReplayStats& stats() const { return stats_; }
+
+ private:
+  const MmapRecordReader* reader_;
+  size_t readahead_;
+  // by channel id, empty for channels nobody replays
+  std::vector<Handler> handlers_;
+  size_t position_ = 0;
+  ReplayStats stats_;
+};
+
+template <typename MessageT>
+bool MmapReplayer::AddReader(const std::shared_ptr<Reader<MessageT>>& reader) {
+  const std::string& channel_name = reader->GetChannelName();
+  return AddHandler(channel_name, [this, reader](const MmapMessageView& view) {
+    auto msg = std::make_shared<MessageT>();
+    if (!message::ParseFromArray(view.data, static_cast<int>(view.size),
+                                 msg.get())) {
+      ++stats_.parse_failures;
+      AERROR << "parse message of " << reader->GetChannelName()
+             << " at " << view.timestamp << " failed.";
+      return;
+    }
+    reader->Enqueue(msg);
+  });
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_RECORD_MMAP_REPLAYER_H_
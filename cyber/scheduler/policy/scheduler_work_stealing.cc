@@ -0,0 +1,398 @@
+#include "cyber/scheduler/policy/scheduler_work_stealing.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace cyber {
+namespace scheduler {
+
+namespace {
+
+// the worker running on this thread, to push notifies into its own deque
+thread_local void* tls_scheduler = nullptr;
+thread_local void* tls_worker = nullptr;
+thread_local const void* tls_task = nullptr;
+
+// NUMA node of `cpu` from sysfs, 0 when unknown
+int NumaNodeOfCpu(int cpu) {
+  for (int node = 0; node < 64; ++node) {
+    char path[96];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d",
+                  cpu, node);
+    if (access(path, F_OK) == 0) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+SchedulerWorkStealing::SchedulerWorkStealing(const WorkStealingAttr& attr)
+    : attr_(attr) {
+  for (auto& pending : lane_pending_) {
+    pending.store(0, std::memory_order_relaxed);
+  }
+  uint32_t worker_num = attr_.worker_num;
+  if (worker_num == 0) {
+    worker_num = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (uint32_t i = 0; i < worker_num; ++i) {
+    auto worker = std::make_unique<Worker>();
+    worker->index = i;
+    if (i < attr_.cpus.size()) {
+      worker->cpu = attr_.cpus[i];
+    }
+    if (i < attr_.numa_nodes.size()) {
+      worker->numa_node = attr_.numa_nodes[i];
+    } else if (worker->cpu >= 0) {
+      worker->numa_node = NumaNodeOfCpu(worker->cpu);
+    }
+    workers_.push_back(std::move(worker));
+  }
+  for (auto& worker : workers_) {
+    // same node first, then the rest, each group starting after the worker
+    // itself so the thieves do not all hit worker 0
+    for (bool same_node : {true, false}) {
+      for (uint32_t step = 1; step < worker_num; ++step) {
+        const uint32_t victim = (worker->index + step) % worker_num;
+        if ((workers_[victim]->numa_node == worker->numa_node) == same_node) {
+          worker->victims.push_back(victim);
+        }
+      }
+    }
+  }
+  for (auto& worker : workers_) {
+    worker->thread = std::thread(&SchedulerWorkStealing::WorkerFunc, this,
+                                 worker.get());
+  }
+}
+
+SchedulerWorkStealing::~SchedulerWorkStealing() { Shutdown(); }
+
+void SchedulerWorkStealing::Shutdown() {
+  if (stop_.exchange(true)) {
+    return;
+  }
+  for (auto& worker : workers_) {
+    Wake(worker.get());
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+bool SchedulerWorkStealing::CreateTask(const std::function<void()>& func,
+                                       const std::string& name,
+                                       const WorkStealingTaskAttr& attr) {
+  if (func == nullptr || stop_.load()) {
+    return false;
+  }
+  auto task = std::make_shared<Task>();
+  task->func = func;
+  task->name = name;
+  task->priority = std::min(attr.priority, kWorkStealingLaneNum - 1);
+
+  std::lock_guard<std::shared_timed_mutex> lock(task_mutex_);
+  const uint64_t task_id = TaskId(name);
+  if (tasks_.count(task_id) != 0) {
+    AERROR << "task " << name << " already exists.";
+    return false;
+  }
+  if (attr.worker >= 0) {
+    task->home = static_cast<uint32_t>(attr.worker) % WorkerNum();
+  } else {
+    task->home = next_home_++ % WorkerNum();
+  }
+  tasks_[task_id] = std::move(task);
+  return true;
+}
+
+bool SchedulerWorkStealing::NotifyTask(uint64_t task_id) {
+  if (stop_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  std::shared_lock<std::shared_timed_mutex> lock(task_mutex_);
+  auto iter = tasks_.find(task_id);
+  if (iter == tasks_.end()) {
+    return false;
+  }
+  Task* task = iter->second.get();
+  if (task->removed.load(std::memory_order_acquire)) {
+    return false;
+  }
+  uint32_t state = task->state.load(std::memory_order_acquire);
+  while (true) {
+    switch (state) {
+      case Task::kIdle:
+        if (task->state.compare_exchange_weak(state, Task::kQueued,
+                                              std::memory_order_acq_rel)) {
+          Enqueue(task);
+          return true;
+        }
+        break;
+      case Task::kRunning:
+        // the worker runs it again when the current run returns
+        if (task->state.compare_exchange_weak(state, Task::kRunningNotified,
+                                              std::memory_order_acq_rel)) {
+          return true;
+        }
+        break;
+      default:
+        // already queued, one run covers every notify before it
+        return true;
+    }
+  }
+}
+
+bool SchedulerWorkStealing::RemoveTask(const std::string& name) {
+  const uint64_t task_id = TaskId(name);
+  std::shared_ptr<Task> task;
+  {
+    std::lock_guard<std::shared_timed_mutex> lock(task_mutex_);
+    auto iter = tasks_.find(task_id);
+    if (iter == tasks_.end()) {
+      return false;
+    }
+    task = iter->second;
+    // NotifyTask checks removed under the shared lock, so from here on the
+    // task is not queued again
+    task->removed.store(true, std::memory_order_seq_cst);
+    tasks_.erase(iter);
+  }
+  if (tls_task == task.get()) {
+    // the worker running us still uses the task after we return
+    Retire(std::move(task));
+    return true;
+  }
+  // Run stores kRunning before it checks removed, so a worker that took the
+  // task either drops it or is seen running here.
+  while (true) {
+    const uint32_t state = task->state.load(std::memory_order_seq_cst);
+    if (state == Task::kIdle) {
+      return true;
+    }
+    // Stopped workers never take it, and a worker waiting here may be the
+    // only one that would, its own deque is not stolen from without thieves.
+    // The worker that still takes it drops it.
+    if (state == Task::kQueued &&
+        (stop_.load(std::memory_order_acquire) || tls_scheduler == this)) {
+      Retire(std::move(task));
+      return true;
+    }
+    std::this_thread::yield();
+  }
+}
+
+void SchedulerWorkStealing::Retire(std::shared_ptr<Task> task) {
+  std::lock_guard<std::shared_timed_mutex> lock(task_mutex_);
+  // a removed task that went idle is never queued again
+  retired_.erase(
+      std::remove_if(retired_.begin(), retired_.end(),
+                     [](const std::shared_ptr<Task>& retired) {
+                       return retired->state.load(std::memory_order_acquire) ==
+                              Task::kIdle;
+                     }),
+      retired_.end());
+  retired_.push_back(std::move(task));
+}
+
+std::vector<WorkStealingStats> SchedulerWorkStealing::GetStats() const {
+  std::vector<WorkStealingStats> stats(workers_.size());
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    stats[i].executed = workers_[i]->executed.load(std::memory_order_relaxed);
+    stats[i].stolen = workers_[i]->stolen.load(std::memory_order_relaxed);
+    stats[i].sleeps = workers_[i]->sleeps.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void SchedulerWorkStealing::Enqueue(Task* task) {
+  const uint32_t lane = task->priority;
+  Worker* target = nullptr;
+  if (tls_scheduler == this) {
+    target = static_cast<Worker*>(tls_worker);
+    target->lanes[lane].Push(task);
+  } else {
+    target = workers_[task->home].get();
+    target->injected[lane].Enqueue(task);
+  }
+  target->pending.fetch_add(1, std::memory_order_seq_cst);
+  lane_pending_[lane].fetch_add(1, std::memory_order_seq_cst);
+
+  if (target->sleeping.load(std::memory_order_seq_cst)) {
+    Wake(target);
+    return;
+  }
+  if (!attr_.enable_steal || sleepers_.load(std::memory_order_seq_cst) == 0) {
+    return;
+  }
+  // the target is busy, wake one thief for the new work
+  for (uint32_t victim : target->victims) {
+    Worker* thief = workers_[victim].get();
+    if (thief->sleeping.load(std::memory_order_seq_cst)) {
+      Wake(thief);
+      return;
+    }
+  }
+}
+
+void SchedulerWorkStealing::WorkerFunc(Worker* worker) {
+  tls_scheduler = this;
+  tls_worker = worker;
+  if (worker->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker->cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+      AWARN << "failed to pin work stealing worker " << worker->index
+            << " to cpu " << worker->cpu;
+    }
+  }
+  uint32_t idle_rounds = 0;
+  while (!stop_.load(std::memory_order_relaxed)) {
+    Task* task = nullptr;
+    if (FindTask(worker, &task)) {
+      idle_rounds = 0;
+      Run(worker, task);
+      continue;
+    }
+    if (++idle_rounds < attr_.spin_rounds) {
+      cpu_relax();
+      continue;
+    }
+    idle_rounds = 0;
+    Sleep(worker);
+  }
+  tls_scheduler = nullptr;
+  tls_worker = nullptr;
+}
+
+bool SchedulerWorkStealing::FindTask(Worker* worker, Task** task) {
+  // lane by lane, so a high priority task elsewhere beats a low one here
+  for (uint32_t lane = 0; lane < kWorkStealingLaneNum; ++lane) {
+    if (lane_pending_[lane].load(std::memory_order_relaxed) <= 0) {
+      continue;
+    }
+    if (TakeFrom(worker, lane, true, task)) {
+      return true;
+    }
+    if (!attr_.enable_steal) {
+      continue;
+    }
+    for (uint32_t victim : worker->victims) {
+      if (TakeFrom(workers_[victim].get(), lane, false, task)) {
+        worker->stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool SchedulerWorkStealing::TakeFrom(Worker* owner, uint32_t lane,
+                                     bool local, Task** task) {
+  const bool taken = local ? owner->lanes[lane].Pop(task)
+                           : owner->lanes[lane].Steal(task);
+  if (!taken) {
+    // a worker finding it busy goes on to the next victim, or spins until
+    // pending drops
+    std::unique_lock<std::mutex> lock(owner->inject_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !owner->injected[lane].Dequeue(task)) {
+      return false;
+    }
+  }
+  owner->pending.fetch_sub(1, std::memory_order_relaxed);
+  lane_pending_[lane].fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+void SchedulerWorkStealing::Run(Worker* worker, Task* task) {
+  task->state.store(Task::kRunning, std::memory_order_seq_cst);
+  while (true) {
+    if (task->removed.load(std::memory_order_seq_cst)) {
+      task->state.store(Task::kIdle, std::memory_order_release);
+      return;
+    }
+    tls_task = task;
+    task->func();
+    tls_task = nullptr;
+    worker->executed.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t state = Task::kRunning;
+    if (task->state.compare_exchange_strong(state, Task::kIdle,
+                                            std::memory_order_acq_rel)) {
+      return;
+    }
+    // notified while running
+    if (task->removed.load(std::memory_order_acquire)) {
+      task->state.store(Task::kIdle, std::memory_order_release);
+      return;
+    }
+    if (worker->pending.load(std::memory_order_relaxed) == 0) {
+      // nothing else here, run it again right away
+      task->state.store(Task::kRunning, std::memory_order_release);
+      continue;
+    }
+    // let the other tasks of this worker go first, a thief may take it
+    task->state.store(Task::kQueued, std::memory_order_release);
+    Enqueue(task);
+    return;
+  }
+}
+
+bool SchedulerWorkStealing::HasWork(const Worker* worker) const {
+  if (stop_.load(std::memory_order_relaxed) ||
+      worker->pending.load(std::memory_order_seq_cst) > 0) {
+    return true;
+  }
+  if (!attr_.enable_steal) {
+    return false;
+  }
+  for (const auto& pending : lane_pending_) {
+    if (pending.load(std::memory_order_seq_cst) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SchedulerWorkStealing::Sleep(Worker* worker) {
+  std::unique_lock<std::mutex> lock(worker->mutex);
+  worker->sleeping.store(true, std::memory_order_seq_cst);
+  sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  // Enqueue bumps pending before it reads sleeping, we set sleeping before
+  // we read pending, so one of the two sees the other.
+  if (!HasWork(worker)) {
+    worker->sleeps.fetch_add(1, std::memory_order_relaxed);
+    worker->cv.wait(lock, [this, worker] {
+      return !worker->sleeping.load(std::memory_order_relaxed) ||
+             stop_.load(std::memory_order_relaxed);
+    });
+  }
+  worker->sleeping.store(false, std::memory_order_relaxed);
+  sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void SchedulerWorkStealing::Wake(Worker* worker) {
+  {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->sleeping.store(false, std::memory_order_relaxed);
+  }
+  worker->cv.notify_one();
+}
+
+}  // namespace scheduler
+}  // namespace cyber
+}  // namespace apollo
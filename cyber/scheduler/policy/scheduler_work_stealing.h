@@ -0,0 +1,162 @@
+#ifndef CYBER_SCHEDULER_POLICY_SCHEDULER_WORK_STEALING_H_
+#define CYBER_SCHEDULER_POLICY_SCHEDULER_WORK_STEALING_H_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cyber/base/chase_lev_deque.h"
+#include "cyber/base/macros.h"
+#include "cyber/base/unbounded_queue.h"
+
+namespace apollo {
+namespace cyber {
+namespace scheduler {
+
+// a lower lane always runs first, on every worker
+enum WorkStealingPriority : uint32_t {
+  WS_PRIORITY_HIGH = 0,
+  WS_PRIORITY_NORMAL = 1,
+  WS_PRIORITY_LOW = 2,
+};
+constexpr uint32_t kWorkStealingLaneNum = 3;
+
+struct WorkStealingAttr {
+  uint32_t worker_num = 0;  // 0 is one per hardware thread
+  bool enable_steal = true;
+  // optional, pins worker i to cpus[i]
+  std::vector<int> cpus;
+  // optional NUMA node of worker i, thieves try their own node first; read
+  // from sysfs for pinned workers when empty
+  std::vector<int> numa_nodes;
+  // idle rounds over all victims before a worker sleeps
+  uint32_t spin_rounds = 64;
+};
+
+struct WorkStealingTaskAttr {
+  uint32_t priority = WS_PRIORITY_NORMAL;
+  // worker that gets the task when notified from outside the scheduler,
+  // -1 spreads the tasks round robin
+  int32_t worker = -1;
+};
+
+struct WorkStealingStats {
+  uint64_t executed = 0;
+  uint64_t stolen = 0;
+  uint64_t sleeps = 0;
+};
+
+/**
+ * @class SchedulerWorkStealing
+ * @brief Runs component tasks on a pool of workers that balance themselves,
+ * instead of pinning every task to the processor of its static config.
+ *
+ * Each worker owns one Chase-Lev deque per priority lane. A task notified
+ * from a worker goes to the bottom of that worker's deque, where it is the
+ * next to run and its data is still in cache; a task notified from any
+ * other thread goes to the inject queue of its home worker. An idle worker
+ * steals from the top of the other deques, same NUMA node first.
+ *
+ * Like a croutine a task never runs on two workers at once: notifying a
+ * queued task does nothing, notifying a running one runs it once more when
+ * it returns.
+ */
+class SchedulerWorkStealing {
+ public:
+  explicit SchedulerWorkStealing(const WorkStealingAttr& attr);
+  ~SchedulerWorkStealing();
+  SchedulerWorkStealing(const SchedulerWorkStealing&) = delete;
+  SchedulerWorkStealing& operator=(const SchedulerWorkStealing&) = delete;
+
+  bool CreateTask(const std::function<void()>& func, const std::string& name,
+                  const WorkStealingTaskAttr& attr = WorkStealingTaskAttr());
+  bool NotifyTask(uint64_t task_id);
+  bool NotifyTask(const std::string& name) {
+    return NotifyTask(TaskId(name));
+  }
+  // Waits for a queued or running instance. A queued one is not waited for
+  // from a worker, which may be the only one to take it, or after Shutdown,
+  // the task is dropped when taken. Returns at once from inside the task.
+  bool RemoveTask(const std::string& name);
+  void Shutdown();
+
+  uint32_t WorkerNum() const { return static_cast<uint32_t>(workers_.size()); }
+  std::vector<WorkStealingStats> GetStats() const;
+
+  static uint64_t TaskId(const std::string& name) {
+    return std::hash<std::string>()(name);
+  }
+
+ private:
+  struct Task {
+    enum State : uint32_t { kIdle = 0, kQueued, kRunning, kRunningNotified };
+
+    std::function<void()> func;
+    std::string name;
+    uint32_t priority = WS_PRIORITY_NORMAL;
+    uint32_t home = 0;
+    std::atomic<uint32_t> state{kIdle};
+    std::atomic<bool> removed{false};
+  };
+
+  struct alignas(CACHELINE_SIZE) Worker {
+    uint32_t index = 0;
+    int cpu = -1;
+    int numa_node = 0;
+    // other workers, same NUMA node first
+    std::vector<uint32_t> victims;
+    std::array<base::ChaseLevDeque<Task*>, kWorkStealingLaneNum> lanes;
+    std::array<base::UnboundedQueue<Task*>, kWorkStealingLaneNum> injected;
+    // injected allows one consumer, the owner and the thieves take turns
+    std::mutex inject_mutex;
+    // queued in lanes or injected, for the sleep check without stealing
+    std::atomic<int64_t> pending{0};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> sleeping{false};
+
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+    std::atomic<uint64_t> sleeps{0};
+    std::thread thread;
+  };
+
+  void WorkerFunc(Worker* worker);
+  bool FindTask(Worker* worker, Task** task);
+  bool TakeFrom(Worker* owner, uint32_t lane, bool local, Task** task);
+  void Run(Worker* worker, Task* task);
+  // keeps a removed task alive for the worker that still holds it
+  void Retire(std::shared_ptr<Task> task);
+  void Enqueue(Task* task);
+  void Sleep(Worker* worker);
+  void Wake(Worker* worker);
+  bool HasWork(const Worker* worker) const;
+
+  WorkStealingAttr attr_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::array<std::atomic<int64_t>, kWorkStealingLaneNum> lane_pending_;
+  std::atomic<int32_t> sleepers_{0};
+  std::atomic<bool> stop_{false};
+
+  mutable std::shared_timed_mutex task_mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<Task>> tasks_;
+  // removed while a worker held them, freed once idle or with the scheduler
+  std::vector<std::shared_ptr<Task>> retired_;
+  uint32_t next_home_ = 0;
+};
+
+}  // namespace scheduler
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_SCHEDULER_POLICY_SCHEDULER_WORK_STEALING_H_
@@ -0,0 +1,269 @@
+#include "cyber/service_discovery/change_batch.h"
+
+#include <chrono>
+#include <random>
+#include <unordered_set>
+
+#include "cyber/message/proto_desc_cache.h"
+
+namespace apollo {
+namespace cyber {
+namespace service_discovery {
+
+namespace {
+
+bool IsJoin(const proto::ChangeMsg& change) {
+  return change.operate_type() == proto::OperateType::OPT_JOIN;
+}
+
+bool SameHost(const proto::RoleAttributes& a, const proto::RoleAttributes& b) {
+  return a.host_name() == b.host_name() && a.host_ip() == b.host_ip() &&
+         a.process_id() == b.process_id() && a.node_name() == b.node_name();
+}
+
+}  // namespace
+
+void TopologyMirror::Compress(proto::ChangeMsg* change) const {
+  auto attr = change->mutable_role_attr();
+  if (!IsJoin(*change)) {
+    const uint64_t key = RoleIndex::Key(*attr);
+    if (roles_.Find(key) != nullptr) {
+      attr->Clear();
+      attr->set_id(key);
+    }
+    return;
+  }
+  const auto& node_roles = roles_.KeysOfNode(attr->node_id());
+  if (!node_roles.empty() &&
+      SameHost(*roles_.Find(node_roles.front()), *attr)) {
+    attr->clear_host_name();
+    attr->clear_host_ip();
+    attr->clear_process_id();
+    attr->clear_node_name();
+    change->set_host_omitted(true);
+  }
+  if (attr->has_message_type() && attr->has_proto_desc()) {
+    auto type = types_.find(attr->message_type());
+    if (type != types_.end() && type->second.proto_desc == attr->proto_desc()) {
+      // tells Restore that proto_desc was left out
+      attr->set_proto_desc_hash(type->second.proto_desc_hash);
+      attr->clear_proto_desc();
+    }
+  }
+}
+
+bool TopologyMirror::Restore(proto::ChangeMsg* change) const {
+  auto attr = change->mutable_role_attr();
+  if (!IsJoin(*change)) {
+    if (attr->has_channel_id() || attr->has_node_id()) {
+      // sent in full
+      return true;
+    }
+    auto known = roles_.Find(RoleIndex::Key(*attr));
+    if (known == nullptr) {
+      return false;
+    }
+    *attr = *known;
+    return true;
+  }
+  if (change->host_omitted()) {
+    const auto& node_roles = roles_.KeysOfNode(attr->node_id());
+    if (node_roles.empty()) {
+      return false;
+    }
+    const auto& host = *roles_.Find(node_roles.front());
+    attr->set_host_name(host.host_name());
+    attr->set_host_ip(host.host_ip());
+    attr->set_process_id(host.process_id());
+    attr->set_node_name(host.node_name());
+    change->clear_host_omitted();
+  }
+  if (attr->has_message_type() && !attr->has_proto_desc() &&
+      attr->has_proto_desc_hash()) {
+    auto type = types_.find(attr->message_type());
+    if (type == types_.end() ||
+        type->second.proto_desc_hash != attr->proto_desc_hash()) {
+      return false;
+    }
+    attr->set_proto_desc(type->second.proto_desc);
+  }
+  return true;
+}
+
+bool TopologyMirror::Apply(const proto::ChangeMsg& change) {
+  const auto& attr = change.role_attr();
+  const uint64_t key = RoleIndex::Key(attr);
+  proto::RoleAttributes removed;
+  const bool known = roles_.Remove(key, &removed);
+  kinds_.erase(key);
+  if (known && removed.has_message_type()) {
+    auto type = types_.find(removed.message_type());
+    if (type != types_.end() && --type->second.roles == 0) {
+      types_.erase(type);
+    }
+  }
+  if (!IsJoin(change)) {
+    return known;
+  }
+  roles_.Add(attr);
+  kinds_[key] = {change.change_type(), change.role_type()};
+  if (attr.has_message_type()) {
+    auto& type = types_[attr.message_type()];
+    if (type.roles++ == 0 || attr.has_proto_desc()) {
+      type.proto_desc = attr.proto_desc();
+      type.proto_desc_hash = message::ProtoDescCache::Hash(type.proto_desc);
+    }
+  }
+  return true;
+}
+
+bool TopologyMirror::GetKind(uint64_t key, proto::ChangeMsg* change) const {
+  auto iter = kinds_.find(key);
+  if (iter == kinds_.end()) {
+    return false;
+  }
+  change->set_change_type(iter->second.first);
+  change->set_role_type(iter->second.second);
+  return true;
+}
+
+void TopologyMirror::Clear() {
+  roles_.Clear();
+  kinds_.clear();
+  types_.clear();
+}
+
+ChangeBatchEncoder::ChangeBatchEncoder() {
+  std::random_device device;
+  std::mt19937_64 engine(
+      (static_cast<uint64_t>(device()) << 32) ^ device() ^
+      static_cast<uint64_t>(
+          std::chrono::steady_clock::now().time_since_epoch().count()));
+  while (epoch_ == 0) {
+    epoch_ = engine();
+  }
+}
+
+void ChangeBatchEncoder::Add(const proto::ChangeMsg& change) {
+  pending_.push_back(change);
+}
+
+bool ChangeBatchEncoder::Flush(proto::ChangeMsgBatch* batch) {
+  // the last change of every role wins, in the order of those changes
+  std::unordered_map<uint64_t, size_t> last;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    last[RoleIndex::Key(pending_[i].role_attr())] = i;
+  }
+  batch->Clear();
+  if (!pending_.empty()) {
+    batch->set_timestamp(pending_.back().timestamp());
+  }
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    auto& change = pending_[i];
+    const uint64_t key = RoleIndex::Key(change.role_attr());
+    if (last[key] != i) {
+      continue;
+    }
+    const bool known = sent_.roles().Find(key) != nullptr;
+    if (!IsJoin(change) && !known) {
+      // joined and left within this batch
+      continue;
+    }
+    auto compressed = batch->add_changes();
+    *compressed = change;
+    sent_.Compress(compressed);
+    sent_.Apply(change);
+  }
+  pending_.clear();
+  if (batch->changes_size() == 0) {
+    return false;
+  }
+  batch->set_epoch(epoch_);
+  batch->set_base_version(version_);
+  batch->set_version(++version_);
+  return true;
+}
+
+void ChangeBatchEncoder::Snapshot(proto::ChangeMsgBatch* batch) const {
+  batch->Clear();
+  batch->set_snapshot(true);
+  batch->set_epoch(epoch_);
+  batch->set_base_version(0);
+  batch->set_version(version_);
+  // sent in full, the receiver starts from an empty mirror
+  sent_.roles().ForEach([this, batch](const proto::RoleAttributes& attr) {
+    auto change = batch->add_changes();
+    sent_.GetKind(RoleIndex::Key(attr), change);
+    change->set_operate_type(proto::OperateType::OPT_JOIN);
+    *change->mutable_role_attr() = attr;
+  });
+}
+
+bool ChangeBatchApplier::Apply(const proto::ChangeMsgBatch& batch,
+                               std::vector<proto::ChangeMsg>* changes) {
+  if (batch.epoch() != epoch_) {
+    const bool first = epoch_ == 0;
+    epoch_ = batch.epoch();
+    version_ = 0;
+    // A restarted encoder compresses against its own empty mirror and
+    // does not know what we still hold, only its snapshot resyncs us.
+    // Before the first batch we hold nothing.
+    need_snapshot_ = !first;
+  }
+  if (batch.snapshot()) {
+    if (batch.version() < version_) {
+      // a snapshot sent before the deltas we applied, it would roll them
+      // back
+      return false;
+    }
+    return ApplySnapshot(batch, changes);
+  }
+
+  if (need_snapshot_ || batch.base_version() != version_) {
+    need_snapshot_ = true;
+    return false;
+  }
+  for (const auto& compressed : batch.changes()) {
+    proto::ChangeMsg change = compressed;
+    if (!mirror_.Restore(&change) || !mirror_.Apply(change)) {
+      need_snapshot_ = true;
+      return false;
+    }
+    changes->push_back(std::move(change));
+  }
+  version_ = batch.version();
+  return true;
+}
+
+bool ChangeBatchApplier::ApplySnapshot(const proto::ChangeMsgBatch& batch,
+                                       std::vector<proto::ChangeMsg>* changes) {
+  // the roles it lacks have left
+  std::unordered_set<uint64_t> present;
+  for (const auto& change : batch.changes()) {
+    present.insert(RoleIndex::Key(change.role_attr()));
+  }
+  std::vector<proto::ChangeMsg> leaves;
+  mirror_.roles().ForEach([&](const proto::RoleAttributes& attr) {
+    if (present.count(RoleIndex::Key(attr)) == 0) {
+      proto::ChangeMsg leave;
+      mirror_.GetKind(RoleIndex::Key(attr), &leave);
+      leave.set_operate_type(proto::OperateType::OPT_LEAVE);
+      *leave.mutable_role_attr() = attr;
+      leaves.push_back(std::move(leave));
+    }
+  });
+  mirror_.Clear();
+  changes->insert(changes->end(), leaves.begin(), leaves.end());
+  for (const auto& change : batch.changes()) {
+    // sent in full
+    mirror_.Apply(change);
+    changes->push_back(change);
+  }
+  version_ = batch.version();
+  need_snapshot_ = false;
+  return true;
+}
+
+}  // namespace service_discovery
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,143 @@
+#ifndef CYBER_SERVICE_DISCOVERY_CHANGE_BATCH_H_
+#define CYBER_SERVICE_DISCOVERY_CHANGE_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cyber/proto/topology_change.pb.h"
+
+#include "cyber/service_discovery/role_index.h"
+
+namespace apollo {
+namespace cyber {
+namespace service_discovery {
+
+/**
+ * @class TopologyMirror
+ * @brief The topology one participant announced, as its receivers know it.
+ *
+ * The encoder and every applier keep one and change it in the same order,
+ * so a field the encoder leaves out is restored from the same role on the
+ * receiver side.
+ */
+class TopologyMirror {
+ public:
+  // left out a join's fields the mirror knows, turns a leave into its id;
+  // left out host fields set host_omitted, a left out proto_desc leaves its
+  // proto_desc_hash
+  void Compress(proto::ChangeMsg* change) const;
+  // fills in what Compress left out, false if the mirror does not know
+  // the role, node or message type it refers to
+  bool Restore(proto::ChangeMsg* change) const;
+  // applies a full change, false for the leave of an unknown role
+  bool Apply(const proto::ChangeMsg& change);
+
+  const RoleIndex& roles() const { return roles_; }
+  // change and role type a join of `key` had, false for an unknown role
+  bool GetKind(uint64_t key, proto::ChangeMsg* change) const;
+  void Clear();
+
+ private:
+  struct TypeInfo {
+    uint32_t roles = 0;
+    std::string proto_desc;
+    uint64_t proto_desc_hash = 0;
+  };
+
+  RoleIndex roles_;
+  std::unordered_map<uint64_t, std::pair<proto::ChangeType, proto::RoleType>>
+      kinds_;
+  // message_type of the live roles
+  std::unordered_map<std::string, TypeInfo> types_;
+};
+
+/**
+ * @class ChangeBatchEncoder
+ * @brief Collects the ChangeMsg of one participant and sends them as one
+ * ChangeMsgBatch, a delta against what was sent before.
+ *
+ * Changes that cancel out within a batch, a role that joins and leaves
+ * again, are dropped, and a role that changed several times is sent once.
+ */
+class ChangeBatchEncoder {
+ public:
+  ChangeBatchEncoder();
+
+  void Add(const proto::ChangeMsg& change);
+  size_t PendingSize() const { return pending_.size(); }
+
+  /**
+   * @brief Moves the pending changes into `batch`
+   *
+   * @return false if nothing changed since the last Flush
+   */
+  bool Flush(proto::ChangeMsgBatch* batch);
+
+  /**
+   * @brief The whole topology as joins, for a receiver that joined late or
+   * whose applier reported a gap
+   */
+  void Snapshot(proto::ChangeMsgBatch* batch) const;
+
+  uint64_t version() const { return version_; }
+  uint64_t epoch() const { return epoch_; }
+
+ private:
+  std::vector<proto::ChangeMsg> pending_;
+  TopologyMirror sent_;
+  uint64_t version_ = 0;
+  // random and non zero, a restarted encoder gets another one
+  uint64_t epoch_ = 0;
+};
+
+/**
+ * @class ChangeBatchApplier
+ * @brief Receiving end of one ChangeBatchEncoder: checks the version,
+ * restores the compressed fields and hands back the full changes, which
+ * the listeners apply as one update.
+ */
+class ChangeBatchApplier {
+ public:
+  /**
+   * @brief Applies `batch` and appends its full changes to `changes`
+   *
+   * A snapshot also yields a leave for each known role it does not have.
+   * A batch of another epoch than the applied ones means the encoder
+   * restarted: its versions start over, and its deltas are refused until
+   * its first snapshot.
+   *
+   * @return false if the batch does not follow the applied version,
+   * refers to roles we do not know, comes from a restarted encoder or is a
+   * snapshot older than the applied version. The changes before the bad
+   * one are still applied and appended, later deltas are refused until a
+   * snapshot comes. A stale snapshot is dropped and changes nothing.
+   */
+  bool Apply(const proto::ChangeMsgBatch& batch,
+             std::vector<proto::ChangeMsg>* changes);
+
+  const RoleIndex& roles() const { return mirror_.roles(); }
+  uint64_t version() const { return version_; }
+  uint64_t epoch() const { return epoch_; }
+  // the encoder should send a Snapshot
+  bool need_snapshot() const { return need_snapshot_; }
+
+ private:
+  bool ApplySnapshot(const proto::ChangeMsgBatch& batch,
+                     std::vector<proto::ChangeMsg>* changes);
+
+  TopologyMirror mirror_;
+  uint64_t version_ = 0;
+  // 0 until the first batch
+  uint64_t epoch_ = 0;
+  bool need_snapshot_ = false;
+};
+
+}  // namespace service_discovery
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_SERVICE_DISCOVERY_CHANGE_BATCH_H_
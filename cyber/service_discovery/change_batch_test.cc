@@ -0,0 +1,247 @@
+#include "cyber/service_discovery/change_batch.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace cyber {
+namespace service_discovery {
+
+namespace {
+
+proto::ChangeMsg MakeWriter(uint64_t id, uint64_t node_id, uint64_t channel_id,
+                            bool join, const std::string& type = "Type") {
+  proto::ChangeMsg change;
+  change.set_change_type(proto::CHANGE_CHANNEL);
+  change.set_role_type(proto::ROLE_WRITER);
+  change.set_operate_type(join ? proto::OPT_JOIN : proto::OPT_LEAVE);
+  auto attr = change.mutable_role_attr();
+  attr->set_id(id);
+  attr->set_node_id(node_id);
+  attr->set_node_name("node" + std::to_string(node_id));
+  attr->set_host_name("host");
+  attr->set_host_ip("10.0.0.1");
+  attr->set_process_id(42);
+  attr->set_channel_id(channel_id);
+  attr->set_channel_name("channel" + std::to_string(channel_id));
+  attr->set_message_type(type);
+  attr->set_proto_desc(std::string(1024, 'd') + type);
+  return change;
+}
+
+// a participant join carries no node_name by nature
+proto::ChangeMsg MakeParticipant(uint64_t node_id) {
+  proto::ChangeMsg change;
+  change.set_change_type(proto::CHANGE_PARTICIPANT);
+  change.set_role_type(proto::ROLE_PARTICIPANT);
+  change.set_operate_type(proto::OPT_JOIN);
+  auto attr = change.mutable_role_attr();
+  attr->set_node_id(node_id);
+  attr->set_host_name("host");
+  attr->set_process_id(7);
+  return change;
+}
+
+size_t CountLeaves(const std::vector<proto::ChangeMsg>& changes) {
+  size_t leaves = 0;
+  for (const auto& change : changes) {
+    if (change.operate_type() == proto::OPT_LEAVE) {
+      ++leaves;
+    }
+  }
+  return leaves;
+}
+
+}  // namespace
+
+TEST(ChangeBatchTest, DeltaRestoresCompressedFields) {
+  ChangeBatchEncoder encoder;
+  ChangeBatchApplier applier;
+  for (uint64_t i = 0; i < 20; ++i) {
+    encoder.Add(MakeWriter(i, i / 5, i % 3, true));
+  }
+  proto::ChangeMsgBatch batch;
+  ASSERT_TRUE(encoder.Flush(&batch));
+  EXPECT_FALSE(batch.snapshot());
+  EXPECT_EQ(0, batch.base_version());
+  EXPECT_EQ(1, batch.version());
+  // only the first role of a node and of a type go in full
+  EXPECT_TRUE(batch.changes(1).host_omitted());
+  EXPECT_FALSE(batch.changes(1).role_attr().has_proto_desc());
+  EXPECT_TRUE(batch.changes(1).role_attr().has_proto_desc_hash());
+
+  std::vector<proto::ChangeMsg> changes;
+  ASSERT_TRUE(applier.Apply(batch, &changes));
+  ASSERT_EQ(20, changes.size());
+  for (size_t i = 0; i < changes.size(); ++i) {
+    const auto expected = MakeWriter(i, i / 5, i % 3, true);
+    EXPECT_FALSE(changes[i].host_omitted());
+    EXPECT_EQ(expected.role_attr().node_name(),
+              changes[i].role_attr().node_name());
+    EXPECT_EQ(expected.role_attr().host_ip(), changes[i].role_attr().host_ip());
+    EXPECT_EQ(expected.role_attr().proto_desc(),
+              changes[i].role_attr().proto_desc());
+  }
+  EXPECT_EQ(20, applier.roles().Size());
+  EXPECT_EQ(5, applier.roles().KeysOfNode(1).size());
+
+  // a leave carries the id only and is restored in full
+  encoder.Add(MakeWriter(3, 0, 0, false));
+  ASSERT_TRUE(encoder.Flush(&batch));
+  EXPECT_FALSE(batch.changes(0).role_attr().has_channel_id());
+  changes.clear();
+  ASSERT_TRUE(applier.Apply(batch, &changes));
+  ASSERT_EQ(1, changes.size());
+  EXPECT_EQ(proto::OPT_LEAVE, changes[0].operate_type());
+  EXPECT_EQ("channel0", changes[0].role_attr().channel_name());
+  EXPECT_EQ(19, applier.roles().Size());
+}
+
+TEST(ChangeBatchTest, DropsChangesThatCancelOut) {
+  ChangeBatchEncoder encoder;
+  encoder.Add(MakeWriter(1, 0, 0, true));
+  encoder.Add(MakeWriter(2, 0, 0, true));
+  encoder.Add(MakeWriter(2, 0, 0, false));
+  proto::ChangeMsgBatch batch;
+  ASSERT_TRUE(encoder.Flush(&batch));
+  ASSERT_EQ(1, batch.changes_size());
+  EXPECT_EQ(1, batch.changes(0).role_attr().id());
+  EXPECT_FALSE(encoder.Flush(&batch));
+}
+
+TEST(ChangeBatchTest, JoinWithoutNodeNameOfUnknownNode) {
+  ChangeBatchEncoder encoder;
+  ChangeBatchApplier applier;
+  encoder.Add(MakeParticipant(9));
+  proto::ChangeMsgBatch batch;
+  ASSERT_TRUE(encoder.Flush(&batch));
+  std::vector<proto::ChangeMsg> changes;
+  ASSERT_TRUE(applier.Apply(batch, &changes));
+  EXPECT_FALSE(applier.need_snapshot());
+  ASSERT_EQ(1, changes.size());
+  EXPECT_FALSE(changes[0].role_attr().has_node_name());
+}
+
+TEST(ChangeBatchTest, RestoreNeedsTheOmittedNodeAndType) {
+  TopologyMirror sender;
+  sender.Apply(MakeWriter(1, 0, 0, true));
+  auto change = MakeWriter(2, 0, 1, true);
+  sender.Compress(&change);
+  ASSERT_TRUE(change.host_omitted());
+
+  TopologyMirror empty;
+  auto copy = change;
+  EXPECT_FALSE(empty.Restore(&copy));
+
+  // knows the node but not the type
+  TopologyMirror other_type;
+  other_type.Apply(MakeWriter(5, 0, 0, true, "Other"));
+  copy = change;
+  EXPECT_FALSE(other_type.Restore(&copy));
+
+  copy = change;
+  ASSERT_TRUE(sender.Restore(&copy));
+  EXPECT_EQ("node0", copy.role_attr().node_name());
+  EXPECT_EQ(MakeWriter(2, 0, 1, true).role_attr().proto_desc(),
+            copy.role_attr().proto_desc());
+}
+
+TEST(ChangeBatchTest, GapIsResyncedBySnapshot) {
+  ChangeBatchEncoder encoder;
+  ChangeBatchApplier applier;
+  for (uint64_t i = 0; i < 4; ++i) {
+    encoder.Add(MakeWriter(i, 0, i, true));
+  }
+  proto::ChangeMsgBatch batch;
+  std::vector<proto::ChangeMsg> changes;
+  ASSERT_TRUE(encoder.Flush(&batch));
+  ASSERT_TRUE(applier.Apply(batch, &changes));
+
+  // lost on the way
+  encoder.Add(MakeWriter(0, 0, 0, false));
+  proto::ChangeMsgBatch lost;
+  ASSERT_TRUE(encoder.Flush(&lost));
+  encoder.Add(MakeWriter(1, 0, 1, false));
+  ASSERT_TRUE(encoder.Flush(&batch));
+  changes.clear();
+  EXPECT_FALSE(applier.Apply(batch, &changes));
+  EXPECT_TRUE(applier.need_snapshot());
+
+  // later deltas wait for the snapshot
+  encoder.Add(MakeWriter(2, 0, 2, false));
+  ASSERT_TRUE(encoder.Flush(&batch));
+  EXPECT_FALSE(applier.Apply(batch, &changes));
+
+  proto::ChangeMsgBatch snapshot;
+  encoder.Snapshot(&snapshot);
+  EXPECT_TRUE(snapshot.snapshot());
+  changes.clear();
+  ASSERT_TRUE(applier.Apply(snapshot, &changes));
+  EXPECT_FALSE(applier.need_snapshot());
+  EXPECT_EQ(3, CountLeaves(changes));
+  EXPECT_EQ(1, applier.roles().Size());
+  EXPECT_EQ(encoder.version(), applier.version());
+
+  encoder.Add(MakeWriter(5, 0, 5, true));
+  ASSERT_TRUE(encoder.Flush(&batch));
+  changes.clear();
+  EXPECT_TRUE(applier.Apply(batch, &changes));
+}
+
+TEST(ChangeBatchTest, DropsStaleSnapshot) {
+  ChangeBatchEncoder encoder;
+  ChangeBatchApplier applier;
+  encoder.Add(MakeWriter(1, 0, 0, true));
+  proto::ChangeMsgBatch batch;
+  std::vector<proto::ChangeMsg> changes;
+  ASSERT_TRUE(encoder.Flush(&batch));
+  ASSERT_TRUE(applier.Apply(batch, &changes));
+  proto::ChangeMsgBatch old_snapshot;
+  encoder.Snapshot(&old_snapshot);
+
+  encoder.Add(MakeWriter(2, 0, 0, true));
+  ASSERT_TRUE(encoder.Flush(&batch));
+  ASSERT_TRUE(applier.Apply(batch, &changes));
+  changes.clear();
+  EXPECT_FALSE(applier.Apply(old_snapshot, &changes));
+  EXPECT_TRUE(changes.empty());
+  EXPECT_EQ(2, applier.roles().Size());
+  EXPECT_FALSE(applier.need_snapshot());
+}
+
+TEST(ChangeBatchTest, RestartedEncoderResyncs) {
+  ChangeBatchApplier applier;
+  proto::ChangeMsgBatch batch;
+  std::vector<proto::ChangeMsg> changes;
+  {
+    ChangeBatchEncoder encoder;
+    for (uint64_t i = 0; i < 3; ++i) {
+      encoder.Add(MakeWriter(i, 0, i, true));
+      ASSERT_TRUE(encoder.Flush(&batch));
+      ASSERT_TRUE(applier.Apply(batch, &changes));
+    }
+  }
+  ChangeBatchEncoder restarted;
+  restarted.Add(MakeWriter(0, 0, 0, true));
+  ASSERT_TRUE(restarted.Flush(&batch));
+  ASSERT_NE(applier.epoch(), batch.epoch());
+  changes.clear();
+  EXPECT_FALSE(applier.Apply(batch, &changes));
+  EXPECT_TRUE(applier.need_snapshot());
+
+  // version 1 of the new epoch, older than what the old epoch reached
+  proto::ChangeMsgBatch snapshot;
+  restarted.Snapshot(&snapshot);
+  changes.clear();
+  ASSERT_TRUE(applier.Apply(snapshot, &changes));
+  EXPECT_EQ(restarted.epoch(), applier.epoch());
+  EXPECT_EQ(2, CountLeaves(changes));
+  EXPECT_EQ(1, applier.roles().Size());
+  EXPECT_FALSE(applier.need_snapshot());
+}
+
+}  // namespace service_discovery
+}  // namespace cyber
+}  // namespace apollo
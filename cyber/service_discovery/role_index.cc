@@ -0,0 +1,94 @@
+#include "cyber/service_discovery/role_index.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace apollo {
+namespace cyber {
+namespace service_discovery {
+
+namespace {
+const RoleIndex::IdList kEmptyList;
+}  // namespace
+
+bool RoleIndex::Add(const proto::RoleAttributes& attr) {
+  const uint64_t key = Key(attr);
+  auto iter = roles_.find(key);
+  if (iter != roles_.end()) {
+    const bool moved = iter->second.channel_id() != attr.channel_id() ||
+                       iter->second.node_id() != attr.node_id();
+    if (moved) {
+      Unlink(&by_channel_, iter->second.channel_id(), key);
+      Unlink(&by_node_, iter->second.node_id(), key);
+      Link(&by_channel_, attr.channel_id(), key);
+      Link(&by_node_, attr.node_id(), key);
+    }
+    iter->second = attr;
+    return false;
+  }
+  roles_.emplace(key, attr);
+  Link(&by_channel_, attr.channel_id(), key);
+  Link(&by_node_, attr.node_id(), key);
+  return true;
+}
+
+bool RoleIndex::Remove(uint64_t key, proto::RoleAttributes* removed) {
+  auto iter = roles_.find(key);
+  if (iter == roles_.end()) {
+    return false;
+  }
+  Unlink(&by_channel_, iter->second.channel_id(), key);
+  Unlink(&by_node_, iter->second.node_id(), key);
+  if (removed != nullptr) {
+    *removed = std::move(iter->second);
+  }
+  roles_.erase(iter);
+  return true;
+}
+
+const proto::RoleAttributes* RoleIndex::Find(uint64_t key) const {
+  auto iter = roles_.find(key);
+  return iter == roles_.end() ? nullptr : &iter->second;
+}
+
+const RoleIndex::IdList& RoleIndex::KeysOfChannel(uint64_t channel_id) const {
+  auto iter = by_channel_.find(channel_id);
+  return iter == by_channel_.end() ? kEmptyList : iter->second;
+}
+
+const RoleIndex::IdList& RoleIndex::KeysOfNode(uint64_t node_id) const {
+  auto iter = by_node_.find(node_id);
+  return iter == by_node_.end() ? kEmptyList : iter->second;
+}
+
+void RoleIndex::Clear() {
+  roles_.clear();
+  by_channel_.clear();
+  by_node_.clear();
+}
+
+void RoleIndex::Link(std::unordered_map<uint64_t, IdList>* lists,
+                     uint64_t list, uint64_t key) {
+  (*lists)[list].push_back(key);
+}
+
+void RoleIndex::Unlink(std::unordered_map<uint64_t, IdList>* lists,
+                       uint64_t list, uint64_t key) {
+  auto iter = lists->find(list);
+  if (iter == lists->end()) {
+    return;
+  }
+  auto& keys = iter->second;
+  auto pos = std::find(keys.begin(), keys.end(), key);
+  if (pos != keys.end()) {
+    *pos = keys.back();
+    keys.pop_back();
+  }
+  if (keys.empty()) {
+    lists->erase(iter);
+  }
+}
+
+}  // namespace service_discovery
+}  // namespace cyber
+}  // namespace apollo
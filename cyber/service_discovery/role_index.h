@@ -0,0 +1,67 @@
+#ifndef CYBER_SERVICE_DISCOVERY_ROLE_INDEX_H_
+#define CYBER_SERVICE_DISCOVERY_ROLE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "cyber/proto/role_attributes.pb.h"
+
+namespace apollo {
+namespace cyber {
+namespace service_discovery {
+
+/**
+ * @class RoleIndex
+ * @brief RoleAttributes by role id, with the ids of every channel and every
+ * node, so the roles a change touches are found in O(1).
+ *
+ * A role is keyed by RoleAttributes::id, or node_id for the nodes, which
+ * carry no id.
+ */
+class RoleIndex {
+ public:
+  using IdList = std::vector<uint64_t>;
+
+  static uint64_t Key(const proto::RoleAttributes& attr) {
+    return attr.has_id() ? attr.id() : attr.node_id();
+  }
+
+  // adds or replaces the role, false if it was there with the same key
+  bool Add(const proto::RoleAttributes& attr);
+  // false if there was no such role, else the removed one is moved to
+  // `removed` if given
+  bool Remove(uint64_t key, proto::RoleAttributes* removed = nullptr);
+
+  const proto::RoleAttributes* Find(uint64_t key) const;
+  const IdList& KeysOfChannel(uint64_t channel_id) const;
+  const IdList& KeysOfNode(uint64_t node_id) const;
+
+  template <typename Func>
+  void ForEach(Func&& func) const {
+    for (const auto& item : roles_) {
+      func(item.second);
+    }
+  }
+
+  size_t Size() const { return roles_.size(); }
+  bool Empty() const { return roles_.empty(); }
+  void Clear();
+
+ private:
+  static void Link(std::unordered_map<uint64_t, IdList>* lists, uint64_t list,
+                   uint64_t key);
+  static void Unlink(std::unordered_map<uint64_t, IdList>* lists,
+                     uint64_t list, uint64_t key);
+
+  std::unordered_map<uint64_t, proto::RoleAttributes> roles_;
+  std::unordered_map<uint64_t, IdList> by_channel_;
+  std::unordered_map<uint64_t, IdList> by_node_;
+};
+
+}  // namespace service_discovery
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_SERVICE_DISCOVERY_ROLE_INDEX_H_
@@ -0,0 +1,41 @@
+#include "cyber/transport/common/endpoint.h"
+
+#include <cstring>
+
+#include "cyber/common/global_data.h"
+#include "cyber/common/util.h"
+#include "cyber/message/proto_desc_cache.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+Endpoint::Endpoint(const RoleAttributes& attr)
+    : enabled_(false), id_(), attr_(attr) {
+  if (!attr_.has_host_name()) {
+    attr_.set_host_name(common::GlobalData::Instance()->HostName());
+  }
+
+  if (!attr_.has_process_id()) {
+    attr_.set_process_id(common::GlobalData::Instance()->ProcessId());
+  }
+
+  if (!attr_.has_id()) {
+    attr_.set_id(id_.HashValue());
+  }
+
+  message::ProtoDescCache::Instance()->Dedup(&attr_);
+
+  std::memcpy(identity_.id, id_.data(), ID_SIZE);
+  identity_.process_id = attr_.process_id();
+  identity_.host_id = common::Hash(attr_.host_name());
+  identity_.node_id = attr_.node_id();
+  identity_.channel_id = attr_.channel_id();
+  identity_.proto_desc_hash = attr_.proto_desc_hash();
+}
+
+Endpoint::~Endpoint() {}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
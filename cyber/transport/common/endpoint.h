@@ -1,6 +1,7 @@
 #ifndef CYBER_TRANSPORT_COMMON_ENDPOINT_H_
 #define CYBER_TRANSPORT_COMMON_ENDPOINT_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -16,20 +17,39 @@ class Endpoint;
 using EndpointPtr = std::shared_ptr<Endpoint>;
 using proto::RoleAttributes;
 
+/**
+ * @brief Fixed size identity of an endpoint. Matching an endpoint to a
+ * peer or a channel compares these instead of the RoleAttributes strings.
+ */
+struct EndpointIdentity {
+  char id[ID_SIZE];
+  int32_t process_id;
+  uint64_t host_id;  // hash value of host_name
+  uint64_t node_id;
+  uint64_t channel_id;
+  uint64_t proto_desc_hash;
+};
+
 class Endpoint {
  public:
   explicit Endpoint(const RoleAttributes& attr);
   virtual ~Endpoint();
 
   const Identity& id() const { return id_; }
+  const EndpointIdentity& identity() const { return identity_; }
+  // proto_desc is kept once per process in message::ProtoDescCache, the
+  // attributes only carry proto_desc_hash
   const RoleAttributes& attributes() const { return attr_; }
 
  protected:
   bool enabled_;
   Identity id_;
-  RoleAttributes attr_; 
+  EndpointIdentity identity_;
+  RoleAttributes attr_;
 };
 
-}
-}
-}
\ No newline at end of file
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TRANSPORT_COMMON_ENDPOINT_H_
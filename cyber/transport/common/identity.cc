@@ -0,0 +1,21 @@
+#include "cyber/transport/common/identity.h"
+
+#include <uuid/uuid.h>
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+Identity::Identity(bool need_generate) {
+  if (need_generate) {
+    uuid_t uuid;
+    uuid_generate(uuid);
+    std::memcpy(&value_, uuid, ID_SIZE);
+  }
+}
+
+std::string Identity::ToString() const { return std::to_string(HashValue()); }
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
@@ -1,8 +1,10 @@
 #ifndef CYBER_TRANSPORT_COMMON_IDENTITY_H_
 #define CYBER_TRANSPORT_COMMON_IDENTITY_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <string>
 
 namespace apollo {
@@ -10,6 +12,74 @@ namespace cyber {
 namespace transport {
 
 constexpr uint8_t ID_SIZE = 8;
-}
-}
-}
\ No newline at end of file
+
+/**
+ * @class Identity
+ * @brief ID_SIZE random bytes that tell one endpoint apart from all others.
+ *
+ * The bytes are kept as one aligned uint64_t, so comparing two identities
+ * is one integer compare and hashing is a few multiplies, no string is
+ * built. An identity that was not generated has the value 0.
+ */
+class Identity {
+  static_assert(ID_SIZE == sizeof(uint64_t), "Identity is one uint64_t");
+
+ public:
+  explicit Identity(bool need_generate = true);
+
+  static constexpr Identity FromValue(uint64_t value) {
+    return Identity(value, ValueTag());
+  }
+
+  constexpr bool operator==(const Identity& another) const {
+    return value_ == another.value_;
+  }
+  constexpr bool operator!=(const Identity& another) const {
+    return value_ != another.value_;
+  }
+
+  std::string ToString() const;
+  constexpr size_t Length() const { return ID_SIZE; }
+  constexpr uint64_t Value() const { return value_; }
+  // a mix of all bits, uniform enough to index a power of two table
+  constexpr uint64_t HashValue() const { return Mix(value_); }
+
+  const char* data() const { return reinterpret_cast<const char*>(&value_); }
+  void set_data(const char* data) {
+    if (data == nullptr) {
+      return;
+    }
+    std::memcpy(&value_, data, ID_SIZE);
+  }
+
+  // the splitmix64 finalizer
+  static constexpr uint64_t Mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+  }
+
+ private:
+  struct ValueTag {};
+  constexpr Identity(uint64_t value, ValueTag) : value_(value) {}
+
+  alignas(uint64_t) uint64_t value_ = 0;
+};
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+namespace std {
+template <>
+struct hash<apollo::cyber::transport::Identity> {
+  size_t operator()(const apollo::cyber::transport::Identity& id) const {
+    return static_cast<size_t>(id.HashValue());
+  }
+};
+}  // namespace std
+
+#endif  // CYBER_TRANSPORT_COMMON_IDENTITY_H_
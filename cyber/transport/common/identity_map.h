@@ -0,0 +1,193 @@
+#ifndef CYBER_TRANSPORT_COMMON_IDENTITY_MAP_H_
+#define CYBER_TRANSPORT_COMMON_IDENTITY_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "cyber/transport/common/identity.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+/**
+ * @class IdentityMap
+ * @brief Flat open addressing table from Identity to V, for the endpoint
+ * indexed tables of the receivers and dispatchers.
+ *
+ * Keys and values sit in one array probed linearly from Identity::HashValue,
+ * a lookup usually touches one cache line. Erase shifts the following
+ * entries back, so there are no tombstones. The value 0, an identity that
+ * was not generated, marks a free slot and is kept aside. Pointers to values
+ * are invalidated by Insert and Erase.
+ */
+template <typename V>
+class IdentityMap {
+ public:
+  explicit IdentityMap(size_t capacity = 16) { Rehash(capacity); }
+
+  V* Find(const Identity& id) {
+    return const_cast<V*>(static_cast<const IdentityMap*>(this)->Find(id));
+  }
+  const V* Find(const Identity& id) const;
+  bool Contains(const Identity& id) const { return Find(id) != nullptr; }
+
+  // no overwrite, the bool is false if `id` was there
+  std::pair<V*, bool> Insert(const Identity& id, V value);
+  V& operator[](const Identity& id) {
+    return *Insert(id, V()).first;
+  }
+  bool Erase(const Identity& id);
+
+  size_t Size() const { return size_ + (has_zero_ ? 1 : 0); }
+  bool Empty() const { return Size() == 0; }
+  void Clear();
+
+  template <typename Func>
+  void ForEach(Func&& func) const {
+    if (has_zero_) {
+      func(Identity::FromValue(0), zero_value_);
+    }
+    for (const auto& slot : slots_) {
+      if (slot.key != 0) {
+        func(Identity::FromValue(slot.key), slot.value);
+      }
+    }
+  }
+
+ private:
+  struct Slot {
+    uint64_t key = 0;
+    V value = V();
+  };
+
+  size_t IndexOf(uint64_t key) const {
+    return static_cast<size_t>(Identity::Mix(key)) & mask_;
+  }
+  void Rehash(size_t capacity);
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+  size_t size_ = 0;
+  bool has_zero_ = false;
+  V zero_value_ = V();
+};
+
+template <typename V>
+const V* IdentityMap<V>::Find(const Identity& id) const {
+  const uint64_t key = id.Value();
+  if (key == 0) {
+    return has_zero_ ? &zero_value_ : nullptr;
+  }
+  for (size_t index = IndexOf(key);; index = (index + 1) & mask_) {
+    const Slot& slot = slots_[index];
+    if (slot.key == key) {
+      return &slot.value;
+    }
+    if (slot.key == 0) {
+      return nullptr;
+    }
+  }
+}
+
+template <typename V>
+std::pair<V*, bool> IdentityMap<V>::Insert(const Identity& id, V value) {
+  const uint64_t key = id.Value();
+  if (key == 0) {
+    if (has_zero_) {
+      return {&zero_value_, false};
+    }
+    has_zero_ = true;
+    zero_value_ = std::move(value);
+    return {&zero_value_, true};
+  }
+  // at most half full, so every probe ends at a free slot
+  if ((size_ + 1) * 2 > slots_.size()) {
+    Rehash(slots_.size() * 2);
+  }
+  for (size_t index = IndexOf(key);; index = (index + 1) & mask_) {
+    Slot& slot = slots_[index];
+    if (slot.key == key) {
+      return {&slot.value, false};
+    }
+    if (slot.key == 0) {
+      slot.key = key;
+      slot.value = std::move(value);
+      ++size_;
+      return {&slot.value, true};
+    }
+  }
+}
+
+template <typename V>
+bool IdentityMap<V>::Erase(const Identity& id) {
+  const uint64_t key = id.Value();
+  if (key == 0) {
+    const bool erased = has_zero_;
+    has_zero_ = false;
+    zero_value_ = V();
+    return erased;
+  }
+  size_t hole = IndexOf(key);
+  while (slots_[hole].key != key) {
+    if (slots_[hole].key == 0) {
+      return false;
+    }
+    hole = (hole + 1) & mask_;
+  }
+  // move back every following entry whose home is not between the hole and
+  // itself, until a free slot ends the run
+  for (size_t next = (hole + 1) & mask_; slots_[next].key != 0;
+       next = (next + 1) & mask_) {
+    const size_t home = IndexOf(slots_[next].key);
+    const bool stays = hole <= next ? (hole < home && home <= next)
+                                    : (hole < home || home <= next);
+    if (!stays) {
+      slots_[hole] = std::move(slots_[next]);
+      hole = next;
+    }
+  }
+  slots_[hole].key = 0;
+  slots_[hole].value = V();
+  --size_;
+  return true;
+}
+
+template <typename V>
+void IdentityMap<V>::Clear() {
+  for (auto& slot : slots_) {
+    slot = Slot();
+  }
+  size_ = 0;
+  has_zero_ = false;
+  zero_value_ = V();
+}
+
+template <typename V>
+void IdentityMap<V>::Rehash(size_t capacity) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  std::vector<Slot> old(size);
+  old.swap(slots_);
+  mask_ = size - 1;
+  for (auto& slot : old) {
+    if (slot.key == 0) {
+      continue;
+    }
+    size_t index = IndexOf(slot.key);
+    while (slots_[index].key != 0) {
+      index = (index + 1) & mask_;
+    }
+    slots_[index] = std::move(slot);
+  }
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TRANSPORT_COMMON_IDENTITY_MAP_H_
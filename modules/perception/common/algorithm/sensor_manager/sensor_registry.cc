@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Copyright 2018 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+#include "modules/perception/common/algorithm/sensor_manager/sensor_registry.h"
+
+#include "cyber/common/log.h"
+#include "modules/perception/common/algorithm/sensor_manager/sensor_manager.h"
+
+namespace apollo {
+namespace perception {
+namespace algorithm {
+
+using base::SensorId;
+using base::SensorInfo;
+using base::SensorType;
+
+SensorRegistry::SensorRegistry() {}
+
+SensorId SensorRegistry::Register(const SensorInfo& sensor_info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t size = size_.load(std::memory_order_relaxed);
+  const SensorId id = Find(sensor_info.name, size);
+  if (id != base::kInvalidSensorId) {
+    return id;
+  }
+  if (size >= kMaxSensorNum) {
+    AERROR << "Sensor registry is full, failed to register "
+           << sensor_info.name;
+    return base::kInvalidSensorId;
+  }
+  sensor_infos_[size] = sensor_info;
+  size_.store(size + 1, std::memory_order_release);
+  AINFO << "Register sensor " << sensor_info.name << " as id " << size;
+  return static_cast<SensorId>(size);
+}
+
+SensorId SensorRegistry::Register(const std::string& name) {
+  SensorInfo sensor_info;
+  if (!SensorManager::Instance()->GetSensorInfo(name, &sensor_info)) {
+    AERROR << "Failed to get sensor info, sensor name: " << name;
+    return base::kInvalidSensorId;
+  }
+  return Register(sensor_info);
+}
+
+bool SensorRegistry::IsLidar(SensorId id) const {
+  const SensorType type = GetSensorType(id);
+  return type == SensorType::VELODYNE_128 || type == SensorType::VELODYNE_64 ||
+         type == SensorType::VELODYNE_32 || type == SensorType::VELODYNE_16 ||
+         type == SensorType::LDLIDAR_4 || type == SensorType::LDLIDAR_1;
+}
+
+bool SensorRegistry::IsRadar(SensorId id) const {
+  const SensorType type = GetSensorType(id);
+  return type == SensorType::SHORT_RANGE_RADAR ||
+         type == SensorType::LONG_RANGE_RADAR;
+}
+
+bool SensorRegistry::IsCamera(SensorId id) const {
+  const SensorType type = GetSensorType(id);
+  return type == SensorType::MONOCULAR_CAMERA ||
+         type == SensorType::STEREO_CAMERA;
+}
+
+SensorId SensorRegistry::GetSensorId(const std::string& name) const {
+  return Find(name, Size());
+}
+
+bool SensorRegistry::GetSensorInfo(const std::string& name,
+                                   SensorInfo* sensor_info) const {
+  if (sensor_info == nullptr) {
+    AERROR << "Nullptr error.";
+    return false;
+  }
+  const SensorInfo* info = GetSensorInfo(GetSensorId(name));
+  if (info == nullptr) {
+    return false;
+  }
+  *sensor_info = *info;
+  return true;
+}
+
+const std::string& SensorRegistry::GetSensorName(SensorId id) const {
+  static const std::string kEmptyName;
+  return IsValid(id) ? sensor_infos_[id].name : kEmptyName;
+}
+
+// only reads entries below size, which are immutable, so it is also safe
+// without mutex_ for a size loaded with acquire
+SensorId SensorRegistry::Find(const std::string& name, size_t size) const {
+  for (size_t i = 0; i < size; ++i) {
+    if (sensor_infos_[i].name == name) {
+      return static_cast<SensorId>(i);
+    }
+  }
+  return base::kInvalidSensorId;
+}
+
+}  // namespace algorithm
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * Copyright 2018 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "cyber/common/macros.h"
+#include "modules/perception/common/base/sensor_meta.h"
+
+namespace apollo {
+namespace perception {
+namespace algorithm {
+
+/**
+ * @class SensorRegistry
+ * @brief Interns sensors to dense integer ids and keeps their SensorInfo in
+ *        one contiguous table
+ *
+ * Sensors are registered once at startup, an entry is never modified or
+ * removed afterwards. Per frame code passes base::SensorId around and reads
+ * the table by index without locking, the string keyed methods are adapters
+ * for configuration and logging.
+ */
+class SensorRegistry {
+ public:
+  static constexpr size_t kMaxSensorNum = 64;
+
+  /**
+   * @brief Register a sensor, a name registered before keeps its id
+   * @return the id, kInvalidSensorId if the table is full
+   */
+  base::SensorId Register(const base::SensorInfo& sensor_info);
+
+  /**
+   * @brief Register a sensor by name, the info comes from SensorManager
+   */
+  base::SensorId Register(const std::string& name);
+
+  size_t Size() const { return size_.load(std::memory_order_acquire); }
+  bool IsValid(base::SensorId id) const { return id < Size(); }
+
+  // nullptr for an unknown id
+  const base::SensorInfo* GetSensorInfo(base::SensorId id) const {
+    return IsValid(id) ? &sensor_infos_[id] : nullptr;
+  }
+  base::SensorType GetSensorType(base::SensorId id) const {
+    return IsValid(id) ? sensor_infos_[id].type
+                       : base::SensorType::UNKNOWN_SENSOR_TYPE;
+  }
+  bool IsLidar(base::SensorId id) const;
+  bool IsRadar(base::SensorId id) const;
+  bool IsCamera(base::SensorId id) const;
+  bool IsMainSensor(base::SensorId id) const {
+    return IsValid(id) && sensor_infos_[id].is_main_sensor;
+  }
+
+  // string keyed adapters
+  base::SensorId GetSensorId(const std::string& name) const;
+  bool GetSensorInfo(const std::string& name,
+                     base::SensorInfo* sensor_info) const;
+  // empty string for an unknown id
+  const std::string& GetSensorName(base::SensorId id) const;
+
+ private:
+  base::SensorId Find(const std::string& name, size_t size) const;
+
+  std::array<base::SensorInfo, kMaxSensorNum> sensor_infos_;
+  // entries below size_ are immutable, the release store publishes them
+  std::atomic<size_t> size_{0};
+  // serializes Register
+  std::mutex mutex_;
+
+  // callers keep the ids and SensorInfo pointers, so it is never reset
+  DECLARE_SINGLETON_NO_RESET(SensorRegistry)
+};
+
+}  // namespace algorithm
+}  // namespace perception
+}  // namespace apollo
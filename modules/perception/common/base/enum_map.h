@@ -0,0 +1,224 @@
+/******************************************************************************
+ * Copyright 2018 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+#pragma once
+
+// string_view and the constexpr std::array accessors need C++17
+#if __cplusplus < 201703L
+#error "enum_map.h requires C++17"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace apollo {
+namespace perception {
+namespace base {
+
+// enum values used as keys of EnumMap must be smaller than this
+constexpr size_t kMaxEnumMapIndex = 32;
+
+// sorts entries by key, std::swap and std::sort are not constexpr in C++17
+template <typename Entry, size_t N, typename Less>
+constexpr void SortEntries(std::array<Entry, N>* entries, Less less) {
+  for (size_t i = 1; i < N; ++i) {
+    for (size_t j = i; j > 0 && less((*entries)[j], (*entries)[j - 1]); --j) {
+      const Entry tmp = (*entries)[j];
+      (*entries)[j].first = (*entries)[j - 1].first;
+      (*entries)[j].second = (*entries)[j - 1].second;
+      (*entries)[j - 1].first = tmp.first;
+      (*entries)[j - 1].second = tmp.second;
+    }
+  }
+}
+
+/**
+ * @brief Read only map from an enum to a value, built at compile time.
+ *
+ * Lookups index an array by the enum value, so they are O(1) and there is
+ * no static initialization. at/find/count/begin/end behave like std::map,
+ * iteration is in key order.
+ */
+template <typename Enum, typename Value, size_t N>
+class EnumMap {
+ public:
+  using key_type = Enum;
+  using mapped_type = Value;
+  using value_type = std::pair<Enum, Value>;
+  using const_iterator = const value_type*;
+
+  constexpr explicit EnumMap(const value_type (&entries)[N])
+      : entries_(), index_() {
+    for (size_t i = 0; i < N; ++i) {
+      // std::pair assignment is not constexpr before C++20
+      entries_[i].first = entries[i].first;
+      entries_[i].second = entries[i].second;
+    }
+    SortEntries(&entries_, [](const value_type& a, const value_type& b) {
+      return a.first < b.first;
+    });
+    for (size_t i = 0; i < kMaxEnumMapIndex; ++i) {
+      index_[i] = N;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      const size_t key = static_cast<size_t>(entries_[i].first);
+      if (key >= kMaxEnumMapIndex) {
+        throw std::out_of_range("enum value exceeds kMaxEnumMapIndex");
+      }
+      index_[key] = i;
+    }
+  }
+
+  constexpr const_iterator begin() const { return entries_.data(); }
+  constexpr const_iterator end() const { return entries_.data() + N; }
+  constexpr size_t size() const { return N; }
+
+  constexpr const_iterator find(Enum key) const {
+    const size_t k = static_cast<size_t>(key);
+    return k < kMaxEnumMapIndex && index_[k] < N ? begin() + index_[k]
+                                                 : end();
+  }
+  constexpr size_t count(Enum key) const { return find(key) != end(); }
+  constexpr const Value& at(Enum key) const {
+    const_iterator iter = find(key);
+    if (iter == end()) {
+      throw std::out_of_range("EnumMap::at");
+    }
+    return iter->second;
+  }
+
+ private:
+  std::array<value_type, N> entries_;
+  std::array<size_t, kMaxEnumMapIndex> index_;
+};
+
+/**
+ * @brief Read only map from a name to an enum, built at compile time.
+ *
+ * Names are placed with a perfect hash whose seed is searched by the
+ * compiler, a lookup hashes the name once and compares one string.
+ * Iteration is in name order, like std::map<std::string, Enum>.
+ */
+template <typename Enum, size_t N>
+class NameMap {
+ public:
+  using key_type = std::string_view;
+  using mapped_type = Enum;
+  using value_type = std::pair<std::string_view, Enum>;
+  using const_iterator = const value_type*;
+
+  constexpr explicit NameMap(const value_type (&entries)[N])
+      : entries_(), slots_(), seed_(0) {
+    for (size_t i = 0; i < N; ++i) {
+      entries_[i].first = entries[i].first;
+      entries_[i].second = entries[i].second;
+    }
+    SortEntries(&entries_, [](const value_type& a, const value_type& b) {
+      return a.first < b.first;
+    });
+    for (uint32_t seed = 1;; ++seed) {
+      if (seed > kMaxSeed) {
+        throw std::logic_error("no perfect hash seed for NameMap");
+      }
+      if (TryPlace(seed)) {
+        seed_ = seed;
+        break;
+      }
+    }
+  }
+
+  constexpr const_iterator begin() const { return entries_.data(); }
+  constexpr const_iterator end() const { return entries_.data() + N; }
+  constexpr size_t size() const { return N; }
+
+  constexpr const_iterator find(std::string_view name) const {
+    const size_t slot = slots_[Hash(name, seed_) & (kSlotSize - 1)];
+    return slot < N && entries_[slot].first == name ? begin() + slot : end();
+  }
+  constexpr size_t count(std::string_view name) const {
+    return find(name) != end();
+  }
+  constexpr const Enum& at(std::string_view name) const {
+    const_iterator iter = find(name);
+    if (iter == end()) {
+      throw std::out_of_range("NameMap::at");
+    }
+    return iter->second;
+  }
+
+ private:
+  static constexpr size_t SlotSize() {
+    size_t size = 1;
+    while (size < 4 * N) {
+      size <<= 1;
+    }
+    return size;
+  }
+  static constexpr size_t kSlotSize = SlotSize();
+  static constexpr uint32_t kMaxSeed = 1 << 12;
+
+  // FNV-1a followed by the murmur3 finalizer, the low bits pick the slot
+  static constexpr uint32_t Hash(std::string_view name, uint32_t seed) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    hash ^= seed * 0x9e3779b9u;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+  }
+
+  constexpr bool TryPlace(uint32_t seed) {
+    for (size_t i = 0; i < kSlotSize; ++i) {
+      slots_[i] = N;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      const size_t slot = Hash(entries_[i].first, seed) & (kSlotSize - 1);
+      if (slots_[slot] != N) {
+        return false;
+      }
+      slots_[slot] = i;
+    }
+    return true;
+  }
+
+  std::array<value_type, N> entries_;
+  std::array<size_t, kSlotSize> slots_;
+  uint32_t seed_;
+};
+
+template <typename Enum, typename Value, size_t N>
+constexpr EnumMap<Enum, Value, N> MakeEnumMap(
+    const std::pair<Enum, Value> (&entries)[N]) {
+  return EnumMap<Enum, Value, N>(entries);
+}
+
+template <typename Enum, size_t N>
+constexpr NameMap<Enum, N> MakeNameMap(
+    const std::pair<std::string_view, Enum> (&entries)[N]) {
+  return NameMap<Enum, N>(entries);
+}
+
+}  // namespace base
+}  // namespace perception
+}  // namespace apollo
@@ -1,3 +1,9 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "Eigen/Core"
 
 #include "modules/perception/common/base/object_supplement.h"
@@ -30,7 +36,7 @@ namespace base {
 
     // oriented boundingbox information
     //@brief main direction of the object, required
-    Eigen::Vector3f directioon = Eigen::Vector3f(1, 0, 0);
+    Eigen::Vector3f direction = Eigen::Vector3f(1, 0, 0);
 
     /*
     the yaw angle, theta = 0.0 <=> direction(1, 0, 0),
@@ -55,6 +61,10 @@ namespace base {
 
     //@brief object type, required
     ObjectType type = ObjectType::UNKNOWN;
+    // @brief probability for each type, required
+    std::vector<float> type_probs;
+    // @brief object sub-type, optional
+    ObjectSubType sub_type = ObjectSubType::UNKNOWN;
       // @brief probability for each sub-type, optional
     std::vector<float> sub_type_probs;
 
@@ -72,7 +82,10 @@ namespace base {
 
 
 
-  }
+  };
+
+  using ObjectPtr = std::shared_ptr<Object>;
+  using ObjectConstPtr = std::shared_ptr<const Object>;
 }
 }
 }
\ No newline at end of file
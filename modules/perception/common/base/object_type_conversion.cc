@@ -0,0 +1,135 @@
+/******************************************************************************
+ * Copyright 2018 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+#include "modules/perception/common/base/object_type_conversion.h"
+
+#include "Eigen/Core"
+
+namespace apollo {
+namespace perception {
+namespace base {
+
+namespace {
+
+using SubTypeProbMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, kObjectSubTypeNum, Eigen::RowMajor>;
+using TypeProbMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, kObjectTypeNum, Eigen::RowMajor>;
+using CollapseMatrix = Eigen::Matrix<float, kObjectSubTypeNum, kObjectTypeNum>;
+
+// one-hot rows, row i has a 1 at the type of sub-type i
+const CollapseMatrix& GetCollapseMatrix() {
+  static const CollapseMatrix matrix = [] {
+    CollapseMatrix m = CollapseMatrix::Zero();
+    for (size_t i = 0; i < kObjectSubTypeNum; ++i) {
+      const size_t type = static_cast<size_t>(kSubType2TypeTable[i]);
+      if (type < kObjectTypeNum) {
+        m(i, type) = 1.0f;
+      }
+    }
+    return m;
+  }();
+  return matrix;
+}
+
+template <typename From, typename To, size_t N>
+void Convert(const std::array<To, N>& table, const From* in, size_t size,
+             To fallback, To* out) {
+  for (size_t i = 0; i < size; ++i) {
+    const size_t index = static_cast<size_t>(in[i]);
+    out[i] = index < N ? table[index] : fallback;
+  }
+}
+
+// index of the largest value, the first one on a tie
+size_t ArgMax(const float* values, size_t size) {
+  size_t best = 0;
+  for (size_t k = 1; k < size; ++k) {
+    if (values[k] > values[best]) {
+      best = k;
+    }
+  }
+  return best;
+}
+
+}  // namespace
+
+void ConvertTypes(const ObjectSubType* in, size_t size, ObjectType* out) {
+  Convert(kSubType2TypeTable, in, size, ObjectType::UNKNOWN, out);
+}
+
+void ConvertTypes(const ObjectSubType* in, size_t size,
+                  InternalObjectType* out) {
+  Convert(kSubType2InternalTypeTable, in, size,
+          InternalObjectType::INT_UNKNOWN, out);
+}
+
+void ConvertTypes(const InternalObjectType* in, size_t size, ObjectType* out) {
+  Convert(kInternalType2TypeTable, in, size, ObjectType::UNKNOWN, out);
+}
+
+void ConvertTypes(const VisualObjectType* in, size_t size, ObjectType* out) {
+  Convert(kVisualType2TypeTable, in, size, ObjectType::UNKNOWN, out);
+}
+
+void CollapseSubTypeProbs(const float* sub_type_probs, size_t num_objects,
+                          float* type_probs) {
+  if (num_objects == 0) {
+    return;
+  }
+  const Eigen::Map<const SubTypeProbMatrix> in(
+      sub_type_probs, static_cast<Eigen::Index>(num_objects),
+      kObjectSubTypeNum);
+  Eigen::Map<TypeProbMatrix> out(
+      type_probs, static_cast<Eigen::Index>(num_objects), kObjectTypeNum);
+  out.noalias() = in * GetCollapseMatrix();
+}
+
+void CollapseSubTypeProbs(std::vector<ObjectPtr>* objects) {
+  if (objects == nullptr) {
+    return;
+  }
+  thread_local std::vector<Object*> selected;
+  thread_local std::vector<float> sub_type_probs;
+  thread_local std::vector<float> type_probs;
+  selected.clear();
+  sub_type_probs.clear();
+  for (const auto& object : *objects) {
+    if (object == nullptr ||
+        object->sub_type_probs.size() != kObjectSubTypeNum) {
+      continue;
+    }
+    selected.push_back(object.get());
+    sub_type_probs.insert(sub_type_probs.end(),
+                          object->sub_type_probs.begin(),
+                          object->sub_type_probs.end());
+  }
+  type_probs.resize(selected.size() * kObjectTypeNum);
+  CollapseSubTypeProbs(sub_type_probs.data(), selected.size(),
+                       type_probs.data());
+
+  for (size_t i = 0; i < selected.size(); ++i) {
+    const float* sub_probs = sub_type_probs.data() + i * kObjectSubTypeNum;
+    const float* probs = type_probs.data() + i * kObjectTypeNum;
+    selected[i]->sub_type = static_cast<ObjectSubType>(
+        ArgMax(sub_probs, kObjectSubTypeNum));
+    selected[i]->type_probs.assign(probs, probs + kObjectTypeNum);
+    selected[i]->type = static_cast<ObjectType>(ArgMax(probs, kObjectTypeNum));
+  }
+}
+
+}  // namespace base
+}  // namespace perception
+}  // namespace apollo
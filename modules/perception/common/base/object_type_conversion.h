@@ -0,0 +1,148 @@
+/******************************************************************************
+ * Copyright 2018 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "modules/perception/common/base/object.h"
+#include "modules/perception/common/base/object_types.h"
+
+namespace apollo {
+namespace perception {
+namespace base {
+
+constexpr size_t kObjectTypeNum =
+    static_cast<size_t>(ObjectType::MAX_OBJECT_TYPE);
+constexpr size_t kObjectSubTypeNum =
+    static_cast<size_t>(ObjectSubType::MAX_OBJECT_TYPE);
+constexpr size_t kInternalObjectTypeNum =
+    static_cast<size_t>(InternalObjectType::INT_MAX_OBJECT_TYPE);
+constexpr size_t kVisualObjectTypeNum =
+    static_cast<size_t>(VisualObjectType::MAX_OBJECT_TYPE);
+
+/**
+ * Conversion tables indexed by the source enum value
+ */
+template <typename From, typename To, size_t N, typename Map>
+constexpr std::array<To, N> MakeConversionTable(const Map& map, To fallback) {
+  std::array<To, N> table{};
+  for (size_t i = 0; i < N; ++i) {
+    const auto iter = map.find(static_cast<From>(i));
+    table[i] = iter != map.end() ? iter->second : fallback;
+  }
+  return table;
+}
+
+constexpr auto kInternalType2TypeMap =
+    MakeEnumMap<InternalObjectType, ObjectType>({
+        {InternalObjectType::INT_BACKGROUND, ObjectType::UNKNOWN_UNMOVABLE},
+        {InternalObjectType::INT_SMALLMOT, ObjectType::VEHICLE},
+        {InternalObjectType::INT_PEDESTRIAN, ObjectType::PEDESTRIAN},
+        {InternalObjectType::INT_NONMOT, ObjectType::BICYCLE},
+        {InternalObjectType::INT_BIGMOT, ObjectType::VEHICLE},
+        {InternalObjectType::INT_UNKNOWN, ObjectType::UNKNOWN},
+    });
+
+constexpr auto kSubType2InternalTypeMap =
+    MakeEnumMap<ObjectSubType, InternalObjectType>({
+        {ObjectSubType::UNKNOWN, InternalObjectType::INT_UNKNOWN},
+        {ObjectSubType::UNKNOWN_MOVABLE, InternalObjectType::INT_UNKNOWN},
+        {ObjectSubType::UNKNOWN_UNMOVABLE, InternalObjectType::INT_BACKGROUND},
+        {ObjectSubType::CAR, InternalObjectType::INT_SMALLMOT},
+        {ObjectSubType::VAN, InternalObjectType::INT_SMALLMOT},
+        {ObjectSubType::TRUCK, InternalObjectType::INT_BIGMOT},
+        {ObjectSubType::BUS, InternalObjectType::INT_BIGMOT},
+        {ObjectSubType::CYCLIST, InternalObjectType::INT_NONMOT},
+        {ObjectSubType::MOTORCYCLIST, InternalObjectType::INT_NONMOT},
+        {ObjectSubType::TRICYCLIST, InternalObjectType::INT_NONMOT},
+        {ObjectSubType::PEDESTRIAN, InternalObjectType::INT_PEDESTRIAN},
+        {ObjectSubType::TRAFFICCONE, InternalObjectType::INT_BACKGROUND},
+        {ObjectSubType::SMALLMOT, InternalObjectType::INT_SMALLMOT},
+        {ObjectSubType::BIGMOT, InternalObjectType::INT_BIGMOT},
+        {ObjectSubType::NONMOT, InternalObjectType::INT_NONMOT},
+    });
+
+constexpr auto kSubType2TypeTable =
+    MakeConversionTable<ObjectSubType, ObjectType, kObjectSubTypeNum>(
+        kSubType2TypeMap, ObjectType::UNKNOWN);
+constexpr auto kSubType2InternalTypeTable =
+    MakeConversionTable<ObjectSubType, InternalObjectType, kObjectSubTypeNum>(
+        kSubType2InternalTypeMap, InternalObjectType::INT_UNKNOWN);
+constexpr auto kInternalType2TypeTable =
+    MakeConversionTable<InternalObjectType, ObjectType,
+                        kInternalObjectTypeNum>(kInternalType2TypeMap,
+                                                ObjectType::UNKNOWN);
+constexpr auto kVisualType2TypeTable =
+    MakeConversionTable<VisualObjectType, ObjectType, kVisualObjectTypeNum>(
+        kVisualTypeMap, ObjectType::UNKNOWN);
+
+// InternalObjectType has a single unknown class: the UNKNOWN_MOVABLE sub-type
+// goes to INT_UNKNOWN and comes back as UNKNOWN, convert sub-types with
+// kSubType2TypeTable to keep it. Every other sub-type gets the same type
+// directly and through its internal type.
+constexpr bool SubTypeTablesAgree() {
+  for (size_t i = 0; i < kObjectSubTypeNum; ++i) {
+    const auto sub_type = static_cast<ObjectSubType>(i);
+    const size_t internal = static_cast<size_t>(kSubType2InternalTypeTable[i]);
+    const ObjectType via_internal = internal < kInternalObjectTypeNum
+                                        ? kInternalType2TypeTable[internal]
+                                        : ObjectType::UNKNOWN;
+    const ObjectType expected = sub_type == ObjectSubType::UNKNOWN_MOVABLE
+                                    ? ObjectType::UNKNOWN
+                                    : kSubType2TypeTable[i];
+    if (via_internal != expected) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(SubTypeTablesAgree(),
+              "sub-type, internal type and type tables disagree");
+
+/**
+ * @brief Convert arrays of types, in and out hold size values.
+ *        Out of range input maps to UNKNOWN.
+ */
+void ConvertTypes(const ObjectSubType* in, size_t size, ObjectType* out);
+void ConvertTypes(const ObjectSubType* in, size_t size,
+                  InternalObjectType* out);
+void ConvertTypes(const InternalObjectType* in, size_t size, ObjectType* out);
+void ConvertTypes(const VisualObjectType* in, size_t size, ObjectType* out);
+
+/**
+ * @brief Sum sub-type probabilities into type probabilities for num_objects
+ *        objects at once
+ *
+ * sub_type_probs is row major num_objects x kObjectSubTypeNum, type_probs
+ * is row major num_objects x kObjectTypeNum. The sum is one product with the
+ * 0/1 sub-type to type matrix.
+ */
+void CollapseSubTypeProbs(const float* sub_type_probs, size_t num_objects,
+                          float* type_probs);
+
+/**
+ * @brief Fill sub_type, type_probs and type of every object from its
+ *        sub_type_probs, objects without a full sub_type_probs are left
+ *        unchanged
+ */
+void CollapseSubTypeProbs(std::vector<ObjectPtr>* objects);
+
+}  // namespace base
+}  // namespace perception
+}  // namespace apollo
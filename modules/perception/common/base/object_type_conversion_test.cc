@@ -0,0 +1,111 @@
+#include "modules/perception/common/base/object_type_conversion.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace perception {
+namespace base {
+
+namespace {
+
+ObjectPtr MakeObject(
+    const std::vector<std::pair<ObjectSubType, float>>& probs) {
+  auto object = std::make_shared<Object>();
+  object->sub_type_probs.assign(kObjectSubTypeNum, 0.0f);
+  for (const auto& prob : probs) {
+    object->sub_type_probs[static_cast<size_t>(prob.first)] = prob.second;
+  }
+  return object;
+}
+
+}  // namespace
+
+TEST(ObjectTypeConversionTest, TablesFollowTheMaps) {
+  for (const auto& entry : kSubType2TypeMap) {
+    const size_t index = static_cast<size_t>(entry.first);
+    if (index < kObjectSubTypeNum) {
+      EXPECT_EQ(entry.second, kSubType2TypeTable[index]);
+    }
+  }
+  for (const auto& entry : kVisualTypeMap) {
+    const size_t index = static_cast<size_t>(entry.first);
+    if (index < kVisualObjectTypeNum) {
+      EXPECT_EQ(entry.second, kVisualType2TypeTable[index]);
+    }
+  }
+}
+
+TEST(ObjectTypeConversionTest, ConvertsArrays) {
+  const std::vector<ObjectSubType> sub_types = {
+      ObjectSubType::CAR, ObjectSubType::UNKNOWN_MOVABLE,
+      ObjectSubType::TRAFFICCONE, ObjectSubType::CYCLIST,
+      ObjectSubType::MAX_OBJECT_TYPE};
+  std::vector<ObjectType> types(sub_types.size());
+  ConvertTypes(sub_types.data(), sub_types.size(), types.data());
+  EXPECT_EQ(std::vector<ObjectType>(
+                {ObjectType::VEHICLE, ObjectType::UNKNOWN_MOVABLE,
+                 ObjectType::UNKNOWN_UNMOVABLE, ObjectType::BICYCLE,
+                 ObjectType::UNKNOWN}),
+            types);
+
+  std::vector<InternalObjectType> internal_types(sub_types.size());
+  ConvertTypes(sub_types.data(), sub_types.size(), internal_types.data());
+  EXPECT_EQ(InternalObjectType::INT_SMALLMOT, internal_types[0]);
+  EXPECT_EQ(InternalObjectType::INT_UNKNOWN, internal_types[1]);
+  EXPECT_EQ(InternalObjectType::INT_BACKGROUND, internal_types[2]);
+  EXPECT_EQ(InternalObjectType::INT_NONMOT, internal_types[3]);
+
+  // through the internal type, only UNKNOWN_MOVABLE loses its type
+  std::vector<ObjectType> via_internal(sub_types.size());
+  ConvertTypes(internal_types.data(), internal_types.size(),
+               via_internal.data());
+  for (size_t i = 0; i < sub_types.size(); ++i) {
+    if (sub_types[i] == ObjectSubType::UNKNOWN_MOVABLE) {
+      EXPECT_EQ(ObjectType::UNKNOWN, via_internal[i]);
+    } else {
+      EXPECT_EQ(types[i], via_internal[i]);
+    }
+  }
+}
+
+TEST(ObjectTypeConversionTest, CollapseSetsSubTypeAndType) {
+  std::vector<ObjectPtr> objects = {
+      MakeObject({{ObjectSubType::CAR, 0.4f},
+                  {ObjectSubType::TRUCK, 0.3f},
+                  {ObjectSubType::PEDESTRIAN, 0.3f}}),
+      // the likeliest sub-type is not of the likeliest type
+      MakeObject({{ObjectSubType::PEDESTRIAN, 0.4f},
+                  {ObjectSubType::CAR, 0.3f},
+                  {ObjectSubType::BUS, 0.3f}}),
+      MakeObject({{ObjectSubType::CYCLIST, 1.0f}}),
+      std::make_shared<Object>(),
+      nullptr};
+  objects[3]->sub_type = ObjectSubType::VAN;
+  CollapseSubTypeProbs(&objects);
+
+  EXPECT_EQ(ObjectSubType::CAR, objects[0]->sub_type);
+  EXPECT_EQ(ObjectType::VEHICLE, objects[0]->type);
+  ASSERT_EQ(kObjectTypeNum, objects[0]->type_probs.size());
+  EXPECT_FLOAT_EQ(0.7f, objects[0]->type_probs[static_cast<size_t>(
+                            ObjectType::VEHICLE)]);
+  EXPECT_FLOAT_EQ(0.3f, objects[0]->type_probs[static_cast<size_t>(
+                            ObjectType::PEDESTRIAN)]);
+
+  EXPECT_EQ(ObjectSubType::PEDESTRIAN, objects[1]->sub_type);
+  EXPECT_EQ(ObjectType::VEHICLE, objects[1]->type);
+
+  EXPECT_EQ(ObjectSubType::CYCLIST, objects[2]->sub_type);
+  EXPECT_EQ(ObjectType::BICYCLE, objects[2]->type);
+
+  // no sub_type_probs, left unchanged
+  EXPECT_EQ(ObjectSubType::VAN, objects[3]->sub_type);
+  EXPECT_TRUE(objects[3]->type_probs.empty());
+}
+
+}  // namespace base
+}  // namespace perception
+}  // namespace apollo
@@ -15,8 +15,10 @@
  *****************************************************************************/
 #pragma once
 
-#include <map>
 #include <string>
+#include <string_view>
+
+#include "modules/perception/common/base/enum_map.h"
 
 namespace apollo {
 namespace perception {
@@ -113,46 +115,50 @@ enum class VisualLandmarkType {
   MAX_LANDMARK_TYPE,
 };
 
-const std::map<VisualLandmarkType, std::string> kVisualLandmarkType2NameMap = {
+// the name maps below hold std::string_view, use std::string(name) where an
+// owned string is needed
+constexpr auto kVisualLandmarkType2NameMap =
+    MakeEnumMap<VisualLandmarkType, std::string_view>({
     {VisualLandmarkType::RoadArrow, "RoadArrow"},
     {VisualLandmarkType::RoadText, "RoadText"},
     {VisualLandmarkType::TrafficSign, "TrafficSign"},
     {VisualLandmarkType::TrafficLight, "TrafficLight"},
-};
+});
 
-const std::map<std::string, base::VisualLandmarkType>
-    kVisualLandmarkName2TypeMap = {
+constexpr auto kVisualLandmarkName2TypeMap =
+    MakeNameMap<VisualLandmarkType>({
         {"RoadArrow", VisualLandmarkType::RoadArrow},
         {"RoadText", VisualLandmarkType::RoadText},
         {"TrafficSign", VisualLandmarkType::TrafficSign},
         {"TrafficLight", VisualLandmarkType::TrafficLight},
-};
+});
 
 /**
  * ObjectType mapping
  */
-const std::map<ObjectType, std::string> kObjectType2NameMap = {
+constexpr auto kObjectType2NameMap = MakeEnumMap<ObjectType, std::string_view>({
     {ObjectType::UNKNOWN, "UNKNOWN"},
     {ObjectType::UNKNOWN_MOVABLE, "UNKNOWN_MOVABLE"},
     {ObjectType::UNKNOWN_UNMOVABLE, "UNKNOWN_UNMOVABLE"},
     {ObjectType::PEDESTRIAN, "PEDESTRIAN"},
     {ObjectType::BICYCLE, "BICYCLE"},
     {ObjectType::VEHICLE, "VEHICLE"},
-    {ObjectType::MAX_OBJECT_TYPE, "MAX_OBJECT_TYPE"}};
+    {ObjectType::MAX_OBJECT_TYPE, "MAX_OBJECT_TYPE"}});
 
-const std::map<std::string, ObjectType> kObjectName2TypeMap = {
+constexpr auto kObjectName2TypeMap = MakeNameMap<ObjectType>({
     {"UNKNOWN", ObjectType::UNKNOWN},
     {"UNKNOWN_MOVABLE", ObjectType::UNKNOWN_MOVABLE},
     {"UNKNOWN_UNMOVABLE", ObjectType::UNKNOWN_UNMOVABLE},
     {"PEDESTRIAN", ObjectType::PEDESTRIAN},
     {"BICYCLE", ObjectType::BICYCLE},
     {"VEHICLE", ObjectType::VEHICLE},
-    {"MAX_OBJECT_TYPE", ObjectType::MAX_OBJECT_TYPE}};
+    {"MAX_OBJECT_TYPE", ObjectType::MAX_OBJECT_TYPE}});
 
 /**
  * ObjectSemanticType mapping
  */
-const std::map<ObjectSemanticType, std::string> kObjectSemanticType2NameMap = {
+constexpr auto kObjectSemanticType2NameMap =
+    MakeEnumMap<ObjectSemanticType, std::string_view>({
     {ObjectSemanticType::UNKNOWN, "UNKNOWN"},
     {ObjectSemanticType::IGNORE, "IGNORE"},
     {ObjectSemanticType::GROUND, "GROUND"},
@@ -163,9 +169,9 @@ const std::map<ObjectSemanticType, std::string> kObjectSemanticType2NameMap = {
     {ObjectSemanticType::NOISE, "NOISE"},
     {ObjectSemanticType::WALL, "WALL"},
     {ObjectSemanticType::MAX_OBJECT_SEMANTIC_LABEL,
-     "MAX_OBJECT_SEMANTIC_LABEL"}};
+     "MAX_OBJECT_SEMANTIC_LABEL"}});
 
-const std::map<std::string, ObjectSemanticType> kName2ObjectSemanticTypeMap = {
+constexpr auto kName2ObjectSemanticTypeMap = MakeNameMap<ObjectSemanticType>({
     {"UNKNOWN", ObjectSemanticType::UNKNOWN},
     {"IGNORE", ObjectSemanticType::IGNORE},
     {"GROUND", ObjectSemanticType::GROUND},
@@ -176,12 +182,12 @@ const std::map<std::string, ObjectSemanticType> kName2ObjectSemanticTypeMap = {
     {"NOISE", ObjectSemanticType::NOISE},
     {"WALL", ObjectSemanticType::WALL},
     {"MAX_OBJECT_SEMANTIC_LABEL",
-     ObjectSemanticType::MAX_OBJECT_SEMANTIC_LABEL}};
+     ObjectSemanticType::MAX_OBJECT_SEMANTIC_LABEL}});
 
 /**
  * VisualObjectType mapping
  */
-const std::map<VisualObjectType, ObjectType> kVisualTypeMap = {
+constexpr auto kVisualTypeMap = MakeEnumMap<VisualObjectType, ObjectType>({
     {VisualObjectType::CAR, ObjectType::VEHICLE},
     {VisualObjectType::VAN, ObjectType::VEHICLE},
     {VisualObjectType::BUS, ObjectType::VEHICLE},
@@ -193,9 +199,10 @@ const std::map<VisualObjectType, ObjectType> kVisualTypeMap = {
     {VisualObjectType::UNKNOWN_MOVABLE, ObjectType::UNKNOWN_MOVABLE},
     {VisualObjectType::UNKNOWN_UNMOVABLE, ObjectType::UNKNOWN_UNMOVABLE},
     {VisualObjectType::MAX_OBJECT_TYPE, ObjectType::MAX_OBJECT_TYPE},
-};
+});
 
-const std::map<VisualObjectType, std::string> kVisualType2NameMap = {
+constexpr auto kVisualType2NameMap =
+    MakeEnumMap<VisualObjectType, std::string_view>({
     {VisualObjectType::CAR, "CAR"},
     {VisualObjectType::VAN, "VAN"},
     {VisualObjectType::BUS, "BUS"},
@@ -207,9 +214,9 @@ const std::map<VisualObjectType, std::string> kVisualType2NameMap = {
     {VisualObjectType::UNKNOWN_MOVABLE, "UNKNOWN_MOVABLE"},
     {VisualObjectType::UNKNOWN_UNMOVABLE, "UNKNOWN_UNMOVABLE"},
     {VisualObjectType::MAX_OBJECT_TYPE, "MAX_OBJECT_TYPE"},
-};
+});
 
-const std::map<std::string, base::VisualObjectType> kVisualName2TypeMap = {
+constexpr auto kVisualName2TypeMap = MakeNameMap<VisualObjectType>({
     {"CAR", VisualObjectType::CAR},
     {"VAN", VisualObjectType::VAN},
     {"BUS", VisualObjectType::BUS},
@@ -221,12 +228,12 @@ const std::map<std::string, base::VisualObjectType> kVisualName2TypeMap = {
     {"UNKNOWN_MOVABLE", VisualObjectType::UNKNOWN_MOVABLE},
     {"UNKNOWN_UNMOVABLE", VisualObjectType::UNKNOWN_UNMOVABLE},
     {"MAX_OBJECT_TYPE", VisualObjectType::MAX_OBJECT_TYPE},
-};
+});
 
 /**
  * ObjectSubType mapping
  */
-const std::map<ObjectSubType, ObjectType> kSubType2TypeMap = {
+constexpr auto kSubType2TypeMap = MakeEnumMap<ObjectSubType, ObjectType>({
     {ObjectSubType::UNKNOWN, ObjectType::UNKNOWN},
     {ObjectSubType::UNKNOWN_MOVABLE, ObjectType::UNKNOWN_MOVABLE},
     {ObjectSubType::UNKNOWN_UNMOVABLE, ObjectType::UNKNOWN_UNMOVABLE},
@@ -243,9 +250,9 @@ const std::map<ObjectSubType, ObjectType> kSubType2TypeMap = {
     {ObjectSubType::NONMOT, ObjectType::BICYCLE},
     {ObjectSubType::TRAFFICCONE, ObjectType::UNKNOWN_UNMOVABLE},
     {ObjectSubType::MAX_OBJECT_TYPE, ObjectType::MAX_OBJECT_TYPE},
-};
+});
 
-const std::map<ObjectSubType, std::string> kSubType2NameMap = {
+constexpr auto kSubType2NameMap = MakeEnumMap<ObjectSubType, std::string_view>({
     {ObjectSubType::UNKNOWN, "UNKNOWN"},
     {ObjectSubType::UNKNOWN_MOVABLE, "UNKNOWN_MOVABLE"},
     {ObjectSubType::UNKNOWN_UNMOVABLE, "UNKNOWN_UNMOVABLE"},
@@ -259,9 +266,9 @@ const std::map<ObjectSubType, std::string> kSubType2NameMap = {
     {ObjectSubType::PEDESTRIAN, "PEDESTRIAN"},
     {ObjectSubType::TRAFFICCONE, "TRAFFICCONE"},
     {ObjectSubType::MAX_OBJECT_TYPE, "MAX_OBJECT_TYPE"},
-};
+});
 
-const std::map<std::string, ObjectSubType> kName2SubTypeMap = {
+constexpr auto kName2SubTypeMap = MakeNameMap<ObjectSubType>({
     {"UNKNOWN", ObjectSubType::UNKNOWN},
     {"UNKNOWN_MOVABLE", ObjectSubType::UNKNOWN_MOVABLE},
     {"UNKNOWN_UNMOVABLE", ObjectSubType::UNKNOWN_UNMOVABLE},
@@ -275,7 +282,7 @@ const std::map<std::string, ObjectSubType> kName2SubTypeMap = {
     {"PEDESTRIAN", ObjectSubType::PEDESTRIAN},
     {"TRAFFICCONE", ObjectSubType::TRAFFICCONE},
     {"MAX_OBJECT_TYPE", ObjectSubType::MAX_OBJECT_TYPE},
-};
+});
 
 }  // namespace base
 }  // namespace perception
@@ -1,5 +1,7 @@
-#pragma onece
+#pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
 
 namespace apollo {
@@ -38,12 +40,27 @@ enum class SensorOrientation {
   PANORAMIC = 8
 };
 
+/**
+ * @brief Dense id of a sensor interned by algorithm::SensorRegistry,
+ *        ids start at 0 in registration order
+ */
+using SensorId = uint16_t;
+constexpr SensorId kInvalidSensorId = std::numeric_limits<SensorId>::max();
+
 struct SensorInfo {
   std::string name = "UNKNOWN_SENSOR";
   SensorType type = SensorType::UNKNOWN_SENSOR_TYPE;
   SensorOrientation orientation = SensorOrientation::FRONT;
   std::string frame_id = "UNKNOWN_FRAME_ID";
   bool is_main_sensor = false;
+
+  void Reset() {
+    name = "UNKNOWN_SENSOR";
+    type = SensorType::UNKNOWN_SENSOR_TYPE;
+    orientation = SensorOrientation::FRONT;
+    frame_id = "UNKNOWN_FRAME_ID";
+    is_main_sensor = false;
+  }
 };
 
 
@@ -0,0 +1,359 @@
+#include "modules/perception/common/onboard/flat_frame/flat_frame.h"
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "cyber/common/log.h"
+#include "modules/perception/common/algorithm/sensor_manager/sensor_registry.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+static_assert(std::is_trivially_copyable<FlatFrameHeader>::value,
+              "FlatFrameHeader must be trivially copyable");
+static_assert(std::is_trivially_copyable<FlatObject>::value,
+              "FlatObject must be trivially copyable");
+static_assert(std::is_trivially_copyable<StageStamp>::value,
+              "StageStamp must be trivially copyable");
+static_assert(alignof(FlatFrameHeader) <= 8 && alignof(FlatObject) <= 8,
+              "flat sections are 8 byte aligned");
+
+namespace {
+
+constexpr size_t Align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+struct FlatFrameLayout {
+  size_t objects_offset = 0;
+  size_t polygon_offset = 0;
+  size_t probs_offset = 0;
+  size_t strings_offset = 0;
+  size_t polygon_count = 0;
+  size_t probs_count = 0;
+  size_t strings_size = 0;
+  size_t total_size = 0;
+};
+
+FlatFrameLayout ComputeLayout(const SensorFrameMessage& message) {
+  FlatFrameLayout layout;
+  size_t object_count = 0;
+  if (message.frame_ != nullptr) {
+    object_count = message.frame_->objects.size();
+    for (const auto& object : message.frame_->objects) {
+      layout.polygon_count += object->polygon.size();
+      layout.probs_count +=
+          object->type_probs.size() + object->sub_type_probs.size();
+    }
+  }
+  layout.strings_size = message.sensor_id_.size();
+
+  layout.objects_offset = Align8(sizeof(FlatFrameHeader));
+  layout.polygon_offset =
+      Align8(layout.objects_offset + object_count * sizeof(FlatObject));
+  layout.probs_offset =
+      Align8(layout.polygon_offset + layout.polygon_count * sizeof(FlatPoint));
+  layout.strings_offset =
+      Align8(layout.probs_offset + layout.probs_count * sizeof(float));
+  layout.total_size = Align8(layout.strings_offset + layout.strings_size);
+  return layout;
+}
+
+template <typename Matrix>
+void CopyMatrix(const Matrix& matrix, float* out) {
+  for (int i = 0; i < matrix.size(); ++i) {
+    out[i] = static_cast<float>(matrix.data()[i]);
+  }
+}
+
+template <typename Matrix>
+void LoadMatrix(const float* in, Matrix* matrix) {
+  for (int i = 0; i < matrix->size(); ++i) {
+    matrix->data()[i] = in[i];
+  }
+}
+
+void FillFlatObject(const base::Object& object, uint32_t polygon_begin,
+                    uint32_t probs_begin, FlatObject* flat) {
+  std::memset(flat, 0, sizeof(FlatObject));
+  flat->id = object.id;
+  flat->track_id = object.track_id;
+  flat->type = static_cast<int32_t>(object.type);
+  flat->sub_type = static_cast<int32_t>(object.sub_type);
+  flat->polygon_begin = polygon_begin;
+  flat->polygon_size = static_cast<uint32_t>(object.polygon.size());
+  flat->type_probs_begin = probs_begin;
+  flat->type_probs_size = static_cast<uint32_t>(object.type_probs.size());
+  flat->sub_type_probs_begin = probs_begin + flat->type_probs_size;
+  flat->sub_type_probs_size =
+      static_cast<uint32_t>(object.sub_type_probs.size());
+  for (int i = 0; i < 3; ++i) {
+    flat->center[i] = object.center[i];
+    flat->anchor_point[i] = object.anchor_point[i];
+    flat->direction[i] = object.direction[i];
+    flat->size[i] = object.size[i];
+    flat->size_variance[i] = object.size_variance[i];
+    flat->velocity[i] = object.velocity[i];
+  }
+  flat->theta = object.theta;
+  flat->theta_variance = object.theta_variance;
+  flat->confidence = object.confidence;
+  CopyMatrix(object.center_uncertainty, flat->center_uncertainty);
+  CopyMatrix(object.velocity_uncertainty, flat->velocity_uncertainty);
+}
+
+void FillObject(const FlatFrameView& view, const FlatObject& flat,
+                base::Object* object) {
+  object->id = flat.id;
+  object->track_id = flat.track_id;
+  object->type = static_cast<base::ObjectType>(flat.type);
+  object->sub_type = static_cast<base::ObjectSubType>(flat.sub_type);
+  for (int i = 0; i < 3; ++i) {
+    object->center[i] = flat.center[i];
+    object->anchor_point[i] = flat.anchor_point[i];
+    object->direction[i] = flat.direction[i];
+    object->size[i] = flat.size[i];
+    object->size_variance[i] = flat.size_variance[i];
+    object->velocity[i] = flat.velocity[i];
+  }
+  object->theta = flat.theta;
+  object->theta_variance = flat.theta_variance;
+  object->confidence = flat.confidence;
+  LoadMatrix(flat.center_uncertainty, &object->center_uncertainty);
+  LoadMatrix(flat.velocity_uncertainty, &object->velocity_uncertainty);
+
+  const FlatPoint* polygon = view.polygon(flat);
+  object->polygon.resize(flat.polygon_size);
+  for (uint32_t i = 0; i < flat.polygon_size; ++i) {
+    object->polygon[i].x = polygon[i].x;
+    object->polygon[i].y = polygon[i].y;
+    object->polygon[i].z = polygon[i].z;
+  }
+  const float* type_probs = view.type_probs(flat);
+  object->type_probs.assign(type_probs, type_probs + flat.type_probs_size);
+  const float* sub_type_probs = view.sub_type_probs(flat);
+  object->sub_type_probs.assign(sub_type_probs,
+                                sub_type_probs + flat.sub_type_probs_size);
+}
+
+bool InRange(size_t begin, size_t count, size_t limit) {
+  return begin <= limit && count <= limit - begin;
+}
+
+}  // namespace
+
+size_t FlatFrameSize(const SensorFrameMessage& message) {
+  return ComputeLayout(message).total_size;
+}
+
+size_t SerializeFlatFrame(const SensorFrameMessage& message, void* data,
+                          size_t capacity) {
+  const FlatFrameLayout layout = ComputeLayout(message);
+  if (data == nullptr || capacity < layout.total_size) {
+    AERROR << "Flat frame needs " << layout.total_size << " bytes, only "
+           << capacity << " available.";
+    return 0;
+  }
+  if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+    AERROR << "Flat frame buffer is not 8 byte aligned.";
+    return 0;
+  }
+  uint8_t* bytes = static_cast<uint8_t*>(data);
+  std::memset(bytes, 0, layout.total_size);
+
+  auto* header = reinterpret_cast<FlatFrameHeader*>(bytes);
+  header->magic = kFlatFrameMagic;
+  header->version = kFlatFrameVersion;
+  header->byte_order = kFlatFrameByteOrder;
+  header->header_size = sizeof(FlatFrameHeader);
+  header->total_size = static_cast<uint32_t>(layout.total_size);
+  header->timestamp = message.timestamp_;
+  header->lidar_timestamp = message.lidar_timestamp_;
+  header->seq_num = message.seq_num_;
+  header->error_code = static_cast<int32_t>(message.error_code_);
+  header->process_stage = static_cast<int32_t>(message.process_stage_);
+  header->sensor_index = message.sensor_index_;
+  std::memcpy(header->stage_stamps, message.stage_stamps_.data(),
+              sizeof(header->stage_stamps));
+  header->sensor_id_offset = 0;
+  header->sensor_id_size = static_cast<uint32_t>(message.sensor_id_.size());
+  header->objects_offset = static_cast<uint32_t>(layout.objects_offset);
+  header->polygon_offset = static_cast<uint32_t>(layout.polygon_offset);
+  header->polygon_count = static_cast<uint32_t>(layout.polygon_count);
+  header->probs_offset = static_cast<uint32_t>(layout.probs_offset);
+  header->probs_count = static_cast<uint32_t>(layout.probs_count);
+  header->strings_offset = static_cast<uint32_t>(layout.strings_offset);
+  header->strings_size = static_cast<uint32_t>(layout.strings_size);
+  std::memcpy(bytes + layout.strings_offset, message.sensor_id_.data(),
+              message.sensor_id_.size());
+
+  const auto& frame = message.frame_;
+  if (frame == nullptr) {
+    header->sensor_type =
+        static_cast<int32_t>(base::SensorType::UNKNOWN_SENSOR_TYPE);
+    for (int i = 0; i < 16; ++i) {
+      header->sensor2world_pose[i] = i % 5 == 0 ? 1.0 : 0.0;
+    }
+    return layout.total_size;
+  }
+  header->sensor_type = static_cast<int32_t>(frame->sensor_info.type);
+  header->frame_timestamp = frame->timestamp;
+  std::memcpy(header->sensor2world_pose, frame->sensor2world_pose.data(),
+              sizeof(header->sensor2world_pose));
+  header->object_count = static_cast<uint32_t>(frame->objects.size());
+
+  auto* objects = reinterpret_cast<FlatObject*>(bytes + layout.objects_offset);
+  auto* polygon = reinterpret_cast<FlatPoint*>(bytes + layout.polygon_offset);
+  auto* probs = reinterpret_cast<float*>(bytes + layout.probs_offset);
+  uint32_t polygon_begin = 0;
+  uint32_t probs_begin = 0;
+  for (size_t i = 0; i < frame->objects.size(); ++i) {
+    const base::Object& object = *frame->objects[i];
+    FillFlatObject(object, polygon_begin, probs_begin, &objects[i]);
+    for (size_t k = 0; k < object.polygon.size(); ++k) {
+      FlatPoint& point = polygon[polygon_begin + k];
+      point.x = object.polygon[k].x;
+      point.y = object.polygon[k].y;
+      point.z = object.polygon[k].z;
+    }
+    std::memcpy(probs + probs_begin, object.type_probs.data(),
+                object.type_probs.size() * sizeof(float));
+    std::memcpy(probs + objects[i].sub_type_probs_begin,
+                object.sub_type_probs.data(),
+                object.sub_type_probs.size() * sizeof(float));
+    polygon_begin += objects[i].polygon_size;
+    probs_begin +=
+        objects[i].type_probs_size + objects[i].sub_type_probs_size;
+  }
+  return layout.total_size;
+}
+
+bool SerializeFlatFrame(const SensorFrameMessage& message,
+                        std::vector<uint8_t>* buffer) {
+  if (buffer == nullptr) {
+    AERROR << "buffer is nullptr";
+    return false;
+  }
+  // std::vector<uint8_t> storage comes from operator new, which is aligned
+  // for any fundamental type
+  buffer->resize(FlatFrameSize(message));
+  return SerializeFlatFrame(message, buffer->data(), buffer->size()) != 0;
+}
+
+bool FlatFrameView::Init(const void* data, size_t size) {
+  header_ = nullptr;
+  if (data == nullptr || size < sizeof(FlatFrameHeader)) {
+    AERROR << "Flat frame is too small, size: " << size;
+    return false;
+  }
+  if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+    AERROR << "Flat frame is not 8 byte aligned.";
+    return false;
+  }
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  const auto* header = reinterpret_cast<const FlatFrameHeader*>(bytes);
+  if (header->magic != kFlatFrameMagic ||
+      header->byte_order != kFlatFrameByteOrder) {
+    AERROR << "Not a flat frame or written with another byte order.";
+    return false;
+  }
+  if (header->version != kFlatFrameVersion ||
+      header->header_size != sizeof(FlatFrameHeader)) {
+    AERROR << "Unsupported flat frame version: " << header->version;
+    return false;
+  }
+  if (header->total_size > size) {
+    AERROR << "Flat frame is truncated, " << size << " of "
+           << header->total_size << " bytes.";
+    return false;
+  }
+  const size_t total = header->total_size;
+  const bool sections_ok =
+      header->objects_offset % 8 == 0 && header->polygon_offset % 8 == 0 &&
+      header->probs_offset % 8 == 0 &&
+      InRange(header->objects_offset,
+              size_t(header->object_count) * sizeof(FlatObject), total) &&
+      InRange(header->polygon_offset,
+              size_t(header->polygon_count) * sizeof(FlatPoint), total) &&
+      InRange(header->probs_offset,
+              size_t(header->probs_count) * sizeof(float), total) &&
+      InRange(header->strings_offset, header->strings_size, total) &&
+      InRange(header->sensor_id_offset, header->sensor_id_size,
+              header->strings_size);
+  if (!sections_ok) {
+    AERROR << "Flat frame sections are out of bounds.";
+    return false;
+  }
+  const auto* objects =
+      reinterpret_cast<const FlatObject*>(bytes + header->objects_offset);
+  for (uint32_t i = 0; i < header->object_count; ++i) {
+    const FlatObject& object = objects[i];
+    if (!InRange(object.polygon_begin, object.polygon_size,
+                 header->polygon_count) ||
+        !InRange(object.type_probs_begin, object.type_probs_size,
+                 header->probs_count) ||
+        !InRange(object.sub_type_probs_begin, object.sub_type_probs_size,
+                 header->probs_count)) {
+      AERROR << "Flat frame object " << i << " is out of bounds.";
+      return false;
+    }
+  }
+
+  header_ = header;
+  objects_ = objects;
+  polygon_ =
+      reinterpret_cast<const FlatPoint*>(bytes + header->polygon_offset);
+  probs_ = reinterpret_cast<const float*>(bytes + header->probs_offset);
+  strings_ = reinterpret_cast<const char*>(bytes + header->strings_offset);
+  return true;
+}
+
+bool DeserializeFlatFrame(const FlatFrameView& view,
+                          SensorFrameMessage* message) {
+  if (message == nullptr) {
+    AERROR << "message is nullptr";
+    return false;
+  }
+  if (!view.initialized()) {
+    AERROR << "Flat frame view is not initialized.";
+    return false;
+  }
+  const FlatFrameHeader& header = view.header();
+  message->timestamp_ = header.timestamp;
+  message->lidar_timestamp_ = header.lidar_timestamp;
+  message->seq_num_ = header.seq_num;
+  message->error_code_ =
+      static_cast<apollo::common::ErrorCode>(header.error_code);
+  message->process_stage_ = static_cast<ProcessStage>(header.process_stage);
+  message->sensor_id_ = view.sensor_id();
+  message->sensor_index_ = static_cast<base::SensorId>(header.sensor_index);
+  std::memcpy(message->stage_stamps_.data(), header.stage_stamps,
+              sizeof(header.stage_stamps));
+
+  auto frame = std::make_shared<base::Frame>();
+  frame->timestamp = header.frame_timestamp;
+  const base::SensorInfo* sensor_info =
+      algorithm::SensorRegistry::Instance()->GetSensorInfo(
+          message->sensor_index_);
+  if (sensor_info != nullptr && sensor_info->name == message->sensor_id_) {
+    frame->sensor_info = *sensor_info;
+  } else {
+    frame->sensor_info.name = message->sensor_id_;
+    frame->sensor_info.type =
+        static_cast<base::SensorType>(header.sensor_type);
+  }
+  std::memcpy(frame->sensor2world_pose.data(), header.sensor2world_pose,
+              sizeof(header.sensor2world_pose));
+  frame->objects.reserve(view.object_count());
+  for (size_t i = 0; i < view.object_count(); ++i) {
+    auto object = std::make_shared<base::Object>();
+    FillObject(view, view.object(i), object.get());
+    frame->objects.push_back(object);
+  }
+  message->frame_ = frame;
+  return true;
+}
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
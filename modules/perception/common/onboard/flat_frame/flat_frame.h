@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "modules/perception/common/onboard/inner_component_messages.h/inner_component_messages.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+/**
+ * Flat layout of SensorFrameMessage, every section is 8 byte aligned and
+ * addressed by its offset from the start of the buffer, so a buffer can be
+ * copied, mmap'd or placed in shared memory and read in place by FlatFrameView
+ *
+ *   FlatFrameHeader
+ *   FlatObject        [object_count]
+ *   FlatPoint         [polygon_count]   polygons of all objects
+ *   float             [probs_count]     type_probs and sub_type_probs
+ *   char              [strings_size]    sensor_id
+ *
+ * Integers and floats are stored in host byte order, the header records the
+ * order so a reader on another machine rejects the buffer instead of
+ * misreading it. hdmap_ and the frame supplements are not carried.
+ */
+constexpr uint32_t kFlatFrameMagic = 0x46524D46;  // "FMRF"
+constexpr uint16_t kFlatFrameVersion = 3;
+constexpr uint16_t kFlatFrameByteOrder = 0x0102;
+
+struct FlatFrameHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t byte_order;
+  uint32_t header_size;
+  uint32_t total_size;
+
+  double timestamp;
+  uint64_t lidar_timestamp;
+  uint32_t seq_num;
+  int32_t error_code;
+  int32_t process_stage;
+  int32_t sensor_type;
+  // base::SensorId, only meaningful within one SensorRegistry
+  uint32_t sensor_index;
+  uint32_t reserved;
+  double sensor2world_pose[16];  // column major, like Eigen
+  double frame_timestamp;
+  // onboard::LatencyTracer stamps, indexed by ProcessStage
+  StageStamp stage_stamps[kProcessStageCount];
+
+  uint32_t sensor_id_offset;  // in the string section
+  uint32_t sensor_id_size;
+
+  uint32_t objects_offset;
+  uint32_t object_count;
+  uint32_t polygon_offset;
+  uint32_t polygon_count;
+  uint32_t probs_offset;
+  uint32_t probs_count;
+  uint32_t strings_offset;
+  uint32_t strings_size;
+};
+
+struct FlatPoint {
+  double x;
+  double y;
+  double z;
+};
+
+struct FlatObject {
+  int32_t id;
+  int32_t track_id;
+  int32_t type;
+  int32_t sub_type;
+
+  // ranges in the polygon and probs sections
+  uint32_t polygon_begin;
+  uint32_t polygon_size;
+  uint32_t type_probs_begin;
+  uint32_t type_probs_size;
+  uint32_t sub_type_probs_begin;
+  uint32_t sub_type_probs_size;
+
+  double center[3];
+  double anchor_point[3];
+  float direction[3];
+  float theta;
+  float theta_variance;
+  float size[3];
+  float size_variance[3];
+  float confidence;
+  float velocity[3];
+  float center_uncertainty[9];    // column major
+  float velocity_uncertainty[9];  // column major
+};
+
+/**
+ * @brief Bytes SerializeFlatFrame writes for message
+ */
+size_t FlatFrameSize(const SensorFrameMessage& message);
+
+/**
+ * @brief Write message into data, which holds at least FlatFrameSize bytes
+ *        and is 8 byte aligned
+ * @return the number of bytes written, 0 if capacity is too small
+ */
+size_t SerializeFlatFrame(const SensorFrameMessage& message, void* data,
+                          size_t capacity);
+bool SerializeFlatFrame(const SensorFrameMessage& message,
+                        std::vector<uint8_t>* buffer);
+
+/**
+ * @class FlatFrameView
+ * @brief Read only access to a flat frame without copying it
+ *
+ * Init checks the header and that every section lies inside the buffer, the
+ * accessors do not check again. The view does not own the buffer.
+ */
+class FlatFrameView {
+ public:
+  FlatFrameView() = default;
+
+  bool Init(const void* data, size_t size);
+  // true after a successful Init, the accessors need it
+  bool initialized() const { return header_ != nullptr; }
+
+  const FlatFrameHeader& header() const { return *header_; }
+  size_t object_count() const { return header_->object_count; }
+  const FlatObject& object(size_t index) const { return objects_[index]; }
+  const FlatPoint* polygon(const FlatObject& object) const {
+    return polygon_ + object.polygon_begin;
+  }
+  const float* type_probs(const FlatObject& object) const {
+    return probs_ + object.type_probs_begin;
+  }
+  const float* sub_type_probs(const FlatObject& object) const {
+    return probs_ + object.sub_type_probs_begin;
+  }
+  std::string sensor_id() const {
+    return std::string(strings_ + header_->sensor_id_offset,
+                       header_->sensor_id_size);
+  }
+
+ private:
+  const FlatFrameHeader* header_ = nullptr;
+  const FlatObject* objects_ = nullptr;
+  const FlatPoint* polygon_ = nullptr;
+  const float* probs_ = nullptr;
+  const char* strings_ = nullptr;
+};
+
+/**
+ * @brief Rebuild a SensorFrameMessage with a new frame_ from a flat frame
+ * @return false if view is not initialized
+ */
+bool DeserializeFlatFrame(const FlatFrameView& view,
+                          SensorFrameMessage* message);
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,195 @@
+// Size and cost of a flat frame against the same objects as protobuf
+// PerceptionObstacles, the message that crosses process boundaries today.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/benchmark/benchmark_util.h"
+#include "modules/common_msgs/perception_msgs/perception_obstacle.pb.h"
+#include "modules/perception/common/onboard/flat_frame/flat_frame.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+namespace {
+
+using cyber::benchmark::PerfEventCounters;
+
+// range(0) objects with an 8 point polygon and type probabilities
+SensorFrameMessage MakeMessage(size_t object_count) {
+  SensorFrameMessage message;
+  message.sensor_id_ = "radar_front";
+  message.timestamp_ = 1.5;
+  message.seq_num_ = 7;
+  message.frame_ = std::make_shared<base::Frame>();
+  message.frame_->timestamp = 1.5;
+  for (size_t i = 0; i < object_count; ++i) {
+    auto object = std::make_shared<base::Object>();
+    object->id = static_cast<int>(i);
+    object->track_id = static_cast<int>(i);
+    object->type = base::ObjectType::VEHICLE;
+    object->center << 10.0 + i, -2.0, 0.5;
+    object->anchor_point = object->center;
+    object->theta = 0.1f;
+    object->size << 4.5f, 1.8f, 1.5f;
+    object->velocity << 5.0f, 0.5f, 0.0f;
+    object->confidence = 0.9f;
+    object->center_uncertainty.setIdentity();
+    object->velocity_uncertainty.setIdentity();
+    object->polygon.resize(8);
+    for (size_t k = 0; k < object->polygon.size(); ++k) {
+      object->polygon[k].x = 10.0 + i + 0.5 * k;
+      object->polygon[k].y = -2.0 + 0.25 * k;
+      object->polygon[k].z = 0.0;
+    }
+    object->type_probs.assign(
+        static_cast<size_t>(base::ObjectType::MAX_OBJECT_TYPE), 0.1f);
+    message.frame_->objects.push_back(object);
+  }
+  return message;
+}
+
+void FillObstacle(const base::Object& object, double timestamp,
+                  PerceptionObstacle* obstacle) {
+  obstacle->set_id(object.track_id);
+  obstacle->set_timestamp(timestamp);
+  obstacle->mutable_position()->set_x(object.center.x());
+  obstacle->mutable_position()->set_y(object.center.y());
+  obstacle->mutable_position()->set_z(object.center.z());
+  obstacle->mutable_anchor_point()->set_x(object.anchor_point.x());
+  obstacle->mutable_anchor_point()->set_y(object.anchor_point.y());
+  obstacle->mutable_anchor_point()->set_z(object.anchor_point.z());
+  obstacle->set_theta(object.theta);
+  obstacle->mutable_velocity()->set_x(object.velocity.x());
+  obstacle->mutable_velocity()->set_y(object.velocity.y());
+  obstacle->mutable_velocity()->set_z(object.velocity.z());
+  obstacle->set_length(object.size.x());
+  obstacle->set_width(object.size.y());
+  obstacle->set_height(object.size.z());
+  obstacle->set_type(PerceptionObstacle::VEHICLE);
+  for (size_t k = 0; k < object.polygon.size(); ++k) {
+    auto* point = obstacle->add_polygon_point();
+    point->set_x(object.polygon[k].x);
+    point->set_y(object.polygon[k].y);
+    point->set_z(object.polygon[k].z);
+  }
+  for (int i = 0; i < 9; ++i) {
+    obstacle->add_position_covariance(object.center_uncertainty.data()[i]);
+    obstacle->add_velocity_covariance(object.velocity_uncertainty.data()[i]);
+  }
+}
+
+void FillObject(const PerceptionObstacle& obstacle, base::Object* object) {
+  object->track_id = obstacle.id();
+  object->center << obstacle.position().x(), obstacle.position().y(),
+      obstacle.position().z();
+  object->anchor_point << obstacle.anchor_point().x(),
+      obstacle.anchor_point().y(), obstacle.anchor_point().z();
+  object->theta = static_cast<float>(obstacle.theta());
+  object->velocity << static_cast<float>(obstacle.velocity().x()),
+      static_cast<float>(obstacle.velocity().y()),
+      static_cast<float>(obstacle.velocity().z());
+  object->size << static_cast<float>(obstacle.length()),
+      static_cast<float>(obstacle.width()),
+      static_cast<float>(obstacle.height());
+  object->type = base::ObjectType::VEHICLE;
+  object->polygon.resize(obstacle.polygon_point_size());
+  for (int k = 0; k < obstacle.polygon_point_size(); ++k) {
+    object->polygon[k].x = obstacle.polygon_point(k).x();
+    object->polygon[k].y = obstacle.polygon_point(k).y();
+    object->polygon[k].z = obstacle.polygon_point(k).z();
+  }
+  for (int i = 0; i < obstacle.position_covariance_size() && i < 9; ++i) {
+    object->center_uncertainty.data()[i] =
+        static_cast<float>(obstacle.position_covariance(i));
+  }
+  for (int i = 0; i < obstacle.velocity_covariance_size() && i < 9; ++i) {
+    object->velocity_uncertainty.data()[i] =
+        static_cast<float>(obstacle.velocity_covariance(i));
+  }
+}
+
+void BM_FlatFrameSerialize(::benchmark::State& state) {
+  const auto message = MakeMessage(static_cast<size_t>(state.range(0)));
+  std::vector<uint8_t> buffer;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    SerializeFlatFrame(message, &buffer);
+    ::benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["message_bytes"] = static_cast<double>(buffer.size());
+}
+
+// rebuilds the objects, reading the view in place costs only Init
+void BM_FlatFrameDeserialize(::benchmark::State& state) {
+  const auto message = MakeMessage(static_cast<size_t>(state.range(0)));
+  std::vector<uint8_t> buffer;
+  SerializeFlatFrame(message, &buffer);
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    FlatFrameView view;
+    view.Init(buffer.data(), buffer.size());
+    SensorFrameMessage result;
+    DeserializeFlatFrame(view, &result);
+    ::benchmark::DoNotOptimize(result.frame_.get());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["message_bytes"] = static_cast<double>(buffer.size());
+}
+
+void BM_ProtoSerialize(::benchmark::State& state) {
+  const auto message = MakeMessage(static_cast<size_t>(state.range(0)));
+  PerceptionObstacles obstacles;
+  std::string data;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    obstacles.Clear();
+    for (const auto& object : message.frame_->objects) {
+      FillObstacle(*object, message.timestamp_,
+                   obstacles.add_perception_obstacle());
+    }
+    obstacles.SerializeToString(&data);
+    ::benchmark::DoNotOptimize(data.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["message_bytes"] = static_cast<double>(data.size());
+}
+
+void BM_ProtoParse(::benchmark::State& state) {
+  const auto message = MakeMessage(static_cast<size_t>(state.range(0)));
+  PerceptionObstacles obstacles;
+  for (const auto& object : message.frame_->objects) {
+    FillObstacle(*object, message.timestamp_,
+                 obstacles.add_perception_obstacle());
+  }
+  const std::string data = obstacles.SerializeAsString();
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    PerceptionObstacles parsed;
+    parsed.ParseFromString(data);
+    auto frame = std::make_shared<base::Frame>();
+    frame->objects.reserve(parsed.perception_obstacle_size());
+    for (const auto& obstacle : parsed.perception_obstacle()) {
+      auto object = std::make_shared<base::Object>();
+      FillObject(obstacle, object.get());
+      frame->objects.push_back(object);
+    }
+    ::benchmark::DoNotOptimize(frame.get());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["message_bytes"] = static_cast<double>(data.size());
+}
+
+BENCHMARK(BM_FlatFrameSerialize)->ArgName("objects")->Range(8, 512);
+BENCHMARK(BM_FlatFrameDeserialize)->ArgName("objects")->Range(8, 512);
+BENCHMARK(BM_ProtoSerialize)->ArgName("objects")->Range(8, 512);
+BENCHMARK(BM_ProtoParse)->ArgName("objects")->Range(8, 512);
+
+}  // namespace
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
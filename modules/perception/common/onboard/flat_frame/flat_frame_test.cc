@@ -0,0 +1,209 @@
+#include "modules/perception/common/onboard/flat_frame/flat_frame.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+namespace {
+
+SensorFrameMessage MakeMessage(size_t object_count) {
+  SensorFrameMessage message;
+  message.sensor_id_ = "radar_front";
+  message.sensor_index_ = 3;
+  message.timestamp_ = 1.5;
+  message.lidar_timestamp_ = 1500000000;
+  message.seq_num_ = 7;
+  message.process_stage_ = ProcessStage::LONG_RANGE_RADAR_DETECTION;
+  message.stage_stamps_[static_cast<size_t>(
+      ProcessStage::LONG_RANGE_RADAR_DETECTION)] = {100, 250};
+  message.stage_stamps_[static_cast<size_t>(ProcessStage::SENSOR_FUSION)] = {
+      300, 0};
+
+  message.frame_ = std::make_shared<base::Frame>();
+  message.frame_->timestamp = 1.25;
+  message.frame_->sensor_info.type = base::SensorType::LONG_RANGE_RADAR;
+  message.frame_->sensor2world_pose.setIdentity();
+  message.frame_->sensor2world_pose.translation() << 1.0, 2.0, 3.0;
+  for (size_t i = 0; i < object_count; ++i) {
+    auto object = std::make_shared<base::Object>();
+    object->id = static_cast<int>(i);
+    object->track_id = static_cast<int>(100 + i);
+    object->type = base::ObjectType::VEHICLE;
+    object->center << 10.0 + i, -2.0, 0.5;
+    object->anchor_point = object->center;
+    object->direction << 1.0f, 0.0f, 0.0f;
+    object->theta = 0.1f * i;
+    object->size << 4.5f, 1.8f, 1.5f;
+    object->velocity << 5.0f, 0.5f, 0.0f;
+    object->confidence = 0.9f;
+    object->center_uncertainty.setIdentity();
+    object->center_uncertainty(0, 1) = 0.25f;
+    object->velocity_uncertainty.setZero();
+    // objects without polygon or probs are in there too
+    object->polygon.resize(i % 5);
+    for (size_t k = 0; k < object->polygon.size(); ++k) {
+      object->polygon[k].x = 10.0 + k;
+      object->polygon[k].y = -2.0 - k;
+      object->polygon[k].z = 0.0;
+    }
+    object->type_probs.assign(i % 3, 0.5f);
+    object->sub_type_probs.assign(i % 4, 0.25f);
+    message.frame_->objects.push_back(object);
+  }
+  return message;
+}
+
+}  // namespace
+
+TEST(FlatFrameTest, RoundTrip) {
+  const SensorFrameMessage message = MakeMessage(7);
+  std::vector<uint8_t> buffer;
+  ASSERT_TRUE(SerializeFlatFrame(message, &buffer));
+  EXPECT_EQ(FlatFrameSize(message), buffer.size());
+
+  FlatFrameView view;
+  ASSERT_TRUE(view.Init(buffer.data(), buffer.size()));
+  EXPECT_EQ("radar_front", view.sensor_id());
+  EXPECT_EQ(7, view.object_count());
+
+  SensorFrameMessage result;
+  ASSERT_TRUE(DeserializeFlatFrame(view, &result));
+  EXPECT_EQ(message.sensor_id_, result.sensor_id_);
+  EXPECT_EQ(message.sensor_index_, result.sensor_index_);
+  EXPECT_EQ(message.timestamp_, result.timestamp_);
+  EXPECT_EQ(message.lidar_timestamp_, result.lidar_timestamp_);
+  EXPECT_EQ(message.seq_num_, result.seq_num_);
+  EXPECT_EQ(message.process_stage_, result.process_stage_);
+  for (size_t i = 0; i < kProcessStageCount; ++i) {
+    EXPECT_EQ(message.stage_stamps_[i].enter_ns,
+              result.stage_stamps_[i].enter_ns);
+    EXPECT_EQ(message.stage_stamps_[i].exit_ns,
+              result.stage_stamps_[i].exit_ns);
+  }
+
+  ASSERT_NE(nullptr, result.frame_);
+  const base::Frame& frame = *result.frame_;
+  EXPECT_EQ(message.frame_->timestamp, frame.timestamp);
+  EXPECT_EQ(base::SensorType::LONG_RANGE_RADAR, frame.sensor_info.type);
+  EXPECT_TRUE(
+      frame.sensor2world_pose.isApprox(message.frame_->sensor2world_pose));
+  ASSERT_EQ(message.frame_->objects.size(), frame.objects.size());
+  for (size_t i = 0; i < frame.objects.size(); ++i) {
+    const base::Object& expected = *message.frame_->objects[i];
+    const base::Object& actual = *frame.objects[i];
+    EXPECT_EQ(expected.id, actual.id);
+    EXPECT_EQ(expected.track_id, actual.track_id);
+    EXPECT_EQ(expected.type, actual.type);
+    EXPECT_EQ(expected.center, actual.center);
+    EXPECT_EQ(expected.direction, actual.direction);
+    EXPECT_EQ(expected.theta, actual.theta);
+    EXPECT_EQ(expected.size, actual.size);
+    EXPECT_EQ(expected.velocity, actual.velocity);
+    EXPECT_EQ(expected.confidence, actual.confidence);
+    EXPECT_EQ(expected.center_uncertainty, actual.center_uncertainty);
+    EXPECT_EQ(expected.velocity_uncertainty, actual.velocity_uncertainty);
+    ASSERT_EQ(expected.polygon.size(), actual.polygon.size());
+    for (size_t k = 0; k < actual.polygon.size(); ++k) {
+      EXPECT_EQ(expected.polygon[k].x, actual.polygon[k].x);
+      EXPECT_EQ(expected.polygon[k].y, actual.polygon[k].y);
+    }
+    EXPECT_EQ(expected.type_probs, actual.type_probs);
+    EXPECT_EQ(expected.sub_type_probs, actual.sub_type_probs);
+  }
+}
+
+TEST(FlatFrameTest, RoundTripWithoutFrame) {
+  SensorFrameMessage message = MakeMessage(0);
+  message.frame_ = nullptr;
+  std::vector<uint8_t> buffer;
+  ASSERT_TRUE(SerializeFlatFrame(message, &buffer));
+
+  FlatFrameView view;
+  ASSERT_TRUE(view.Init(buffer.data(), buffer.size()));
+  SensorFrameMessage result;
+  ASSERT_TRUE(DeserializeFlatFrame(view, &result));
+  EXPECT_EQ(message.seq_num_, result.seq_num_);
+  ASSERT_NE(nullptr, result.frame_);
+  EXPECT_TRUE(result.frame_->objects.empty());
+}
+
+// the buffer may be copied anywhere, e.g. into shared memory
+TEST(FlatFrameTest, Relocatable) {
+  const SensorFrameMessage message = MakeMessage(3);
+  std::vector<uint8_t> buffer;
+  ASSERT_TRUE(SerializeFlatFrame(message, &buffer));
+  std::vector<uint64_t> copy(buffer.size() / sizeof(uint64_t));
+  std::memcpy(copy.data(), buffer.data(), buffer.size());
+  buffer.assign(buffer.size(), 0);
+
+  FlatFrameView view;
+  ASSERT_TRUE(view.Init(copy.data(), buffer.size()));
+  ASSERT_EQ(3, view.object_count());
+  const FlatObject& object = view.object(2);
+  EXPECT_EQ(2, object.polygon_size);
+  EXPECT_EQ(11.0, view.polygon(object)[1].x);
+}
+
+TEST(FlatFrameTest, RejectsBadBuffers) {
+  const SensorFrameMessage message = MakeMessage(3);
+  std::vector<uint8_t> buffer;
+  ASSERT_TRUE(SerializeFlatFrame(message, &buffer));
+  FlatFrameView view;
+
+  EXPECT_FALSE(view.Init(nullptr, buffer.size()));
+  EXPECT_FALSE(view.Init(buffer.data(), sizeof(FlatFrameHeader) - 1));
+  EXPECT_FALSE(view.Init(buffer.data(), buffer.size() - 8));
+  EXPECT_FALSE(view.Init(buffer.data() + 1, buffer.size() - 1));
+
+  std::vector<uint8_t> corrupt = buffer;
+  reinterpret_cast<FlatFrameHeader*>(corrupt.data())->magic = 0;
+  EXPECT_FALSE(view.Init(corrupt.data(), corrupt.size()));
+
+  corrupt = buffer;
+  reinterpret_cast<FlatFrameHeader*>(corrupt.data())->version =
+      kFlatFrameVersion + 1;
+  EXPECT_FALSE(view.Init(corrupt.data(), corrupt.size()));
+
+  corrupt = buffer;
+  reinterpret_cast<FlatFrameHeader*>(corrupt.data())->object_count = 1000;
+  EXPECT_FALSE(view.Init(corrupt.data(), corrupt.size()));
+
+  corrupt = buffer;
+  auto* header = reinterpret_cast<FlatFrameHeader*>(corrupt.data());
+  reinterpret_cast<FlatObject*>(corrupt.data() + header->objects_offset)[1]
+      .polygon_size = 1000;
+  EXPECT_FALSE(view.Init(corrupt.data(), corrupt.size()));
+
+  // a failed Init leaves the view unusable
+  EXPECT_FALSE(view.initialized());
+  SensorFrameMessage result;
+  EXPECT_FALSE(DeserializeFlatFrame(view, &result));
+}
+
+TEST(FlatFrameTest, DeserializeNeedsInit) {
+  FlatFrameView view;
+  SensorFrameMessage result;
+  EXPECT_FALSE(view.initialized());
+  EXPECT_FALSE(DeserializeFlatFrame(view, &result));
+  EXPECT_EQ(nullptr, result.frame_);
+}
+
+TEST(FlatFrameTest, SerializeNeedsCapacity) {
+  const SensorFrameMessage message = MakeMessage(3);
+  std::vector<uint64_t> buffer(FlatFrameSize(message) / sizeof(uint64_t));
+  EXPECT_EQ(0, SerializeFlatFrame(message, buffer.data(),
+                                  buffer.size() * sizeof(uint64_t) - 8));
+  EXPECT_EQ(FlatFrameSize(message),
+            SerializeFlatFrame(message, buffer.data(),
+                               buffer.size() * sizeof(uint64_t)));
+}
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
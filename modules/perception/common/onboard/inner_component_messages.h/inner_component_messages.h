@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 
 #include "cyber/cyber.h"
@@ -26,10 +28,19 @@ enum class ProcessStage {
   PROCESSSTAGE_COUNT = 10
 };
 
+constexpr size_t kProcessStageCount =
+    static_cast<size_t>(ProcessStage::PROCESSSTAGE_COUNT);
+
+// monotonic nanoseconds, 0 means the stage was not entered
+struct StageStamp {
+  uint64_t enter_ns = 0;
+  uint64_t exit_ns = 0;
+};
+
 class Descriptor {
  public:
   std::string full_name() { return "name"; }
-}
+};
 
 class SensorFrameMessage {
  public:
@@ -45,6 +56,8 @@ class SensorFrameMessage {
    apollo::common::ErrorCode error_code_ = apollo::common::ErrorCode::OK;
 
    std::string sensor_id_;
+   // id of sensor_id_ in algorithm::SensorRegistry, dispatch by this one
+   base::SensorId sensor_index_ = base::kInvalidSensorId;
    double timestamp_ = 0.0;
    uint64_t lidar_timestamp_ = 0;
    uint32_t seq_num_ = 0;
@@ -54,6 +67,8 @@ class SensorFrameMessage {
    base::FramePtr frame_;
 
    ProcessStage process_stage_ = ProcessStage::UNKNOWN_STAGE;
+   // written by onboard::LatencyTracer, indexed by ProcessStage
+   std::array<StageStamp, kProcessStageCount> stage_stamps_;
 };
 
 }
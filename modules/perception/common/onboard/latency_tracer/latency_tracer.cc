@@ -0,0 +1,332 @@
+#include "modules/perception/common/onboard/latency_tracer/latency_tracer.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+DEFINE_bool(enable_latency_trace, false,
+            "record per stage latency of perception frames");
+DEFINE_string(latency_trace_file, "/tmp/perception_latency_trace.json",
+              "Chrome trace file written at shutdown, empty to skip");
+DEFINE_int32(latency_trace_events_per_thread, 16384,
+             "spans kept per thread for the Chrome trace, oldest dropped");
+
+namespace {
+
+using algorithm::SensorRegistry;
+
+// the last row collects sensors without a registered id
+constexpr size_t kSensorRowNum = SensorRegistry::kMaxSensorNum + 1;
+// buckets, then count, sum and max
+constexpr size_t kCellsPerHistogram = LatencyHistogram::kBucketNum + 3;
+constexpr size_t kCountCell = LatencyHistogram::kBucketNum;
+constexpr size_t kSumCell = LatencyHistogram::kBucketNum + 1;
+constexpr size_t kMaxCell = LatencyHistogram::kBucketNum + 2;
+
+const char* const kProcessStageNames[kProcessStageCount] = {
+    "LIDAR_PREPROCESS",
+    "LIDAR_DETECTION",
+    "LIDAR_RECOGNITION",
+    "STEREO_CAMERA_DETECTION",
+    "MONOCULAR_CAMERA_DETECTION",
+    "LONG_RANGE_RADAR_DETECTION",
+    "SHORT_RANGE_RADAR_DETECTION",
+    "ULTRASONIC_DETECTION",
+    "SENSOR_FUSION",
+    "UNKNOWN_STAGE",
+};
+
+size_t SensorRow(base::SensorId sensor_id) {
+  return sensor_id < SensorRegistry::kMaxSensorNum
+             ? sensor_id
+             : SensorRegistry::kMaxSensorNum;
+}
+
+size_t HistogramOffset(size_t sensor_row, size_t stage) {
+  return (sensor_row * kProcessStageCount + stage) * kCellsPerHistogram;
+}
+
+size_t BucketIndex(uint64_t latency_us) {
+  if (latency_us < 2) {
+    return 0;
+  }
+  const size_t log2 = 63 - __builtin_clzll(latency_us);
+  return std::min(log2, LatencyHistogram::kBucketNum - 1);
+}
+
+size_t RoundUpPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+uint64_t NextGeneration() {
+  static std::atomic<uint64_t> generation{0};
+  return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// only the owning thread writes a cell, so a plain load and store suffices
+void AddRelaxed(std::atomic<uint64_t>* cell, uint64_t value) {
+  cell->store(cell->load(std::memory_order_relaxed) + value,
+              std::memory_order_relaxed);
+}
+
+}  // namespace
+
+uint64_t LatencyHistogram::PercentileUs(double percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+  const uint64_t target = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percentile * count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketNum; ++i) {
+    seen += buckets[i];
+    if (seen >= target) {
+      return std::min<uint64_t>(uint64_t(2) << i, max_us);
+    }
+  }
+  return max_us;
+}
+
+// a seqlock slot, seq is the event index + 1 once the slot is complete
+struct LatencyTracer::TraceEvent {
+  std::atomic<uint64_t> seq{0};
+  std::atomic<uint64_t> enter_ns{0};
+  std::atomic<uint64_t> exit_ns{0};
+  std::atomic<uint32_t> seq_num{0};
+  std::atomic<uint16_t> sensor_id{0};
+  std::atomic<uint16_t> stage{0};
+};
+
+struct LatencyTracer::ThreadBuffer {
+  ThreadBuffer(uint32_t id, size_t event_capacity)
+      : thread_id(id),
+        histograms(new std::atomic<uint64_t>[kSensorRowNum *
+                                             kProcessStageCount *
+                                             kCellsPerHistogram]),
+        capacity(RoundUpPowerOfTwo(event_capacity)),
+        events(new TraceEvent[capacity]) {
+    for (size_t i = 0;
+         i < kSensorRowNum * kProcessStageCount * kCellsPerHistogram; ++i) {
+      histograms[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const uint32_t thread_id;
+  std::unique_ptr<std::atomic<uint64_t>[]> histograms;
+  const size_t capacity;
+  std::unique_ptr<TraceEvent[]> events;
+  std::atomic<uint64_t> event_count{0};
+};
+
+LatencyTracer::LatencyTracer()
+    : generation_(NextGeneration()) {}
+
+LatencyTracer::~LatencyTracer() = default;
+
+uint64_t LatencyTracer::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void LatencyTracer::Enter(SensorFrameMessage* message, ProcessStage stage) {
+  const size_t index = static_cast<size_t>(stage);
+  if (!FLAGS_enable_latency_trace || message == nullptr ||
+      index >= kProcessStageCount) {
+    return;
+  }
+  StageStamp& stamp = message->stage_stamps_[index];
+  stamp.enter_ns = NowNs();
+  stamp.exit_ns = 0;
+}
+
+void LatencyTracer::Exit(SensorFrameMessage* message, ProcessStage stage) {
+  const size_t index = static_cast<size_t>(stage);
+  if (!FLAGS_enable_latency_trace || message == nullptr ||
+      index >= kProcessStageCount) {
+    return;
+  }
+  StageStamp& stamp = message->stage_stamps_[index];
+  stamp.exit_ns = NowNs();
+  if (stamp.enter_ns == 0 || stamp.exit_ns < stamp.enter_ns) {
+    return;
+  }
+  Record(message->sensor_index_, stage, message->seq_num_, stamp.enter_ns,
+         stamp.exit_ns);
+}
+
+LatencyTracer::ThreadBuffer* LatencyTracer::GetThreadBuffer() {
+  // the buffer belongs to the instance of `generation`, one that was Reset
+  // since has deleted it
+  thread_local uint64_t generation = 0;
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (generation != generation_) {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.emplace_back(new ThreadBuffer(
+        static_cast<uint32_t>(buffers_.size()),
+        std::max(1, FLAGS_latency_trace_events_per_thread)));
+    buffer = buffers_.back().get();
+    generation = generation_;
+  }
+  return buffer;
+}
+
+void LatencyTracer::Record(base::SensorId sensor_id, ProcessStage stage,
+                           uint32_t seq_num, uint64_t enter_ns,
+                           uint64_t exit_ns) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  const uint64_t latency_us = (exit_ns - enter_ns) / 1000;
+
+  std::atomic<uint64_t>* histogram =
+      &buffer->histograms[HistogramOffset(SensorRow(sensor_id),
+                                          static_cast<size_t>(stage))];
+  AddRelaxed(&histogram[BucketIndex(latency_us)], 1);
+  AddRelaxed(&histogram[kCountCell], 1);
+  AddRelaxed(&histogram[kSumCell], latency_us);
+  if (latency_us > histogram[kMaxCell].load(std::memory_order_relaxed)) {
+    histogram[kMaxCell].store(latency_us, std::memory_order_relaxed);
+  }
+
+  const uint64_t index = buffer->event_count.load(std::memory_order_relaxed);
+  TraceEvent& event = buffer->events[index & (buffer->capacity - 1)];
+  event.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.enter_ns.store(enter_ns, std::memory_order_relaxed);
+  event.exit_ns.store(exit_ns, std::memory_order_relaxed);
+  event.seq_num.store(seq_num, std::memory_order_relaxed);
+  event.sensor_id.store(sensor_id, std::memory_order_relaxed);
+  event.stage.store(static_cast<uint16_t>(stage), std::memory_order_relaxed);
+  event.seq.store(index + 1, std::memory_order_release);
+  buffer->event_count.store(index + 1, std::memory_order_release);
+}
+
+LatencyHistogram LatencyTracer::GetHistogram(base::SensorId sensor_id,
+                                             ProcessStage stage) const {
+  LatencyHistogram result;
+  const size_t index = static_cast<size_t>(stage);
+  if (index >= kProcessStageCount) {
+    return result;
+  }
+  const size_t offset = HistogramOffset(SensorRow(sensor_id), index);
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (const auto& buffer : buffers_) {
+    const std::atomic<uint64_t>* histogram = &buffer->histograms[offset];
+    for (size_t i = 0; i < LatencyHistogram::kBucketNum; ++i) {
+      result.buckets[i] += histogram[i].load(std::memory_order_relaxed);
+    }
+    result.count += histogram[kCountCell].load(std::memory_order_relaxed);
+    result.sum_us += histogram[kSumCell].load(std::memory_order_relaxed);
+    result.max_us = std::max(
+        result.max_us, histogram[kMaxCell].load(std::memory_order_relaxed));
+  }
+  return result;
+}
+
+std::string LatencyTracer::Summary() const {
+  const auto* registry = SensorRegistry::Instance();
+  std::ostringstream out;
+  for (size_t row = 0; row < kSensorRowNum; ++row) {
+    const base::SensorId sensor_id = row < SensorRegistry::kMaxSensorNum
+                                         ? static_cast<base::SensorId>(row)
+                                         : base::kInvalidSensorId;
+    for (size_t stage = 0; stage < kProcessStageCount; ++stage) {
+      const LatencyHistogram histogram =
+          GetHistogram(sensor_id, static_cast<ProcessStage>(stage));
+      if (histogram.count == 0) {
+        continue;
+      }
+      const std::string& name = registry->GetSensorName(sensor_id);
+      out << (name.empty() ? "unknown_sensor" : name) << " "
+          << kProcessStageNames[stage] << " count: " << histogram.count
+          << " mean_us: " << histogram.MeanUs()
+          << " p50_us: " << histogram.PercentileUs(0.5)
+          << " p99_us: " << histogram.PercentileUs(0.99)
+          << " max_us: " << histogram.max_us << "\n";
+    }
+  }
+  return out.str();
+}
+
+bool LatencyTracer::ExportChromeTrace(const std::string& file_path) const {
+  std::ofstream out(file_path);
+  if (!out.is_open()) {
+    AERROR << "Failed to open latency trace file " << file_path;
+    return false;
+  }
+  const auto* registry = SensorRegistry::Instance();
+  const int pid = static_cast<int>(getpid());
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first = true;
+  size_t exported = 0;
+
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (const auto& buffer : buffers_) {
+    const uint64_t count = buffer->event_count.load(std::memory_order_acquire);
+    const uint64_t begin =
+        count > buffer->capacity ? count - buffer->capacity : 0;
+    for (uint64_t index = begin; index < count; ++index) {
+      const TraceEvent& event = buffer->events[index & (buffer->capacity - 1)];
+      const uint64_t seq = event.seq.load(std::memory_order_acquire);
+      const uint64_t enter_ns = event.enter_ns.load(std::memory_order_relaxed);
+      const uint64_t exit_ns = event.exit_ns.load(std::memory_order_relaxed);
+      const uint32_t seq_num = event.seq_num.load(std::memory_order_relaxed);
+      const base::SensorId sensor_id =
+          event.sensor_id.load(std::memory_order_relaxed);
+      const uint16_t stage = event.stage.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // overwritten by the owning thread while we were reading
+      if (seq != index + 1 ||
+          event.seq.load(std::memory_order_relaxed) != seq ||
+          stage >= kProcessStageCount) {
+        continue;
+      }
+      const std::string& name = registry->GetSensorName(sensor_id);
+      out << (first ? "" : ",") << "\n{\"name\":\""
+          << kProcessStageNames[stage] << "\",\"cat\":\""
+          << (name.empty() ? "unknown_sensor" : name)
+          << "\",\"ph\":\"X\",\"ts\":" << enter_ns / 1e3
+          << ",\"dur\":" << (exit_ns - enter_ns) / 1e3 << ",\"pid\":" << pid
+          << ",\"tid\":" << buffer->thread_id
+          << ",\"args\":{\"seq_num\":" << seq_num << "}}";
+      first = false;
+      ++exported;
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  out.close();
+  if (!out) {
+    AERROR << "Failed to write latency trace file " << file_path;
+    return false;
+  }
+  AINFO << "Export " << exported << " latency spans to " << file_path;
+  return true;
+}
+
+void LatencyTracer::Shutdown() {
+  if (!FLAGS_enable_latency_trace) {
+    return;
+  }
+  AINFO << "Perception stage latency:\n" << Summary();
+  if (!FLAGS_latency_trace_file.empty()) {
+    ExportChromeTrace(FLAGS_latency_trace_file);
+  }
+}
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "cyber/common/macros.h"
+#include "modules/perception/common/algorithm/sensor_manager/sensor_registry.h"
+#include "modules/perception/common/onboard/inner_component_messages.h/inner_component_messages.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+DECLARE_bool(enable_latency_trace);
+DECLARE_string(latency_trace_file);
+DECLARE_int32(latency_trace_events_per_thread);
+
+/**
+ * @brief Latency distribution of one (sensor, stage), bucket i counts
+ *        latencies in [2^i, 2^(i+1)) microseconds, bucket 0 also holds < 1us
+ */
+struct LatencyHistogram {
+  static constexpr size_t kBucketNum = 24;
+
+  std::array<uint64_t, kBucketNum> buckets{};
+  uint64_t count = 0;
+  uint64_t sum_us = 0;
+  uint64_t max_us = 0;
+
+  double MeanUs() const {
+    return count == 0 ? 0.0 : static_cast<double>(sum_us) / count;
+  }
+  // upper bound of the bucket that holds the percentile, percentile in [0, 1]
+  uint64_t PercentileUs(double percentile) const;
+};
+
+/**
+ * @class LatencyTracer
+ * @brief Records when a SensorFrameMessage enters and leaves each
+ *        ProcessStage
+ *
+ * Enter and Exit stamp the message with a monotonic clock. Exit also adds
+ * the latency to a histogram per (sensor, stage) and keeps the span for the
+ * Chrome trace export. Both live in a buffer owned by the calling thread,
+ * the only shared write is registering that buffer the first time a thread
+ * traces. Readers sum the buffers of all threads.
+ *
+ * Everything is a no-op unless --enable_latency_trace is set.
+ */
+class LatencyTracer {
+ public:
+  // out of line, ThreadBuffer is only complete in the .cc
+  ~LatencyTracer();
+
+  static uint64_t NowNs();
+
+  void Enter(SensorFrameMessage* message, ProcessStage stage);
+  void Exit(SensorFrameMessage* message, ProcessStage stage);
+
+  // histogram summed over all threads
+  LatencyHistogram GetHistogram(base::SensorId sensor_id,
+                                ProcessStage stage) const;
+  // one line per (sensor, stage) with samples
+  std::string Summary() const;
+
+  /**
+   * @brief Write the recorded spans as Chrome trace events, readable by
+   *        chrome://tracing and Perfetto
+   */
+  bool ExportChromeTrace(const std::string& file_path) const;
+
+  // exports to --latency_trace_file, called by CleanUp
+  void Shutdown();
+
+ private:
+  struct TraceEvent;
+  struct ThreadBuffer;
+
+  ThreadBuffer* GetThreadBuffer();
+  void Record(base::SensorId sensor_id, ProcessStage stage, uint32_t seq_num,
+              uint64_t enter_ns, uint64_t exit_ns);
+
+  // threads cache their buffer per generation, an instance created after a
+  // Reset may sit at the address of the deleted one
+  const uint64_t generation_;
+  mutable std::mutex buffers_mutex_;
+  // buffers outlive their threads so late exports still see their samples
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+
+  DECLARE_SINGLETON(LatencyTracer)
+};
+
+/**
+ * @brief Enter on construction and Exit on destruction
+ */
+class ScopedStageTrace {
+ public:
+  ScopedStageTrace(SensorFrameMessage* message, ProcessStage stage)
+      : message_(message), stage_(stage) {
+    if (FLAGS_enable_latency_trace && message_ != nullptr) {
+      LatencyTracer::Instance()->Enter(message_, stage_);
+    }
+  }
+  ~ScopedStageTrace() {
+    if (FLAGS_enable_latency_trace && message_ != nullptr) {
+      LatencyTracer::Instance()->Exit(message_, stage_);
+    }
+  }
+
+ private:
+  SensorFrameMessage* message_;
+  ProcessStage stage_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedStageTrace);
+};
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,86 @@
+#include "modules/perception/common/onboard/latency_tracer/latency_tracer.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+namespace {
+
+void Trace(SensorFrameMessage* message, ProcessStage stage) {
+  ScopedStageTrace trace(message, stage);
+}
+
+}  // namespace
+
+class LatencyTracerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FLAGS_enable_latency_trace = true;
+    FLAGS_latency_trace_file = "";
+    LatencyTracer::Reset();
+  }
+  void TearDown() override {
+    LatencyTracer::Reset();
+    FLAGS_enable_latency_trace = false;
+  }
+};
+
+TEST_F(LatencyTracerTest, RecordsPerStage) {
+  SensorFrameMessage message;
+  message.sensor_index_ = 0;
+  Trace(&message, ProcessStage::LONG_RANGE_RADAR_DETECTION);
+  Trace(&message, ProcessStage::LONG_RANGE_RADAR_DETECTION);
+  Trace(&message, ProcessStage::SENSOR_FUSION);
+
+  auto* tracer = LatencyTracer::Instance();
+  EXPECT_EQ(
+      tracer->GetHistogram(0, ProcessStage::LONG_RANGE_RADAR_DETECTION).count,
+      2);
+  EXPECT_EQ(tracer->GetHistogram(0, ProcessStage::SENSOR_FUSION).count, 1);
+  EXPECT_EQ(tracer->GetHistogram(1, ProcessStage::SENSOR_FUSION).count, 0);
+}
+
+// a thread that traced before a Reset must not write into the deleted
+// instance's buffer afterwards
+TEST_F(LatencyTracerTest, RecordAfterReset) {
+  SensorFrameMessage message;
+  message.sensor_index_ = 0;
+  auto trace_on_thread = [&message] {
+    std::thread thread([&message] {
+      Trace(&message, ProcessStage::SENSOR_FUSION);
+    });
+    thread.join();
+  };
+
+  Trace(&message, ProcessStage::SENSOR_FUSION);
+  trace_on_thread();
+  EXPECT_EQ(LatencyTracer::Instance()
+                ->GetHistogram(0, ProcessStage::SENSOR_FUSION)
+                .count,
+            2);
+
+  LatencyTracer::Reset();
+  Trace(&message, ProcessStage::SENSOR_FUSION);
+  Trace(&message, ProcessStage::SENSOR_FUSION);
+  trace_on_thread();
+  EXPECT_EQ(LatencyTracer::Instance()
+                ->GetHistogram(0, ProcessStage::SENSOR_FUSION)
+                .count,
+            3);
+
+  // again, the new instance may reuse the address of the old one
+  LatencyTracer::Reset();
+  Trace(&message, ProcessStage::SENSOR_FUSION);
+  EXPECT_EQ(LatencyTracer::Instance()
+                ->GetHistogram(0, ProcessStage::SENSOR_FUSION)
+                .count,
+            1);
+}
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
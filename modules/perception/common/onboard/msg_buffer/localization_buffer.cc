@@ -0,0 +1,198 @@
+#include "modules/perception/common/onboard/msg_buffer/localization_buffer.h"
+
+#include <algorithm>
+
+#include "cyber/base/macros.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+namespace {
+// a lookup racing with a full wrap of the ring starts over at most this often
+constexpr int kMaxLookupRetry = 3;
+}  // namespace
+
+LocalizationBuffer::LocalizationBuffer(size_t capacity) {
+  // the slot the next Push overwrites is never read, so one more
+  capacity_ = 1;
+  while (capacity_ < capacity + 1) {
+    capacity_ <<= 1;
+  }
+  slots_.reset(new Slot[capacity_]);
+}
+
+void LocalizationBuffer::Init(const std::string& channel,
+                              const std::string& name) {
+  std::string node_name;
+  int index = static_cast<int>(name.find_last_of('/'));
+  if (index != -1) {
+    node_name = name.substr(index + 1) + "_subscriber";
+  } else {
+    node_name = name + "_subscriber";
+  }
+  node_.reset(apollo::cyber::CreateNode(node_name).release());
+  reader_ = node_->CreateReader<LocalizationEstimate>(
+      channel, [this](const std::shared_ptr<LocalizationEstimate>& msg) {
+        Push(*msg);
+      });
+}
+
+void LocalizationBuffer::Push(const LocalizationEstimate& msg) {
+  LocalizationVelocity velocity;
+  velocity.timestamp = msg.measurement_time();
+  const auto& pose = msg.pose();
+  velocity.linear_velocity << static_cast<float>(pose.linear_velocity().x()),
+      static_cast<float>(pose.linear_velocity().y()),
+      static_cast<float>(pose.linear_velocity().z());
+  velocity.angular_velocity << static_cast<float>(pose.angular_velocity().x()),
+      static_cast<float>(pose.angular_velocity().y()),
+      static_cast<float>(pose.angular_velocity().z());
+  Push(velocity);
+}
+
+void LocalizationBuffer::Push(const LocalizationVelocity& velocity) {
+  const uint64_t index = write_index_.load(std::memory_order_relaxed);
+  if (index > 0 && velocity.timestamp <= last_timestamp_) {
+    AWARN << "Drop localization out of order, timestamp: "
+          << velocity.timestamp << " last: " << last_timestamp_;
+    return;
+  }
+  last_timestamp_ = velocity.timestamp;
+
+  Slot& slot = slots_[index & (capacity_ - 1)];
+  const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+  slot.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.timestamp.store(velocity.timestamp, std::memory_order_relaxed);
+  for (int i = 0; i < 3; ++i) {
+    slot.values[i].store(velocity.linear_velocity[i],
+                         std::memory_order_relaxed);
+    slot.values[i + 3].store(velocity.angular_velocity[i],
+                             std::memory_order_relaxed);
+  }
+  slot.seq.store(seq + 2, std::memory_order_release);
+  write_index_.store(index + 1, std::memory_order_release);
+}
+
+bool LocalizationBuffer::ReadSample(uint64_t index,
+                                    LocalizationVelocity* velocity) const {
+  const Slot& slot = slots_[index & (capacity_ - 1)];
+  while (true) {
+    const uint32_t seq_begin = slot.seq.load(std::memory_order_acquire);
+    if (seq_begin & 1) {
+      cpu_relax();
+      continue;
+    }
+    velocity->timestamp = slot.timestamp.load(std::memory_order_relaxed);
+    for (int i = 0; i < 3; ++i) {
+      velocity->linear_velocity[i] =
+          slot.values[i].load(std::memory_order_relaxed);
+      velocity->angular_velocity[i] =
+          slot.values[i + 3].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq_begin) {
+      break;
+    }
+  }
+  // once write_index_ reaches index + capacity_ the writer may be storing
+  // sample index + capacity_ into this slot, what we read could be either one
+  return write_index_.load(std::memory_order_acquire) < index + capacity_;
+}
+
+bool LocalizationBuffer::LowerBound(double timestamp, uint64_t begin,
+                                    uint64_t end, uint64_t* index) const {
+  LocalizationVelocity velocity;
+  while (begin < end) {
+    const uint64_t mid = begin + (end - begin) / 2;
+    if (!ReadSample(mid, &velocity)) {
+      return false;
+    }
+    if (velocity.timestamp < timestamp) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  *index = begin;
+  return true;
+}
+
+bool LocalizationBuffer::Lookup(double timestamp, bool interpolate,
+                                LocalizationVelocity* velocity) const {
+  if (velocity == nullptr) {
+    AERROR << "velocity is nullptr";
+    return false;
+  }
+  for (int retry = 0; retry < kMaxLookupRetry; ++retry) {
+    const uint64_t end = write_index_.load(std::memory_order_acquire);
+    if (end == 0) {
+      AERROR << "Localization buffer is empty.";
+      return false;
+    }
+    const uint64_t begin = end >= capacity_ ? end - capacity_ + 1 : 0;
+    uint64_t upper = 0;
+    if (!LowerBound(timestamp, begin, end, &upper)) {
+      continue;
+    }
+
+    LocalizationVelocity after;
+    LocalizationVelocity before;
+    if (upper == end) {
+      // newer than every sample
+      if (!ReadSample(end - 1, velocity)) {
+        continue;
+      }
+      return true;
+    }
+    if (!ReadSample(upper, &after)) {
+      continue;
+    }
+    if (upper == begin || after.timestamp == timestamp) {
+      *velocity = after;
+      return true;
+    }
+    if (!ReadSample(upper - 1, &before)) {
+      continue;
+    }
+    if (!interpolate) {
+      *velocity = timestamp - before.timestamp < after.timestamp - timestamp
+                      ? before
+                      : after;
+      return true;
+    }
+    const float ratio = static_cast<float>(
+        (timestamp - before.timestamp) / (after.timestamp - before.timestamp));
+    velocity->timestamp = timestamp;
+    velocity->linear_velocity =
+        before.linear_velocity +
+        ratio * (after.linear_velocity - before.linear_velocity);
+    velocity->angular_velocity =
+        before.angular_velocity +
+        ratio * (after.angular_velocity - before.angular_velocity);
+    return true;
+  }
+  AERROR << "Localization lookup keeps racing with the writer, timestamp: "
+         << timestamp;
+  return false;
+}
+
+bool LocalizationBuffer::LookupNearest(double timestamp,
+                                       LocalizationVelocity* velocity) const {
+  return Lookup(timestamp, false, velocity);
+}
+
+bool LocalizationBuffer::LookupInterpolated(
+    double timestamp, LocalizationVelocity* velocity) const {
+  return Lookup(timestamp, true, velocity);
+}
+
+size_t LocalizationBuffer::Size() const {
+  return static_cast<size_t>(
+      std::min(write_index_.load(std::memory_order_acquire), capacity_ - 1));
+}
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
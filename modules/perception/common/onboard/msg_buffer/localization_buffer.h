@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Eigen/Core"
+
+#include "cyber/cyber.h"
+#include "modules/common_msgs/localization_msgs/localization.pb.h"
+
+namespace apollo {
+namespace perception {
+namespace onboard {
+
+struct LocalizationVelocity {
+  double timestamp = 0.0;
+  Eigen::Vector3f linear_velocity = Eigen::Vector3f::Zero();
+  Eigen::Vector3f angular_velocity = Eigen::Vector3f::Zero();
+};
+
+/**
+ * @class LocalizationBuffer
+ * @brief Time indexed ring of localization velocities, one writer and any
+ *        number of readers, nobody takes a lock
+ *
+ * The localization callback is the only writer. Every slot is guarded by its
+ * own sequence counter (seqlock), a reader that races with the writer on a
+ * slot just reads it again, so a radar frame never waits for the 100 Hz
+ * localization writer. Lookups are a binary search over the ring, O(log n).
+ */
+class LocalizationBuffer {
+ public:
+  using LocalizationEstimate = apollo::localization::LocalizationEstimate;
+
+  // keeps at least capacity samples, the ring is a power of two
+  explicit LocalizationBuffer(size_t capacity = 256);
+  ~LocalizationBuffer() = default;
+
+  LocalizationBuffer(const LocalizationBuffer&) = delete;
+  LocalizationBuffer& operator=(const LocalizationBuffer&) = delete;
+
+  /**
+   * @brief Subscribe channel with a node derived from name, same as MsgBuffer
+   */
+  void Init(const std::string& channel, const std::string& name);
+
+  /**
+   * @brief Append a sample, must be called from a single thread, samples
+   *        not newer than the last one are dropped
+   */
+  void Push(const LocalizationEstimate& msg);
+  void Push(const LocalizationVelocity& velocity);
+
+  /**
+   * @brief The sample closest to timestamp
+   */
+  bool LookupNearest(double timestamp, LocalizationVelocity* velocity) const;
+
+  /**
+   * @brief Linear interpolation of the two samples around timestamp, the
+   *        nearest sample if timestamp is out of the buffered range
+   */
+  bool LookupInterpolated(double timestamp,
+                          LocalizationVelocity* velocity) const;
+
+  size_t Size() const;
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<double> timestamp{0.0};
+    std::atomic<float> values[6];
+  };
+
+  // false if the slot of index was overwritten while reading
+  bool ReadSample(uint64_t index, LocalizationVelocity* velocity) const;
+  // oldest index whose timestamp >= timestamp, end if there is none
+  bool LowerBound(double timestamp, uint64_t begin, uint64_t end,
+                  uint64_t* index) const;
+  bool Lookup(double timestamp, bool interpolate,
+              LocalizationVelocity* velocity) const;
+
+  std::unique_ptr<Slot[]> slots_;
+  uint64_t capacity_ = 0;
+  // number of samples pushed, the newest sample is write_index_ - 1
+  std::atomic<uint64_t> write_index_{0};
+  double last_timestamp_ = 0.0;
+
+  std::shared_ptr<cyber::Node> node_ = nullptr;
+  std::shared_ptr<cyber::Reader<LocalizationEstimate>> reader_ = nullptr;
+};
+
+}  // namespace onboard
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,87 @@
+#include "modules/perception/radar4d_detection/common/oculii_point_cloud_view.h"
+
+#include <algorithm>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+bool ConvertToColumnar(const drivers::OculiiPointCloud& message,
+                       drivers::OculiiPointColumns* columns) {
+  if (columns == nullptr) {
+    AERROR << "columns is nullptr";
+    return false;
+  }
+  columns->Clear();
+  const int point_size = message.point_size();
+  columns->mutable_x()->Reserve(point_size);
+  columns->mutable_y()->Reserve(point_size);
+  columns->mutable_z()->Reserve(point_size);
+  columns->mutable_intensity()->Reserve(point_size);
+  columns->mutable_velocity()->Reserve(point_size);
+  for (const auto& point : message.point()) {
+    columns->add_x(point.x());
+    columns->add_y(point.y());
+    columns->add_z(point.z());
+    columns->add_intensity(point.intensity());
+    columns->add_velocity(point.velocity());
+  }
+
+  const int raw_size = message.raw_pointclouds_size();
+  columns->mutable_range()->Resize(raw_size, 0.0f);
+  columns->mutable_doppler()->Resize(raw_size, 0.0f);
+  columns->mutable_azimuth()->Resize(raw_size, 0.0f);
+  columns->mutable_elevation()->Resize(raw_size, 0.0f);
+  columns->mutable_power()->Resize(raw_size, 0.0f);
+  GatherOculiiRawPoints(message, columns->mutable_range()->mutable_data(),
+                        columns->mutable_azimuth()->mutable_data(),
+                        columns->mutable_elevation()->mutable_data(),
+                        columns->mutable_doppler()->mutable_data(),
+                        columns->mutable_power()->mutable_data());
+  return true;
+}
+
+OculiiPointCloudView::OculiiPointCloudView(
+    const drivers::OculiiPointCloud& message) {
+  if (message.has_columns()) {
+    columns_ = &message.columns();
+  } else {
+    owned_.reset(new drivers::OculiiPointColumns());
+    ConvertToColumnar(message, owned_.get());
+    columns_ = owned_.get();
+  }
+
+  // a short column limits the whole group, a writer bug must not let the
+  // reader run past the end of a column
+  const auto& c = *columns_;
+  const auto point_sizes =
+      std::minmax({c.x_size(), c.y_size(), c.z_size(), c.intensity_size(),
+                   c.velocity_size()});
+  const auto raw_point_sizes =
+      std::minmax({c.range_size(), c.doppler_size(), c.azimuth_size(),
+                   c.elevation_size(), c.power_size()});
+  point_size_ = static_cast<size_t>(point_sizes.first);
+  raw_point_size_ = static_cast<size_t>(raw_point_sizes.first);
+  if (point_sizes.first != point_sizes.second ||
+      raw_point_sizes.first != raw_point_sizes.second) {
+    AWARN << "Columns of oculii point cloud have different sizes, frame: "
+          << message.frame_id();
+  }
+}
+
+OculiiRawPointsSoA OculiiPointCloudView::RawPoints() const {
+  OculiiRawPointsSoA points;
+  points.range = range();
+  points.azimuth = azimuth();
+  points.elevation = elevation();
+  points.doppler = doppler();
+  points.power = power();
+  points.size = raw_point_size_;
+  return points;
+}
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
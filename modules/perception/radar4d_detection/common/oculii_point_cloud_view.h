@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "modules/common_msgs/sensor_msgs/oculii_radar.pb.h"
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+/**
+ * @brief Convert point and raw_pointclouds of a legacy message to columns
+ *
+ * @return false if columns is nullptr
+ */
+bool ConvertToColumnar(const drivers::OculiiPointCloud& message,
+                       drivers::OculiiPointColumns* columns);
+
+/**
+ * @class OculiiPointCloudView
+ * @brief Read only column access to the points of an OculiiPointCloud
+ *
+ * A message with columns is read in place, the view only keeps pointers into
+ * the message, which must outlive the view. A legacy message is converted
+ * once into columns owned by the view.
+ */
+class OculiiPointCloudView {
+ public:
+  explicit OculiiPointCloudView(const drivers::OculiiPointCloud& message);
+  ~OculiiPointCloudView() = default;
+
+  OculiiPointCloudView(const OculiiPointCloudView&) = delete;
+  OculiiPointCloudView& operator=(const OculiiPointCloudView&) = delete;
+
+  // true if no point was copied
+  bool IsZeroCopy() const { return owned_ == nullptr; }
+
+  // detections, x/y/z/intensity/velocity
+  size_t PointSize() const { return point_size_; }
+  const float* x() const { return columns_->x().data(); }
+  const float* y() const { return columns_->y().data(); }
+  const float* z() const { return columns_->z().data(); }
+  const float* intensity() const { return columns_->intensity().data(); }
+  const float* velocity() const { return columns_->velocity().data(); }
+
+  // raw points, range/doppler/azimuth/elevation/power
+  size_t RawPointSize() const { return raw_point_size_; }
+  const float* range() const { return columns_->range().data(); }
+  const float* doppler() const { return columns_->doppler().data(); }
+  const float* azimuth() const { return columns_->azimuth().data(); }
+  const float* elevation() const { return columns_->elevation().data(); }
+  const float* power() const { return columns_->power().data(); }
+
+  // input of ConvertOculiiPoints
+  OculiiRawPointsSoA RawPoints() const;
+
+ private:
+  std::unique_ptr<drivers::OculiiPointColumns> owned_;
+  const drivers::OculiiPointColumns* columns_ = nullptr;
+  size_t point_size_ = 0;
+  size_t raw_point_size_ = 0;
+};
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
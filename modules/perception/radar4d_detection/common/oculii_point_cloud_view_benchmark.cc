@@ -0,0 +1,81 @@
+// Parse cost of an OculiiPointCloud with columns against a legacy one with
+// per point messages, up to the column view the component reads.
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/benchmark/benchmark_util.h"
+#include "modules/perception/radar4d_detection/common/oculii_point_cloud_view.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+namespace {
+
+using cyber::benchmark::PerfEventCounters;
+
+// range(0) detections and as many raw points
+drivers::OculiiPointCloud MakeLegacyMessage(int size) {
+  drivers::OculiiPointCloud message;
+  message.set_frame_id("radar_front");
+  for (int i = 0; i < size; ++i) {
+    auto* point = message.add_point();
+    point->set_x(0.1f * i);
+    point->set_y(0.01f * i);
+    point->set_z(0.5f);
+    point->set_intensity(static_cast<float>(i % 50));
+    point->set_velocity(static_cast<float>(i % 60) - 30.0f);
+    auto* raw = message.add_raw_pointclouds();
+    raw->set_range(static_cast<float>(i % 200));
+    raw->set_doppler(static_cast<float>(i % 60) - 30.0f);
+    raw->set_azimuth(0.001f * i);
+    raw->set_elevation(0.0001f * i);
+    raw->set_power(static_cast<float>(i % 50));
+  }
+  return message;
+}
+
+drivers::OculiiPointCloud MakeColumnarMessage(int size) {
+  const auto legacy = MakeLegacyMessage(size);
+  drivers::OculiiPointCloud message;
+  message.set_frame_id(legacy.frame_id());
+  ConvertToColumnar(legacy, message.mutable_columns());
+  return message;
+}
+
+// ParseFromString and the view over range(0) points, the message is reused
+// as a reader's would be
+template <bool kColumnar>
+void BM_ParseOculiiPointCloud(::benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  const std::string data = kColumnar
+                               ? MakeColumnarMessage(size).SerializeAsString()
+                               : MakeLegacyMessage(size).SerializeAsString();
+  drivers::OculiiPointCloud message;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    message.ParseFromString(data);
+    OculiiPointCloudView view(message);
+    ::benchmark::DoNotOptimize(view.RawPoints().range);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(data.size()));
+  state.counters["message_bytes"] = static_cast<double>(data.size());
+  state.SetLabel(kColumnar ? "columnar" : "legacy");
+}
+
+BENCHMARK_TEMPLATE(BM_ParseOculiiPointCloud, false)
+    ->ArgName("points")
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_ParseOculiiPointCloud, true)
+    ->ArgName("points")
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+
+}  // namespace
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
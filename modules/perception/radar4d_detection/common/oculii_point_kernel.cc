@@ -0,0 +1,173 @@
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel.h"
+
+#include <cmath>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel_impl.h"
+#endif
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+namespace internal {
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+namespace {
+
+struct NeonOps {
+  using V = float32x4_t;
+  using M = uint32x4_t;
+  static constexpr size_t kWidth = 4;
+
+  static V Load(const float* p) { return vld1q_f32(p); }
+  static void Store(float* p, V a) { vst1q_f32(p, a); }
+  static V Set1(float a) { return vdupq_n_f32(a); }
+  static V Add(V a, V b) { return vaddq_f32(a, b); }
+  static V Sub(V a, V b) { return vsubq_f32(a, b); }
+  static V Mul(V a, V b) { return vmulq_f32(a, b); }
+  static V Fma(V a, V b, V c) { return vfmaq_f32(c, a, b); }
+  static V Neg(V a) { return vnegq_f32(a); }
+  static V Round(V a) { return vrndnq_f32(a); }
+  static V Floor(V a) { return vrndmq_f32(a); }
+  static M CmpEq(V a, V b) { return vceqq_f32(a, b); }
+  static M CmpGe(V a, V b) { return vcgeq_f32(a, b); }
+  static M CmpLe(V a, V b) { return vcleq_f32(a, b); }
+  static M And(M a, M b) { return vandq_u32(a, b); }
+  static M Or(M a, M b) { return vorrq_u32(a, b); }
+  static V Select(M m, V a, V b) { return vbslq_f32(m, a, b); }
+  static uint32_t MaskBits(M m) {
+    static const uint32_t kLaneBits[4] = {1, 2, 4, 8};
+    return vaddvq_u32(vandq_u32(m, vld1q_u32(kLaneBits)));
+  }
+};
+
+}  // namespace
+
+size_t ConvertOculiiPointsNeon(const OculiiRawPointsSoA& in,
+                               const OculiiKernelParams& params, float* x,
+                               float* y, float* z, float* velocity,
+                               float* power) {
+  return ConvertOculiiPointsImpl<NeonOps>(in, params, x, y, z, velocity,
+                                          power);
+}
+#endif
+
+}  // namespace internal
+
+KernelIsa GetKernelIsa() {
+#if defined(__aarch64__) && defined(__ARM_NEON)
+  return KernelIsa::NEON;
+#elif defined(__x86_64__) || defined(__i386__)
+  static const KernelIsa isa =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+          ? KernelIsa::AVX2
+          : KernelIsa::SCALAR;
+  return isa;
+#else
+  return KernelIsa::SCALAR;
+#endif
+}
+
+size_t ConvertOculiiPoints(const OculiiRawPointsSoA& in,
+                           const OculiiKernelParams& params,
+                           OculiiPointsSoA* out) {
+  if (out == nullptr) {
+    AERROR << "out is nullptr";
+    return 0;
+  }
+  size_t count = 0;
+  switch (GetKernelIsa()) {
+#if defined(__x86_64__) || defined(__i386__)
+    case KernelIsa::AVX2:
+      out->Resize(in.size);
+      count = internal::ConvertOculiiPointsAvx2(
+          in, params, out->x.data(), out->y.data(), out->z.data(),
+          out->velocity.data(), out->power.data());
+      break;
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    case KernelIsa::NEON:
+      out->Resize(in.size);
+      count = internal::ConvertOculiiPointsNeon(
+          in, params, out->x.data(), out->y.data(), out->z.data(),
+          out->velocity.data(), out->power.data());
+      break;
+#endif
+    default:
+      return ConvertOculiiPointsScalar(in, params, out);
+  }
+  out->Resize(count);
+  return count;
+}
+
+size_t ConvertOculiiPointsScalar(const OculiiRawPointsSoA& in,
+                                 const OculiiKernelParams& params,
+                                 OculiiPointsSoA* out) {
+  if (out == nullptr) {
+    AERROR << "out is nullptr";
+    return 0;
+  }
+  out->Resize(in.size);
+  size_t count = 0;
+  for (size_t i = 0; i < in.size; ++i) {
+    const float range = in.range[i];
+    const float cos_el = std::cos(in.elevation[i]);
+    const float ux = cos_el * std::cos(in.azimuth[i]);
+    const float uy = cos_el * std::sin(in.azimuth[i]);
+    const float uz = std::sin(in.elevation[i]);
+    const float x = range * ux;
+    if (!(range >= 0.0f && x <= params.max_forward_distance)) {
+      continue;
+    }
+    out->x[count] = x;
+    out->y[count] = range * uy;
+    out->z[count] = range * uz;
+    out->velocity[count] = in.doppler[i] + params.ego_vx * ux +
+                           params.ego_vy * uy + params.ego_vz * uz;
+    out->power[count] = in.power[i];
+    ++count;
+  }
+  out->Resize(count);
+  return count;
+}
+
+void GatherOculiiRawPoints(const drivers::OculiiPointCloud& message,
+                           std::vector<float>* buffer,
+                           OculiiRawPointsSoA* points) {
+  const size_t size = static_cast<size_t>(message.raw_pointclouds_size());
+  buffer->resize(size * 5);
+  float* range = buffer->data();
+  float* azimuth = range + size;
+  float* elevation = azimuth + size;
+  float* doppler = elevation + size;
+  float* power = doppler + size;
+  GatherOculiiRawPoints(message, range, azimuth, elevation, doppler, power);
+  points->range = range;
+  points->azimuth = azimuth;
+  points->elevation = elevation;
+  points->doppler = doppler;
+  points->power = power;
+  points->size = size;
+}
+
+void GatherOculiiRawPoints(const drivers::OculiiPointCloud& message,
+                           float* range, float* azimuth, float* elevation,
+                           float* doppler, float* power) {
+  const int size = message.raw_pointclouds_size();
+  for (int i = 0; i < size; ++i) {
+    const auto& raw = message.raw_pointclouds(i);
+    range[i] = raw.range();
+    azimuth[i] = raw.azimuth();
+    elevation[i] = raw.elevation();
+    doppler[i] = raw.doppler();
+    power[i] = raw.power();
+  }
+}
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "modules/common_msgs/sensor_msgs/oculii_radar.pb.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+/**
+ * @brief Column view of OculiiRawPointcloud, every pointer holds size values
+ */
+struct OculiiRawPointsSoA {
+  const float* range = nullptr;
+  const float* azimuth = nullptr;
+  const float* elevation = nullptr;
+  const float* doppler = nullptr;
+  const float* power = nullptr;
+  size_t size = 0;
+};
+
+/**
+ * @brief Converted points in radar coordinate, one vector per field
+ */
+struct OculiiPointsSoA {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  // radial velocity with ego motion removed, positive means moving away
+  std::vector<float> velocity;
+  std::vector<float> power;
+
+  size_t size() const { return x.size(); }
+  void Resize(size_t size) {
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+    velocity.resize(size);
+    power.resize(size);
+  }
+};
+
+struct OculiiKernelParams {
+  // ego velocity expressed in radar coordinate, m/s
+  float ego_vx = 0.0f;
+  float ego_vy = 0.0f;
+  float ego_vz = 0.0f;
+  // points with x beyond radar_forward_distance are dropped
+  float max_forward_distance = 200.0f;
+};
+
+enum class KernelIsa {
+  SCALAR = 0,
+  AVX2 = 1,
+  NEON = 2,
+};
+
+/**
+ * @brief The instruction set ConvertOculiiPoints runs on this machine
+ */
+KernelIsa GetKernelIsa();
+
+/**
+ * @brief Convert polar points to x/y/z, compensate doppler with the ego
+ *        velocity and drop points out of range, in one pass
+ *
+ * doppler is the radial velocity relative to the radar, so the compensated
+ * velocity is doppler + ego_velocity.dot(direction). A point is kept if
+ * range >= 0 and x <= max_forward_distance, NaN points are dropped.
+ *
+ * @return the number of points kept in out
+ */
+size_t ConvertOculiiPoints(const OculiiRawPointsSoA& in,
+                           const OculiiKernelParams& params,
+                           OculiiPointsSoA* out);
+
+/**
+ * @brief Scalar reference of ConvertOculiiPoints using std::sin/std::cos
+ */
+size_t ConvertOculiiPointsScalar(const OculiiRawPointsSoA& in,
+                                 const OculiiKernelParams& params,
+                                 OculiiPointsSoA* out);
+
+/**
+ * @brief Gather raw_pointclouds of a message into columns
+ */
+void GatherOculiiRawPoints(const drivers::OculiiPointCloud& message,
+                           std::vector<float>* buffer,
+                           OculiiRawPointsSoA* points);
+
+/**
+ * @brief Gather raw_pointclouds of a message into the given columns, each
+ *        holds raw_pointclouds_size() values
+ */
+void GatherOculiiRawPoints(const drivers::OculiiPointCloud& message,
+                           float* range, float* azimuth, float* elevation,
+                           float* doppler, float* power);
+
+namespace internal {
+
+// Raw pointer entries, the output arrays hold at least size values
+size_t ConvertOculiiPointsAvx2(const OculiiRawPointsSoA& in,
+                               const OculiiKernelParams& params, float* x,
+                               float* y, float* z, float* velocity,
+                               float* power);
+size_t ConvertOculiiPointsNeon(const OculiiRawPointsSoA& in,
+                               const OculiiKernelParams& params, float* x,
+                               float* y, float* z, float* velocity,
+                               float* power);
+
+}  // namespace internal
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
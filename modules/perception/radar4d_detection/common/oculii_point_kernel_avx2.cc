@@ -0,0 +1,65 @@
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+// Only this translation unit is built for AVX2, it is entered after
+// GetKernelIsa() checked the cpu at runtime.
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel_impl.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+namespace internal {
+namespace {
+
+struct Avx2Ops {
+  using V = __m256;
+  using M = __m256;
+  static constexpr size_t kWidth = 8;
+
+  static V Load(const float* p) { return _mm256_loadu_ps(p); }
+  static void Store(float* p, V a) { _mm256_storeu_ps(p, a); }
+  static V Set1(float a) { return _mm256_set1_ps(a); }
+  static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+  static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+  static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+  static V Fma(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+  static V Neg(V a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+  static V Round(V a) {
+    return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static V Floor(V a) { return _mm256_floor_ps(a); }
+  static M CmpEq(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+  static M CmpGe(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+  static M CmpLe(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  static M And(M a, M b) { return _mm256_and_ps(a, b); }
+  static M Or(M a, M b) { return _mm256_or_ps(a, b); }
+  static V Select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+  static uint32_t MaskBits(M m) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(m));
+  }
+};
+
+}  // namespace
+
+size_t ConvertOculiiPointsAvx2(const OculiiRawPointsSoA& in,
+                               const OculiiKernelParams& params, float* x,
+                               float* y, float* z, float* velocity,
+                               float* power) {
+  return ConvertOculiiPointsImpl<Avx2Ops>(in, params, x, y, z, velocity,
+                                          power);
+}
+
+}  // namespace internal
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
+
+#pragma GCC pop_options
+
+#endif
@@ -0,0 +1,104 @@
+// Cost of ConvertOculiiPoints on this machine's instruction set against the
+// scalar reference, and of gathering the raw points out of a message.
+
+#include <cmath>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "cyber/benchmark/benchmark_util.h"
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+namespace {
+
+using cyber::benchmark::PerfEventCounters;
+
+drivers::OculiiPointCloud MakeMessage(size_t size) {
+  drivers::OculiiPointCloud message;
+  for (size_t i = 0; i < size; ++i) {
+    auto* raw = message.add_raw_pointclouds();
+    // about one in ten points beyond max_forward_distance
+    raw->set_range(static_cast<float>(i % 220));
+    raw->set_azimuth(std::sin(static_cast<float>(i)) * 1.2f);
+    raw->set_elevation(std::cos(static_cast<float>(i)) * 0.2f);
+    raw->set_doppler(static_cast<float>(i % 60) - 30.0f);
+    raw->set_power(static_cast<float>(i % 50));
+  }
+  return message;
+}
+
+OculiiKernelParams MakeParams() {
+  OculiiKernelParams params;
+  params.ego_vx = 12.5f;
+  params.ego_vy = -0.8f;
+  params.ego_vz = 0.1f;
+  return params;
+}
+
+const char* IsaName(KernelIsa isa) {
+  switch (isa) {
+    case KernelIsa::AVX2:
+      return "avx2";
+    case KernelIsa::NEON:
+      return "neon";
+    default:
+      return "scalar";
+  }
+}
+
+using ConvertFunc = size_t (*)(const OculiiRawPointsSoA&,
+                               const OculiiKernelParams&, OculiiPointsSoA*);
+
+// range(0) raw points through func, the output is reused as in the component
+template <ConvertFunc func>
+void BM_ConvertOculiiPoints(::benchmark::State& state) {
+  const auto message = MakeMessage(static_cast<size_t>(state.range(0)));
+  std::vector<float> buffer;
+  OculiiRawPointsSoA raw;
+  GatherOculiiRawPoints(message, &buffer, &raw);
+  const OculiiKernelParams params = MakeParams();
+  OculiiPointsSoA points;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(func(raw, params, &points));
+    ::benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetLabel(func == &ConvertOculiiPointsScalar ? "scalar"
+                                                     : IsaName(GetKernelIsa()));
+}
+
+// range(0) raw points of a legacy message into columns
+void BM_GatherOculiiRawPoints(::benchmark::State& state) {
+  const auto message = MakeMessage(static_cast<size_t>(state.range(0)));
+  std::vector<float> buffer;
+  OculiiRawPointsSoA raw;
+  PerfEventCounters counters(&state);
+  for (auto _ : state) {
+    GatherOculiiRawPoints(message, &buffer, &raw);
+    ::benchmark::DoNotOptimize(raw.range);
+    ::benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_ConvertOculiiPoints, &ConvertOculiiPoints)
+    ->ArgName("points")
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_ConvertOculiiPoints, &ConvertOculiiPointsScalar)
+    ->ArgName("points")
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK(BM_GatherOculiiRawPoints)
+    ->ArgName("points")
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+
+}  // namespace
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
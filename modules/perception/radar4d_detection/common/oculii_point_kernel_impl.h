@@ -0,0 +1,156 @@
+#pragma once
+
+// Generic body of the vector kernels, only included by the translation units
+// that provide an Ops type for one instruction set. Ops must define
+//   V, M, kWidth, Load, Store, Set1, Add, Sub, Mul, Fma(a, b, c) = a * b + c,
+//   Neg, Round, Floor, CmpEq, CmpGe, CmpLe, And, Or, Select(m, a, b),
+//   MaskBits
+// Nothing here may use the standard library, the including translation unit
+// may be compiled for a wider instruction set than the rest of the binary.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+namespace internal {
+namespace {
+
+// sin and cos of x with Cephes sinf/cosf polynomials, max error ~2 ulp for
+// |x| < 8192 which covers any radar angle
+template <typename Ops>
+inline void SinCos(typename Ops::V x, typename Ops::V* sin_x,
+                   typename Ops::V* cos_x) {
+  using V = typename Ops::V;
+  using M = typename Ops::M;
+  // x = j * pi / 2 + r, r in [-pi / 4, pi / 4]
+  const V j = Ops::Round(Ops::Mul(x, Ops::Set1(0.63661977236758134f)));
+  V r = Ops::Fma(j, Ops::Set1(-1.5703125f), x);
+  r = Ops::Fma(j, Ops::Set1(-4.837512969970703125e-4f), r);
+  r = Ops::Fma(j, Ops::Set1(-7.54978995489188216e-8f), r);
+  const V r2 = Ops::Mul(r, r);
+
+  V sin_r = Ops::Fma(r2, Ops::Set1(-1.9515295891e-4f),
+                     Ops::Set1(8.3321608736e-3f));
+  sin_r = Ops::Fma(sin_r, r2, Ops::Set1(-1.6666654611e-1f));
+  sin_r = Ops::Fma(Ops::Mul(sin_r, r2), r, r);
+
+  V cos_r = Ops::Fma(r2, Ops::Set1(2.443315711809948e-5f),
+                     Ops::Set1(-1.388731625493765e-3f));
+  cos_r = Ops::Fma(cos_r, r2, Ops::Set1(4.166664568298827e-2f));
+  cos_r = Ops::Fma(Ops::Mul(cos_r, r2), r2,
+                   Ops::Fma(r2, Ops::Set1(-0.5f), Ops::Set1(1.0f)));
+
+  // quadrant q = j mod 4
+  const V q = Ops::Sub(
+      j, Ops::Mul(Ops::Floor(Ops::Mul(j, Ops::Set1(0.25f))), Ops::Set1(4.0f)));
+  const M q1 = Ops::CmpEq(q, Ops::Set1(1.0f));
+  const M q2 = Ops::CmpEq(q, Ops::Set1(2.0f));
+  const M q3 = Ops::CmpEq(q, Ops::Set1(3.0f));
+  const M swap = Ops::Or(q1, q3);
+  const V s = Ops::Select(swap, cos_r, sin_r);
+  const V c = Ops::Select(swap, sin_r, cos_r);
+  *sin_x = Ops::Select(Ops::Or(q2, q3), Ops::Neg(s), s);
+  *cos_x = Ops::Select(Ops::Or(q1, q2), Ops::Neg(c), c);
+}
+
+template <typename Ops>
+size_t ConvertOculiiPointsImpl(const OculiiRawPointsSoA& in,
+                               const OculiiKernelParams& params, float* x,
+                               float* y, float* z, float* velocity,
+                               float* power) {
+  using V = typename Ops::V;
+  using M = typename Ops::M;
+  constexpr size_t kWidth = Ops::kWidth;
+  constexpr uint32_t kAllLanes = (1u << kWidth) - 1;
+
+  const V ego_vx = Ops::Set1(params.ego_vx);
+  const V ego_vy = Ops::Set1(params.ego_vy);
+  const V ego_vz = Ops::Set1(params.ego_vz);
+  const V max_distance = Ops::Set1(params.max_forward_distance);
+  const V zero = Ops::Set1(0.0f);
+
+  alignas(32) float tail[5][kWidth];
+  alignas(32) float block[5][kWidth];
+  size_t count = 0;
+  for (size_t i = 0; i < in.size; i += kWidth) {
+    V range, azimuth, elevation, doppler, pw;
+    if (i + kWidth <= in.size) {
+      range = Ops::Load(in.range + i);
+      azimuth = Ops::Load(in.azimuth + i);
+      elevation = Ops::Load(in.elevation + i);
+      doppler = Ops::Load(in.doppler + i);
+      pw = Ops::Load(in.power + i);
+    } else {
+      // pad the tail with range -1, the padding never passes the filter
+      for (size_t k = 0; k < kWidth; ++k) {
+        const bool valid = i + k < in.size;
+        tail[0][k] = valid ? in.range[i + k] : -1.0f;
+        tail[1][k] = valid ? in.azimuth[i + k] : 0.0f;
+        tail[2][k] = valid ? in.elevation[i + k] : 0.0f;
+        tail[3][k] = valid ? in.doppler[i + k] : 0.0f;
+        tail[4][k] = valid ? in.power[i + k] : 0.0f;
+      }
+      range = Ops::Load(tail[0]);
+      azimuth = Ops::Load(tail[1]);
+      elevation = Ops::Load(tail[2]);
+      doppler = Ops::Load(tail[3]);
+      pw = Ops::Load(tail[4]);
+    }
+
+    V sin_az, cos_az, sin_el, cos_el;
+    SinCos<Ops>(azimuth, &sin_az, &cos_az);
+    SinCos<Ops>(elevation, &sin_el, &cos_el);
+    // unit vector from the radar to the point
+    const V ux = Ops::Mul(cos_el, cos_az);
+    const V uy = Ops::Mul(cos_el, sin_az);
+    const V uz = sin_el;
+
+    const V px = Ops::Mul(range, ux);
+    const V py = Ops::Mul(range, uy);
+    const V pz = Ops::Mul(range, uz);
+    const V v = Ops::Fma(ego_vx, ux,
+                         Ops::Fma(ego_vy, uy, Ops::Fma(ego_vz, uz, doppler)));
+
+    const M keep = Ops::And(Ops::CmpGe(range, zero),
+                            Ops::CmpLe(px, max_distance));
+    const uint32_t bits = Ops::MaskBits(keep);
+    if (bits == 0) {
+      continue;
+    }
+    if (bits == kAllLanes) {
+      Ops::Store(x + count, px);
+      Ops::Store(y + count, py);
+      Ops::Store(z + count, pz);
+      Ops::Store(velocity + count, v);
+      Ops::Store(power + count, pw);
+      count += kWidth;
+      continue;
+    }
+    Ops::Store(block[0], px);
+    Ops::Store(block[1], py);
+    Ops::Store(block[2], pz);
+    Ops::Store(block[3], v);
+    Ops::Store(block[4], pw);
+    for (size_t k = 0; k < kWidth; ++k) {
+      if ((bits >> k) & 1u) {
+        x[count] = block[0][k];
+        y[count] = block[1][k];
+        z[count] = block[2][k];
+        velocity[count] = block[3][k];
+        power[count] = block[4][k];
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
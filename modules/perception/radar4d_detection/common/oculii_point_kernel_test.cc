@@ -0,0 +1,159 @@
+#include "modules/perception/radar4d_detection/common/oculii_point_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+namespace {
+
+// the vector sin/cos are a few ulp off std::sin/std::cos
+constexpr float kTolerance = 1e-4f;
+
+struct RawPoints {
+  std::vector<float> range;
+  std::vector<float> azimuth;
+  std::vector<float> elevation;
+  std::vector<float> doppler;
+  std::vector<float> power;
+
+  OculiiRawPointsSoA SoA() const {
+    OculiiRawPointsSoA points;
+    points.range = range.data();
+    points.azimuth = azimuth.data();
+    points.elevation = elevation.data();
+    points.doppler = doppler.data();
+    points.power = power.data();
+    points.size = range.size();
+    return points;
+  }
+};
+
+// Random points with some NaN, negative range and beyond distance ones. No
+// point is close to max_forward_distance, where the kernels may round x to
+// different sides of it.
+RawPoints MakeRawPoints(size_t size, const OculiiKernelParams& params) {
+  std::mt19937 rng(static_cast<uint32_t>(size));
+  std::uniform_real_distribution<float> range(0.0f, 300.0f);
+  std::uniform_real_distribution<float> angle(-1.5f, 1.5f);
+  std::uniform_real_distribution<float> doppler(-30.0f, 30.0f);
+  std::uniform_real_distribution<float> power(0.0f, 60.0f);
+  RawPoints points;
+  for (size_t i = 0; i < size; ++i) {
+    float r = range(rng);
+    const float azimuth = angle(rng);
+    const float elevation = angle(rng) * 0.2f;
+    const float x = r * std::cos(elevation) * std::cos(azimuth);
+    if (std::fabs(x - params.max_forward_distance) < 1.0f) {
+      r *= 0.5f;
+    }
+    switch (i % 13) {
+      case 3:
+        r = std::numeric_limits<float>::quiet_NaN();
+        break;
+      case 7:
+        r = -r;
+        break;
+      default:
+        break;
+    }
+    points.range.push_back(r);
+    points.azimuth.push_back(azimuth);
+    points.elevation.push_back(elevation);
+    points.doppler.push_back(doppler(rng));
+    points.power.push_back(power(rng));
+  }
+  return points;
+}
+
+}  // namespace
+
+class OculiiPointKernelTest : public ::testing::TestWithParam<size_t> {};
+
+TEST_P(OculiiPointKernelTest, MatchesScalar) {
+  if (GetKernelIsa() == KernelIsa::SCALAR) {
+    GTEST_SKIP() << "no vector kernel on this machine";
+  }
+  OculiiKernelParams params;
+  params.ego_vx = 12.5f;
+  params.ego_vy = -0.8f;
+  params.ego_vz = 0.1f;
+  params.max_forward_distance = 150.0f;
+  const RawPoints raw = MakeRawPoints(GetParam(), params);
+
+  OculiiPointsSoA expected;
+  OculiiPointsSoA actual;
+  const size_t expected_count =
+      ConvertOculiiPointsScalar(raw.SoA(), params, &expected);
+  const size_t actual_count = ConvertOculiiPoints(raw.SoA(), params, &actual);
+  ASSERT_EQ(expected_count, actual_count);
+  ASSERT_EQ(actual_count, actual.size());
+  for (size_t i = 0; i < actual_count; ++i) {
+    EXPECT_EQ(expected.power[i], actual.power[i]) << "point " << i;
+    // relative to the range, the error grows with it
+    const float scale = std::max(1.0f, std::fabs(expected.x[i]) +
+                                           std::fabs(expected.y[i]) +
+                                           std::fabs(expected.z[i]));
+    EXPECT_NEAR(expected.x[i], actual.x[i], kTolerance * scale) << i;
+    EXPECT_NEAR(expected.y[i], actual.y[i], kTolerance * scale) << i;
+    EXPECT_NEAR(expected.z[i], actual.z[i], kTolerance * scale) << i;
+    EXPECT_NEAR(expected.velocity[i], actual.velocity[i], 1e-3f) << i;
+  }
+}
+
+// around the vector width and its tail
+INSTANTIATE_TEST_SUITE_P(Sizes, OculiiPointKernelTest,
+                         ::testing::Values(0, 1, 7, 8, 9, 1000, 1003));
+
+TEST(OculiiPointKernel, DropsInvalidPoints) {
+  OculiiKernelParams params;
+  params.max_forward_distance = 100.0f;
+  RawPoints raw;
+  // kept, NaN, negative range, beyond distance
+  raw.range = {10.0f, std::numeric_limits<float>::quiet_NaN(), -5.0f, 120.0f};
+  raw.azimuth = {0.0f, 0.0f, 0.0f, 0.0f};
+  raw.elevation = {0.0f, 0.0f, 0.0f, 0.0f};
+  raw.doppler = {1.0f, 1.0f, 1.0f, 1.0f};
+  raw.power = {3.0f, 3.0f, 3.0f, 3.0f};
+
+  OculiiPointsSoA scalar;
+  OculiiPointsSoA dispatch;
+  EXPECT_EQ(1, ConvertOculiiPointsScalar(raw.SoA(), params, &scalar));
+  EXPECT_EQ(1, ConvertOculiiPoints(raw.SoA(), params, &dispatch));
+  EXPECT_NEAR(10.0f, dispatch.x[0], kTolerance);
+  EXPECT_EQ(3.0f, dispatch.power[0]);
+}
+
+TEST(OculiiPointKernel, GathersRawPoints) {
+  drivers::OculiiPointCloud message;
+  for (int i = 0; i < 3; ++i) {
+    auto* raw = message.add_raw_pointclouds();
+    raw->set_range(static_cast<float>(i));
+    raw->set_azimuth(0.1f * i);
+    raw->set_elevation(0.01f * i);
+    raw->set_doppler(-1.0f * i);
+    raw->set_power(10.0f * i);
+  }
+  std::vector<float> buffer;
+  OculiiRawPointsSoA points;
+  GatherOculiiRawPoints(message, &buffer, &points);
+  ASSERT_EQ(3, points.size);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(message.raw_pointclouds(i).range(), points.range[i]);
+    EXPECT_EQ(message.raw_pointclouds(i).azimuth(), points.azimuth[i]);
+    EXPECT_EQ(message.raw_pointclouds(i).elevation(), points.elevation[i]);
+    EXPECT_EQ(message.raw_pointclouds(i).doppler(), points.doppler[i]);
+    EXPECT_EQ(message.raw_pointclouds(i).power(), points.power[i]);
+  }
+}
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+/**
+ * @class ParallelFor
+ * @brief Splits an index range over a few persistent workers and the
+ * calling thread.
+ *
+ * Every index is handled by exactly one thread and nothing is reduced
+ * across ranges, so a loop body that only writes its own elements gives the
+ * same results as running it serially. One Run at a time, a second caller
+ * waits for the first.
+ */
+class ParallelFor {
+ public:
+  using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+  // `thread_num` workers besides the caller
+  explicit ParallelFor(size_t thread_num) {
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+  ~ParallelFor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  ParallelFor(const ParallelFor&) = delete;
+  ParallelFor& operator=(const ParallelFor&) = delete;
+
+  size_t thread_num() const { return threads_.size(); }
+
+  /**
+   * @brief Call `func` on ranges covering [0, count), ranges hold at least
+   * `min_grain` indices, returns once all of them are done
+   */
+  void Run(size_t count, size_t min_grain, const RangeFunc& func) {
+    const size_t chunks =
+        std::min(threads_.size() + 1,
+                 count / std::max<size_t>(min_grain, 1));
+    if (chunks <= 1) {
+      if (count > 0) {
+        func(0, count);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // a worker woken late for the last run may still be looking at it
+      done_cv_.wait(lock, [this] { return active_ == 0; });
+      func_ = &func;
+      count_ = count;
+      chunks_ = chunks;
+      next_chunk_.store(0, std::memory_order_relaxed);
+      remaining_.store(chunks, std::memory_order_relaxed);
+      ++generation_;
+    }
+    cv_.notify_all();
+    RunChunks();
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] {
+      return remaining_.load(std::memory_order_acquire) == 0 && active_ == 0;
+    });
+    func_ = nullptr;
+  }
+
+ private:
+  void WorkerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      ++active_;
+      lock.unlock();
+      RunChunks();
+      lock.lock();
+      --active_;
+      done_cv_.notify_all();
+    }
+  }
+
+  void RunChunks() {
+    while (true) {
+      const size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= chunks_) {
+        return;
+      }
+      (*func_)(count_ * chunk / chunks_, count_ * (chunk + 1) / chunks_);
+      if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_cv_.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex run_mutex_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  bool stop_ = false;
+  uint64_t generation_ = 0;
+  // workers inside RunChunks
+  size_t active_ = 0;
+
+  // the current run, written only while no worker is active
+  const RangeFunc* func_ = nullptr;
+  size_t count_ = 0;
+  size_t chunks_ = 0;
+  std::atomic<size_t> next_chunk_{0};
+  std::atomic<size_t> remaining_{0};
+};
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
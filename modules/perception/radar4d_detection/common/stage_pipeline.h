@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+/**
+ * @brief Per stage latency statistics, all values in microseconds
+ */
+struct StageStatistics {
+  std::string name;
+  uint64_t frame_count = 0;
+  uint64_t total_wait_us = 0;  // time spent in the input queue
+  uint64_t total_proc_us = 0;  // time spent in the stage function
+  uint64_t max_proc_us = 0;
+
+  double AverageWaitMs() const {
+    return frame_count == 0 ? 0.0 : total_wait_us * 1e-3 / frame_count;
+  }
+  double AverageProcMs() const {
+    return frame_count == 0 ? 0.0 : total_proc_us * 1e-3 / frame_count;
+  }
+};
+
+/**
+ * @class StagePipeline
+ * @brief Runs a fixed sequence of stages on dedicated workers.
+ *
+ * Stage i and stage i + 1 are connected by a bounded FIFO queue and every
+ * stage is served by exactly one thread, so frames leave the pipeline in the
+ * order they were submitted and a stage function is never called
+ * concurrently with itself. Throughput is bounded by the slowest stage
+ * instead of the sum of all stages.
+ *
+ * A stage function returns false to stop a frame from reaching the later
+ * stages, e.g. when the pose of the frame can not be found.
+ *
+ * Stop() refuses new frames and lets every frame already accepted run
+ * through the remaining stages before the workers exit.
+ */
+template <typename T>
+class StagePipeline {
+ public:
+  using Item = std::shared_ptr<T>;
+  using StageFunc = std::function<bool(const Item&)>;
+
+  explicit StagePipeline(size_t queue_size, uint64_t log_interval = 100)
+      : queue_size_(std::max<size_t>(queue_size, 1)),
+        log_interval_(log_interval) {}
+  ~StagePipeline() { Stop(); }
+
+  StagePipeline(const StagePipeline&) = delete;
+  StagePipeline& operator=(const StagePipeline&) = delete;
+
+  /**
+   * @brief Append a stage, must be called before Start()
+   */
+  void AddStage(const std::string& name, const StageFunc& func) {
+    if (running_.load()) {
+      AERROR << "Can not add stage " << name << " to a running pipeline.";
+      return;
+    }
+    auto stage = std::make_unique<Stage>(queue_size_);
+    stage->name = name;
+    stage->func = func;
+    stages_.emplace_back(std::move(stage));
+  }
+
+  bool Start() {
+    if (stages_.empty()) {
+      AERROR << "Pipeline has no stage.";
+      return false;
+    }
+    if (running_.exchange(true)) {
+      return true;
+    }
+    for (size_t i = 0; i < stages_.size(); ++i) {
+      stages_[i]->worker = std::thread(&StagePipeline::Run, this, i);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Drain the accepted frames and join the workers
+   *
+   * The queues are closed from the first stage on: a stage is closed only
+   * after the stage before it has exited, so nothing is pushed into a
+   * closed queue and every accepted frame reaches the end of the pipeline.
+   */
+  void Stop() {
+    if (!running_.exchange(false)) {
+      return;
+    }
+    for (auto& stage : stages_) {
+      stage->queue.Close();
+      if (stage->worker.joinable()) {
+        stage->worker.join();
+      }
+    }
+  }
+
+  /**
+   * @brief Hand a frame to the first stage without blocking the caller
+   *
+   * @return false if the pipeline is stopped or the first queue is full,
+   * the frame is dropped in that case
+   */
+  bool Submit(const Item& item) {
+    if (!running_.load() || !stages_.front()->queue.TryPush(Wrap(item))) {
+      dropped_count_.fetch_add(1);
+      return false;
+    }
+    return true;
+  }
+
+  uint64_t DroppedCount() const { return dropped_count_.load(); }
+
+  std::vector<StageStatistics> GetStatistics() const {
+    std::vector<StageStatistics> stats;
+    stats.reserve(stages_.size());
+    for (const auto& stage : stages_) {
+      StageStatistics stat;
+      stat.name = stage->name;
+      stat.frame_count = stage->frame_count.load();
+      stat.total_wait_us = stage->total_wait_us.load();
+      stat.total_proc_us = stage->total_proc_us.load();
+      stat.max_proc_us = stage->max_proc_us.load();
+      stats.emplace_back(std::move(stat));
+    }
+    return stats;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Envelope {
+    Item item;
+    Clock::time_point enqueue_time;
+  };
+
+  class BlockingQueue {
+   public:
+    explicit BlockingQueue(size_t capacity) : capacity_(capacity) {}
+
+    bool TryPush(Envelope&& envelope) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (closed_ || queue_.size() >= capacity_) {
+        return false;
+      }
+      queue_.emplace_back(std::move(envelope));
+      not_empty_.notify_one();
+      return true;
+    }
+
+    bool Push(Envelope&& envelope) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock,
+                     [this] { return closed_ || queue_.size() < capacity_; });
+      if (closed_) {
+        return false;
+      }
+      queue_.emplace_back(std::move(envelope));
+      not_empty_.notify_one();
+      return true;
+    }
+
+    // a closed queue still hands out what it holds, false once it is empty
+    bool Pop(Envelope* envelope) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return false;
+      }
+      *envelope = std::move(queue_.front());
+      queue_.pop_front();
+      not_full_.notify_one();
+      return true;
+    }
+
+    void Close() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      not_empty_.notify_all();
+      not_full_.notify_all();
+    }
+
+   private:
+    const size_t capacity_;
+    bool closed_ = false;
+    std::deque<Envelope> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+  };
+
+  struct Stage {
+    explicit Stage(size_t queue_size) : queue(queue_size) {}
+
+    std::string name;
+    StageFunc func;
+    BlockingQueue queue;
+    std::thread worker;
+    std::atomic<uint64_t> frame_count{0};
+    std::atomic<uint64_t> total_wait_us{0};
+    std::atomic<uint64_t> total_proc_us{0};
+    std::atomic<uint64_t> max_proc_us{0};
+  };
+
+  static Envelope Wrap(const Item& item) {
+    return Envelope{item, Clock::now()};
+  }
+
+  static uint64_t ElapsedUs(Clock::time_point from, Clock::time_point to) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+            .count());
+  }
+
+  void Run(size_t index) {
+    Stage* stage = stages_[index].get();
+    Stage* next = index + 1 < stages_.size() ? stages_[index + 1].get()
+                                             : nullptr;
+    Envelope envelope;
+    while (stage->queue.Pop(&envelope)) {
+      const auto start = Clock::now();
+      const bool ok = stage->func(envelope.item);
+      const auto end = Clock::now();
+
+      const uint64_t proc_us = ElapsedUs(start, end);
+      stage->total_wait_us.fetch_add(ElapsedUs(envelope.enqueue_time, start));
+      stage->total_proc_us.fetch_add(proc_us);
+      uint64_t max_us = stage->max_proc_us.load();
+      while (proc_us > max_us &&
+             !stage->max_proc_us.compare_exchange_weak(max_us, proc_us)) {
+      }
+      const uint64_t count = stage->frame_count.fetch_add(1) + 1;
+
+      if (ok && next != nullptr) {
+        envelope.enqueue_time = end;
+        if (!next->queue.Push(std::move(envelope))) {
+          dropped_count_.fetch_add(1);
+          break;
+        }
+      }
+      if (next == nullptr && log_interval_ > 0 && count % log_interval_ == 0) {
+        LogStatistics();
+      }
+      envelope.item.reset();
+    }
+  }
+
+  void LogStatistics() const {
+    for (const auto& stat : GetStatistics()) {
+      AINFO << "Pipeline stage " << stat.name << ": frames["
+            << stat.frame_count << "] avg_wait_ms[" << stat.AverageWaitMs()
+            << "] avg_proc_ms[" << stat.AverageProcMs() << "] max_proc_ms["
+            << stat.max_proc_us * 1e-3 << "]";
+    }
+    AINFO << "Pipeline dropped frames: " << DroppedCount();
+  }
+
+  const size_t queue_size_;
+  const uint64_t log_interval_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> dropped_count_{0};
+  std::vector<std::unique_ptr<Stage>> stages_;
+};
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
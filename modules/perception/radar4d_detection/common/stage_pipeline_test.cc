@@ -0,0 +1,166 @@
+#include "modules/perception/radar4d_detection/common/stage_pipeline.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+namespace {
+
+using Pipeline = StagePipeline<int>;
+using Item = Pipeline::Item;
+
+// collects what reaches the last stage
+class Sink {
+ public:
+  bool operator()(const Item& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.push_back(*item);
+    return true;
+  }
+
+  std::vector<int> values() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<int> values_;
+};
+
+// holds the stage that calls Wait() until Open()
+class Gate {
+ public:
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    entered_ = true;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return open_; });
+  }
+
+  void WaitEntered() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return entered_; });
+  }
+
+  void Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool entered_ = false;
+  bool open_ = false;
+};
+
+}  // namespace
+
+TEST(StagePipelineTest, KeepsTheSubmitOrder) {
+  Sink sink;
+  Pipeline pipeline(4, 0);
+  pipeline.AddStage("add", [](const Item& item) {
+    *item += 1000;
+    return true;
+  });
+  // odd frames stop here
+  pipeline.AddStage("filter", [](const Item& item) { return *item % 2 == 0; });
+  pipeline.AddStage("sink", [&sink](const Item& item) { return sink(item); });
+  ASSERT_TRUE(pipeline.Start());
+
+  std::vector<int> expected;
+  for (int i = 0; i < 500; ++i) {
+    while (!pipeline.Submit(std::make_shared<int>(i))) {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    if (i % 2 == 0) {
+      expected.push_back(i + 1000);
+    }
+  }
+  pipeline.Stop();
+  EXPECT_EQ(expected, sink.values());
+
+  const auto stats = pipeline.GetStatistics();
+  ASSERT_EQ(3, stats.size());
+  EXPECT_EQ(500, stats[0].frame_count);
+  EXPECT_EQ(500, stats[1].frame_count);
+  EXPECT_EQ(250, stats[2].frame_count);
+}
+
+TEST(StagePipelineTest, FullQueueDropsTheFrame) {
+  Gate gate;
+  Sink sink;
+  Pipeline pipeline(2, 0);
+  pipeline.AddStage("gate", [&gate](const Item& item) {
+    if (*item == 0) {
+      gate.Wait();
+    }
+    return true;
+  });
+  pipeline.AddStage("sink", [&sink](const Item& item) { return sink(item); });
+  ASSERT_TRUE(pipeline.Start());
+
+  ASSERT_TRUE(pipeline.Submit(std::make_shared<int>(0)));
+  gate.WaitEntered();
+  // frame 0 is held in the stage, two more fit in its queue
+  EXPECT_TRUE(pipeline.Submit(std::make_shared<int>(1)));
+  EXPECT_TRUE(pipeline.Submit(std::make_shared<int>(2)));
+  EXPECT_FALSE(pipeline.Submit(std::make_shared<int>(3)));
+  EXPECT_EQ(1, pipeline.DroppedCount());
+
+  gate.Open();
+  pipeline.Stop();
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), sink.values());
+}
+
+TEST(StagePipelineTest, StopDrainsTheAcceptedFrames) {
+  Gate gate;
+  Sink sink;
+  Pipeline pipeline(8, 0);
+  pipeline.AddStage("gate", [&gate](const Item& item) {
+    if (*item == 0) {
+      gate.Wait();
+    }
+    return true;
+  });
+  pipeline.AddStage("slow", [](const Item&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return true;
+  });
+  pipeline.AddStage("sink", [&sink](const Item& item) { return sink(item); });
+  ASSERT_TRUE(pipeline.Start());
+
+  ASSERT_TRUE(pipeline.Submit(std::make_shared<int>(0)));
+  gate.WaitEntered();
+  std::vector<int> expected = {0};
+  for (int i = 1; i <= 8; ++i) {
+    ASSERT_TRUE(pipeline.Submit(std::make_shared<int>(i)));
+    expected.push_back(i);
+  }
+
+  // every frame is still queued when Stop starts
+  std::thread stopper([&pipeline] { pipeline.Stop(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  gate.Open();
+  stopper.join();
+
+  EXPECT_EQ(expected, sink.values());
+  EXPECT_EQ(0, pipeline.DroppedCount());
+  EXPECT_FALSE(pipeline.Submit(std::make_shared<int>(9)));
+  EXPECT_EQ(1, pipeline.DroppedCount());
+}
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
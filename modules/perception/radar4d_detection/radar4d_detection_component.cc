@@ -1,9 +1,13 @@
 #include "modules/perception/radar4d_detection/radar4d_detection_component.h"
 
+#include <cmath>
+
 #include "cyber/time/clock.h"
 #include "modules/common/util/perf_util.h"
 #include "modules/perception/common/algorithm/sensor_manager/sensor_manager.h"
+#include "modules/perception/common/algorithm/sensor_manager/sensor_registry.h"
 #include "modules/perception/common/onboard/common_flags/common_flags.h"
+#include "modules/perception/common/onboard/latency_tracer/latency_tracer.h"
 
 using Clock = apollo::cyber::Clock;
 
@@ -11,7 +15,44 @@ namespace apollo {
 namespace perception {
 namespace radar4d {
 
-std::atomic<uint32_t> Radar4dDectionComponent::seq_num_{0};
+std::atomic<uint32_t> Radar4dDetectionComponent::seq_num_{0};
+
+namespace {
+
+// radar coordinate to world coordinate, touches `object` only, so objects
+// may be converted on any thread with the same result
+void ObjectToWorld(const Eigen::Affine3d& radar_trans,
+                   const Eigen::Matrix3d& rotation, base::Object* object) {
+  object->center = radar_trans * object->center;
+  object->anchor_point = radar_trans * object->anchor_point;
+  for (auto& point : object->polygon) {
+    Eigen::Vector3d local(point.x, point.y, point.z);
+    Eigen::Vector3d world = radar_trans * local;
+    point.x = world(0);
+    point.y = world(1);
+    point.z = world(2);
+  }
+  object->velocity = (rotation * object->velocity.cast<double>()).cast<float>();
+  object->direction =
+      (rotation * object->direction.cast<double>()).cast<float>();
+  object->theta = std::atan2(object->direction(1), object->direction(0));
+}
+
+}  // namespace
+
+Radar4dDetectionComponent::~Radar4dDetectionComponent() {
+  if (batch_flush_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(batch_mutex_);
+      stop_batch_flush_ = true;
+    }
+    batch_cv_.notify_all();
+    batch_flush_thread_.join();
+  }
+  if (pipeline_ != nullptr) {
+    pipeline_->Stop();
+  }
+}
 
 bool Radar4dDetectionComponent::Init() {
   Radar4dDectionConfig comp_config;
@@ -19,15 +60,16 @@ bool Radar4dDetectionComponent::Init() {
     return false;
   }
   AINFO <<"Radar4d Detection Component Config: " << comp_config.DebugString();
-    tf_child_frame_id_ = comp_config.tf_child_frame_id();
   radar_forward_distance_ = comp_config.radar_forward_distance();
   odometry_channel_name_ = comp_config.odometry_channel_name();
+  batch_window_ = comp_config.batch_window();
+  publish_min_objects_ = comp_config.publish_min_objects();
+  if (comp_config.publish_threads() > 0) {
+    publish_pool_.reset(new ParallelFor(comp_config.publish_threads()));
+  }
 
-  // Load sensor info
-  if (!algorithm::SensorManager::Instance()->GetSensorInfo(
-          comp_config.radar_name(), &radar_info_)) {
-    AERROR << "Failed to get sensor info, sensor name: "
-           << comp_config.radar_name();
+  // Load sensor info and init transform of every radar
+  if (!InitSensors(comp_config)) {
     return false;
   }
 
@@ -39,20 +81,470 @@ bool Radar4dDetectionComponent::Init() {
   ACHECK(InitAlgorithmPlugin(comp_config))
       << "Failed to init algorithm plugin.";
 
-  // Init localization config
-  radar2world_trans_.Init(tf_child_frame_id_);
-  radar2novatel_trans_.Init(tf_child_frame_id_);
-  localization_subscriber_.Init(
-      odometry_channel_name_,
-      odometry_channel_name_ + '_' + comp_config.radar_name());
+  // Init localization config, a replay feeds it instead
+  if (!replay_) {
+    localization_buffer_.Init(
+        odometry_channel_name_,
+        odometry_channel_name_ + '_' + comp_config.radar_name(0));
+  }
+
+  // Init pipeline
+  if (comp_config.enable_pipeline() && !InitPipeline(comp_config)) {
+    AERROR << "Failed to init radar4d pipeline.";
+    return false;
+  }
+
+  if (sensors_.size() > 1) {
+    batch_flush_thread_ = std::thread([this] { BatchFlushLoop(); });
+  }
+
+  // Subscribe the other radars last, their callbacks use the plugins
+  for (size_t i = 1; i < sensors_.size() && !replay_; ++i) {
+    const std::string& channel_name =
+        comp_config.radar_channel_name(static_cast<int>(i - 1));
+    sensors_[i]->reader = node_->CreateReader<drivers::OculiiPointCloud>(
+        channel_name,
+        [this, i](const std::shared_ptr<drivers::OculiiPointCloud>& message) {
+          OnRadarMessage(i, message);
+        });
+    if (sensors_[i]->reader == nullptr) {
+      AERROR << "Failed to create reader of channel: " << channel_name;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Radar4dDetectionComponent::InitSensors(
+    const Radar4dDectionConfig& config) {
+  if (config.radar_name_size() == 0) {
+    AERROR << "No radar_name in config.";
+    return false;
+  }
+  if (config.radar_channel_name_size() + 1 != config.radar_name_size()) {
+    AERROR << "radar_channel_name is required for every radar except the "
+              "first one.";
+    return false;
+  }
+  for (int i = 0; i < config.radar_name_size(); ++i) {
+    std::unique_ptr<Radar4dSensorContext> sensor(new Radar4dSensorContext);
+    if (!algorithm::SensorManager::Instance()->GetSensorInfo(
+            config.radar_name(i), &sensor->radar_info)) {
+      AERROR << "Failed to get sensor info, sensor name: "
+             << config.radar_name(i);
+      return false;
+    }
+    sensor->sensor_id =
+        algorithm::SensorRegistry::Instance()->Register(sensor->radar_info);
+    if (sensor->sensor_id == base::kInvalidSensorId) {
+      AERROR << "Failed to register sensor " << config.radar_name(i);
+      return false;
+    }
+    sensor->tf_child_frame_id = i == 0 ? config.tf_child_frame_id()
+                                       : sensor->radar_info.frame_id;
+    sensor->radar2world_trans.Init(sensor->tf_child_frame_id);
+    sensor->radar2novatel_trans.Init(sensor->tf_child_frame_id);
+    sensors_.emplace_back(std::move(sensor));
+  }
   return true;
 }
 bool Radar4dDetectionComponent::Proc(const std::shared_ptr<drivers::OculiiPointCloud>& message) {
   AINFO << "Enter radar preprocess, message timestamp: "
         << message->header().timestamp_sec() << " current timestamp"
-        << Clock::NowInstance();
-  auto out_message = std::make_shared<onboard::SensorFrameMessage>()
+        << Clock::NowInSeconds();
+  if (sensors_.size() > 1) {
+    OnRadarMessage(0, message);
+    return true;
+  }
+
+  auto out_message = std::make_shared<onboard::SensorFrameMessage>();
+  onboard::LatencyTracer::Instance()->Enter(
+      out_message.get(), onboard::ProcessStage::LONG_RANGE_RADAR_DETECTION);
+  if (pipeline_ != nullptr) {
+    auto context = std::make_shared<Radar4dFrameContext>();
+    context->sensor = sensors_[0].get();
+    context->in_message = message;
+    context->out_message = out_message;
+    if (!pipeline_->Submit(context)) {
+      AWARN << "Radar4d pipeline is full, drop frame: "
+            << message->header().timestamp_sec();
+    }
+    return true;
+  }
+
+  if (!InternalProc(message, out_message)) {
+    return false;
+  }
+  WriteMessage(out_message);
+  AINFO << "Send radar processing output message.";
+  return true;
 }
+
+bool Radar4dDetectionComponent::InitAlgorithmPlugin(
+    const Radar4dDectionConfig& config) {
+  // Init preprocessor
+  auto preprocessor_param = config.preprocessor_param();
+  BasePreprocessor* radar_preprocessor =
+      BasePreprocessorRegisterer::GetInstanceByName(preprocessor_param.name());
+  CHECK_NOTNULL(radar_preprocessor);
+  radar_preprocessor_.reset(radar_preprocessor);
+
+  PreprocessorInitOptions preprocessor_init_options;
+  preprocessor_init_options.config_path = preprocessor_param.config_path();
+  preprocessor_init_options.config_file = preprocessor_param.config_file();
+  ACHECK(radar_preprocessor_->Init(preprocessor_init_options))
+      << "Failed to init radar preprocessor.";
+
+  // Init perception
+  auto perception_param = config.perception_param();
+  BaseRadarObstaclePerception* radar_perception =
+      BaseRadarObstaclePerceptionRegisterer::GetInstanceByName(
+          perception_param.name());
+  CHECK_NOTNULL(radar_perception);
+  radar_perception_.reset(radar_perception);
+
+  PerceptionInitOptions perception_init_options;
+  perception_init_options.config_path = perception_param.config_path();
+  perception_init_options.config_file = perception_param.config_file();
+  ACHECK(radar_perception_->Init(perception_init_options))
+      << "Failed to init radar perception.";
+
+  // Init hdmap
+  hdmap_input_ = map::HDMapInput::Instance();
+  ACHECK(hdmap_input_->Init()) << "Failed to init hdmap input.";
+  return true;
 }
+
+bool Radar4dDetectionComponent::InitPipeline(
+    const Radar4dDectionConfig& config) {
+  pipeline_.reset(
+      new StagePipeline<Radar4dFrameContext>(config.pipeline_queue_size()));
+  // A frame stopped by an early stage still goes through "publish", so the
+  // error code reaches the downstream just like the serial path.
+  pipeline_->AddStage(
+      "preprocess", [this](const std::shared_ptr<Radar4dFrameContext>& ctx) {
+        ctx->ok = PreprocessStage(ctx.get());
+        return true;
+      });
+  pipeline_->AddStage(
+      "perception", [this](const std::shared_ptr<Radar4dFrameContext>& ctx) {
+        ctx->ok = ctx->ok && PerceptionStage(ctx.get());
+        return true;
+      });
+  pipeline_->AddStage(
+      "publish", [this](const std::shared_ptr<Radar4dFrameContext>& ctx) {
+        if (ctx->ok) {
+          PublishStage(ctx.get());
+        }
+        WriteMessage(ctx->out_message);
+        return true;
+      });
+  return pipeline_->Start();
 }
-}
\ No newline at end of file
+
+bool Radar4dDetectionComponent::InternalProc(
+    const std::shared_ptr<const drivers::OculiiPointCloud>& in_message,
+    std::shared_ptr<onboard::SensorFrameMessage> out_message) {
+  PERF_FUNCTION_WITH_INDICATOR(sensors_[0]->radar_info.name);
+  Radar4dFrameContext context;
+  context.sensor = sensors_[0].get();
+  context.in_message = in_message;
+  context.out_message = out_message;
+  if (PreprocessStage(&context) && PerceptionStage(&context)) {
+    return PublishStage(&context);
+  }
+  return true;
+}
+
+void Radar4dDetectionComponent::FeedRadar(
+    size_t sensor_index,
+    const std::shared_ptr<drivers::OculiiPointCloud>& message) {
+  if (sensor_index == 0) {
+    Proc(message);
+  } else if (sensor_index < sensors_.size()) {
+    OnRadarMessage(sensor_index, message);
+  } else {
+    AERROR << "Unknown radar index " << sensor_index;
+  }
+}
+
+void Radar4dDetectionComponent::OnRadarMessage(
+    size_t sensor_index,
+    const std::shared_ptr<drivers::OculiiPointCloud>& message) {
+  auto context = std::make_shared<Radar4dFrameContext>();
+  context->sensor = sensors_[sensor_index].get();
+  context->in_message = message;
+  context->out_message = std::make_shared<onboard::SensorFrameMessage>();
+  onboard::LatencyTracer::Instance()->Enter(
+      context->out_message.get(),
+      onboard::ProcessStage::LONG_RANGE_RADAR_DETECTION);
+  const double timestamp = message->header().timestamp_sec();
+  const auto now = std::chrono::steady_clock::now();
+
+  std::vector<std::shared_ptr<Radar4dFrameContext>> batch;
+  std::unique_lock<std::mutex> proc_lock(proc_mutex_, std::defer_lock);
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    // A second scan of a waiting radar, a scan out of the window or a batch
+    // past its deadline starts a new cycle, the waiting scans are processed
+    // without the missing radars.
+    bool new_cycle = !pending_batch_.empty() && now >= batch_deadline_;
+    for (const auto& pending : pending_batch_) {
+      if (pending->sensor == context->sensor ||
+          std::fabs(timestamp - pending->in_message->header().timestamp_sec()) >
+              batch_window_) {
+        new_cycle = true;
+        break;
+      }
+    }
+    if (new_cycle) {
+      batch.swap(pending_batch_);
+    }
+    if (pending_batch_.empty()) {
+      batch_deadline_ =
+          now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(batch_window_));
+      batch_cv_.notify_all();
+    }
+    pending_batch_.push_back(context);
+    if (pending_batch_.size() == sensors_.size()) {
+      batch.swap(pending_batch_);
+    }
+    // take the proc lock before releasing the batch lock to keep cycle order
+    if (!batch.empty()) {
+      proc_lock.lock();
+    }
+  }
+  if (!batch.empty()) {
+    ProcessBatch(batch);
+  }
+}
+
+void Radar4dDetectionComponent::FlushPendingBatch() {
+  std::vector<std::shared_ptr<Radar4dFrameContext>> batch;
+  std::unique_lock<std::mutex> proc_lock(proc_mutex_, std::defer_lock);
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    if (pending_batch_.empty()) {
+      return;
+    }
+    batch.swap(pending_batch_);
+    proc_lock.lock();
+  }
+  ProcessBatch(batch);
+}
+
+void Radar4dDetectionComponent::BatchFlushLoop() {
+  std::unique_lock<std::mutex> lock(batch_mutex_);
+  while (!stop_batch_flush_) {
+    if (pending_batch_.empty()) {
+      batch_cv_.wait(lock);
+      continue;
+    }
+    if (std::chrono::steady_clock::now() < batch_deadline_) {
+      // a new first scan moves the deadline and wakes us
+      batch_cv_.wait_until(lock, batch_deadline_);
+      continue;
+    }
+    std::vector<std::shared_ptr<Radar4dFrameContext>> batch;
+    batch.swap(pending_batch_);
+    // same order as OnRadarMessage, the proc lock before the batch lock is
+    // released
+    std::unique_lock<std::mutex> proc_lock(proc_mutex_);
+    lock.unlock();
+    ProcessBatch(batch);
+    proc_lock.unlock();
+    lock.lock();
+  }
+}
+
+void Radar4dDetectionComponent::ProcessBatch(
+    const std::vector<std::shared_ptr<Radar4dFrameContext>>& batch) {
+  if (pipeline_ != nullptr) {
+    for (const auto& context : batch) {
+      if (!pipeline_->Submit(context)) {
+        AWARN << "Radar4d pipeline is full, drop frame of "
+              << context->sensor->radar_info.name;
+      }
+    }
+    return;
+  }
+
+  // Run the batch stage by stage, so each plugin handles all scans of the
+  // cycle back to back and its model data stays hot in cache.
+  for (const auto& context : batch) {
+    context->ok = PreprocessStage(context.get());
+  }
+  for (const auto& context : batch) {
+    context->ok = context->ok && PerceptionStage(context.get());
+  }
+  for (const auto& context : batch) {
+    if (context->ok) {
+      PublishStage(context.get());
+    }
+    WriteMessage(context->out_message);
+  }
+}
+
+void Radar4dDetectionComponent::WriteMessage(
+    const std::shared_ptr<onboard::SensorFrameMessage>& out_message) {
+  onboard::LatencyTracer::Instance()->Exit(
+      out_message.get(), onboard::ProcessStage::LONG_RANGE_RADAR_DETECTION);
+  if (publish_callback_) {
+    publish_callback_(out_message);
+    return;
+  }
+  writer_->Write(out_message);
+}
+
+bool Radar4dDetectionComponent::PreprocessStage(Radar4dFrameContext* context) {
+  Radar4dSensorContext* sensor = context->sensor;
+  const auto& in_message = context->in_message;
+  auto& out_message = context->out_message;
+  const double timestamp = in_message->header().timestamp_sec();
+  const double cur_time = Clock::NowInSeconds();
+  const double start_latency = (cur_time - timestamp) * 1e3;
+  AINFO << "FRAME_STATISTICS:Radar:Start:msg_time["
+        << std::to_string(timestamp) << "]:cur_time["
+        << std::to_string(cur_time) << "]:cur_latency[" << start_latency
+        << "]";
+
+  context->timestamp = timestamp;
+  out_message->timestamp_ = timestamp;
+  out_message->seq_num_ = seq_num_.fetch_add(1);
+  out_message->process_stage_ = onboard::ProcessStage::LONG_RANGE_RADAR_DETECTION;
+  out_message->sensor_id_ = sensor->radar_info.name;
+  out_message->sensor_index_ = sensor->sensor_id;
+
+  // Get radar2world and radar2novatel transform
+  if (!sensor->radar2world_trans.GetSensor2worldTrans(timestamp,
+                                                      &context->radar_trans)) {
+    out_message->error_code_ = apollo::common::ErrorCode::PERCEPTION_ERROR_TF;
+    AERROR << "Failed to get pose at time: " << timestamp;
+    return false;
+  }
+  Eigen::Affine3d radar2novatel_trans;
+  if (!sensor->radar2novatel_trans.GetTrans(timestamp, &radar2novatel_trans,
+                                            "novatel",
+                                            sensor->tf_child_frame_id)) {
+    out_message->error_code_ = apollo::common::ErrorCode::PERCEPTION_ERROR_TF;
+    AERROR << "Failed to get radar2novatel trans at time: " << timestamp;
+    return false;
+  }
+  context->radar2novatel_trans = radar2novatel_trans.matrix();
+
+  // Get car localization speed
+  Eigen::Vector3f car_linear_speed = Eigen::Vector3f::Zero();
+  Eigen::Vector3f car_angular_speed = Eigen::Vector3f::Zero();
+  if (!GetCarLocalizationSpeed(timestamp, &car_linear_speed,
+                               &car_angular_speed)) {
+    AERROR << "Failed to call get_car_speed. [timestamp: " << timestamp;
+    return false;
+  }
+
+  // Preprocess
+  PreprocessorOptions preprocessor_options;
+  preprocessor_options.radar2world_pose = &context->radar_trans;
+  preprocessor_options.radar2novatel_trans = &context->radar2novatel_trans;
+  preprocessor_options.car_linear_speed = car_linear_speed;
+  preprocessor_options.car_angular_speed = car_angular_speed;
+  context->radar_frame = std::make_shared<RadarFrame>();
+  context->radar_frame->sensor_info = sensor->radar_info;
+  context->radar_frame->timestamp = timestamp;
+  context->radar_frame->radar2world_pose = context->radar_trans;
+  if (!radar_preprocessor_->Preprocess(in_message, preprocessor_options,
+                                       context->radar_frame)) {
+    out_message->error_code_ =
+        apollo::common::ErrorCode::PERCEPTION_ERROR_PROCESS;
+    AERROR << "Failed to preprocess radar frame at time: " << timestamp;
+    return false;
+  }
+  return true;
+}
+
+bool Radar4dDetectionComponent::PerceptionStage(Radar4dFrameContext* context) {
+  RadarPerceptionOptions options;
+  options.sensor_name = context->sensor->radar_info.name;
+  options.detector_options.radar2world_pose = &context->radar_trans;
+  options.detector_options.radar2novatel_trans = &context->radar2novatel_trans;
+  options.roi_filter_options.roi.reset(new base::HdmapStruct());
+  if (hdmap_input_ != nullptr) {
+    base::PointD position;
+    position.x = context->radar_trans(0, 3);
+    position.y = context->radar_trans(1, 3);
+    position.z = context->radar_trans(2, 3);
+    hdmap_input_->GetRoiHDMapStruct(position, radar_forward_distance_,
+                                    options.roi_filter_options.roi);
+  }
+
+  context->radar_objects.clear();
+  if (!radar_perception_->Perceive(context->radar_frame.get(), options,
+                                   &context->radar_objects)) {
+    context->out_message->error_code_ =
+        apollo::common::ErrorCode::PERCEPTION_ERROR_PROCESS;
+    AERROR << "RadarDetector Proc failed.";
+    return false;
+  }
+  return true;
+}
+
+bool Radar4dDetectionComponent::PublishStage(Radar4dFrameContext* context) {
+  auto& out_message = context->out_message;
+  out_message->frame_.reset(new base::Frame());
+  out_message->frame_->sensor_info = context->sensor->radar_info;
+  out_message->frame_->timestamp = context->timestamp;
+  out_message->frame_->sensor2world_pose = context->radar_trans;
+
+  // Convert objects from radar coordinate to world coordinate
+  const Eigen::Affine3d& radar_trans = context->radar_trans;
+  const Eigen::Matrix3d rotation = radar_trans.linear();
+  auto& objects = context->radar_objects;
+  auto convert = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ObjectToWorld(radar_trans, rotation, objects[i].get());
+    }
+  };
+  if (publish_pool_ != nullptr) {
+    publish_pool_->Run(objects.size(), publish_min_objects_, convert);
+  } else {
+    convert(0, objects.size());
+  }
+  out_message->frame_->objects = context->radar_objects;
+
+  const double end_timestamp = Clock::NowInSeconds();
+  const double end_latency = (end_timestamp - context->timestamp) * 1e3;
+  AINFO << "FRAME_STATISTICS:Radar:End:msg_time["
+        << std::to_string(context->timestamp) << "]:cur_time["
+        << std::to_string(end_timestamp) << "]:cur_latency[" << end_latency
+        << "]";
+  return true;
+}
+
+bool Radar4dDetectionComponent::GetCarLocalizationSpeed(
+    double timestamp, Eigen::Vector3f* car_linear_speed,
+    Eigen::Vector3f* car_angular_speed) {
+  if (car_linear_speed == nullptr) {
+    AERROR << "car_linear_speed is not available";
+    return false;
+  }
+  (*car_linear_speed) = Eigen::Vector3f::Zero();
+
+  if (car_angular_speed == nullptr) {
+    AERROR << "car_angular_speed is not available";
+    return false;
+  }
+  (*car_angular_speed) = Eigen::Vector3f::Zero();
+
+  onboard::LocalizationVelocity velocity;
+  if (!localization_buffer_.LookupInterpolated(timestamp, &velocity)) {
+    AERROR << "Cannot get car speed.";
+    return false;
+  }
+  (*car_linear_speed) = velocity.linear_velocity;
+  (*car_angular_speed) = velocity.angular_velocity;
+  return true;
+}
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
@@ -1,58 +1,168 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "Eigen/Dense"
+
+#include "cyber/component/component.h"
+#include "modules/common_msgs/localization_msgs/localization.pb.h"
+#include "modules/common_msgs/sensor_msgs/oculii_radar.pb.h"
+#include "modules/perception/radar4d_detection/proto/radar4d_component_config.pb.h"
+
 #include "modules/perception/common/base/sensor_meta.h"
+#include "modules/perception/common/hdmap/hdmap_input.h"
+#include "modules/perception/common/onboard/inner_component_messages.h/inner_component_messages.h"
+#include "modules/perception/common/onboard/msg_buffer/localization_buffer.h"
+#include "modules/perception/common/onboard/transform_wrapper/transform_wrapper.h"
+#include "modules/perception/radar4d_detection/common/parallel_for.h"
+#include "modules/perception/radar4d_detection/common/stage_pipeline.h"
+#include "modules/perception/radar4d_detection/interface/base_preprocessor.h"
+#include "modules/perception/radar4d_detection/interface/base_radar_obstacle_perception.h"
+
 namespace apollo {
 namespace perception {
 namespace radar4d {
- 
+
 using apollo::drivers::OculiiPointCloud;
-using apollo::localization::LoacalizationEstimate;
+using apollo::localization::LocalizationEstimate;
+
+/**
+ * @brief Per radar state, the algorithm plugins are shared by all radars
+ */
+struct Radar4dSensorContext {
+  base::SensorInfo radar_info;
+  base::SensorId sensor_id = base::kInvalidSensorId;
+  std::string tf_child_frame_id;
+  onboard::TransformWrapper radar2world_trans;
+  onboard::TransformWrapper radar2novatel_trans;
+  // null for the first radar, which is read through the component channel
+  std::shared_ptr<cyber::Reader<drivers::OculiiPointCloud>> reader;
+};
 
-class Radar4dDectionComponent : public cyber::Component<drivers::OculiiPointCloud> {
+/**
+ * @brief Intermediate state of one radar frame, handed from stage to stage
+ */
+struct Radar4dFrameContext {
+  Radar4dSensorContext* sensor = nullptr;
+  std::shared_ptr<const drivers::OculiiPointCloud> in_message;
+  std::shared_ptr<onboard::SensorFrameMessage> out_message;
+  std::shared_ptr<RadarFrame> radar_frame;
+  double timestamp = 0.0;
+  Eigen::Affine3d radar_trans = Eigen::Affine3d::Identity();
+  Eigen::Matrix4d radar2novatel_trans = Eigen::Matrix4d::Identity();
+  std::vector<base::ObjectPtr> radar_objects;
+  // false once a stage failed, the later stages are skipped
+  bool ok = true;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+class Radar4dDetectionComponent : public cyber::Component<drivers::OculiiPointCloud> {
   public:
     Radar4dDetectionComponent()
-        : tf_child_frame_id_(""),
-          radar_forword_distance_(200.0),
+        : radar_forward_distance_(200.0),
+          batch_window_(0.0),
+          publish_min_objects_(32),
           odometry_channel_name_(""),
           hdmap_input_(nullptr),
           radar_preprocessor_(nullptr),
           radar_perception_(nullptr) {}
-    ~Radar4dDectionComponent() = default;
+    ~Radar4dDetectionComponent();
 
     bool Init() override;
-    bool Proc(const std::shared_ptr<drivers::OculiipointCloud>& message) override;
+    bool Proc(const std::shared_ptr<drivers::OculiiPointCloud>& message) override;
+
+    // Replay tools drive the component without a live vehicle: outputs go to
+    // the callback instead of the writer and localization is fed directly.
+    // Set before Initialize, a replay subscribes neither localization nor
+    // the other radars, FeedLocalization is then the only buffer writer.
+    void SetReplayMode(bool replay) { replay_ = replay; }
+    using PublishCallback = std::function<void(
+        const std::shared_ptr<onboard::SensorFrameMessage>&)>;
+    void SetPublishCallback(const PublishCallback& callback) {
+      publish_callback_ = callback;
+    }
+    void FeedLocalization(const LocalizationEstimate& message) {
+      localization_buffer_.Push(message);
+    }
+    // scan of the radar_name(sensor_index) in config, 0 is the same as Proc
+    void FeedRadar(size_t sensor_index,
+                   const std::shared_ptr<drivers::OculiiPointCloud>& message);
+    // multi radar mode, process the scans still waiting for their cycle,
+    // e.g. at the end of a replay
+    void FlushPendingBatch();
 
   private:
-    bool InitAlgotithmPlugin(const Radar4dDectionConfig& config);
-    bool InternalProc(const std::shared_ptr<const driver::OculiiPointCloud>& in_message,
+    bool InitSensors(const Radar4dDectionConfig& config);
+    bool InitAlgorithmPlugin(const Radar4dDectionConfig& config);
+    bool InitPipeline(const Radar4dDectionConfig& config);
+    bool InternalProc(const std::shared_ptr<const drivers::OculiiPointCloud>& in_message,
                       std::shared_ptr<onboard::SensorFrameMessage> out_message);
+    // multi radar mode, collect the scans of one cycle and run them together
+    void OnRadarMessage(size_t sensor_index,
+                        const std::shared_ptr<drivers::OculiiPointCloud>& message);
+    void ProcessBatch(
+        const std::vector<std::shared_ptr<Radar4dFrameContext>>& batch);
+    // flushes a pending batch once it waited batch_window_, so a silent
+    // radar does not hold back the scans of the others
+    void BatchFlushLoop();
+    // stages of InternalProc, also run by pipeline_ when it is enabled
+    bool PreprocessStage(Radar4dFrameContext* context);
+    bool PerceptionStage(Radar4dFrameContext* context);
+    bool PublishStage(Radar4dFrameContext* context);
+    // the frame leaves LONG_RANGE_RADAR_DETECTION here
+    void WriteMessage(
+        const std::shared_ptr<onboard::SensorFrameMessage>& out_message);
     bool GetCarLocalizationSpeed(double timestamp,
-                                 Eigen::Vetor3f* car_linear_speed,
+                                 Eigen::Vector3f* car_linear_speed,
                                  Eigen::Vector3f* car_angular_speed);
     Radar4dDetectionComponent(const Radar4dDetectionComponent&) = delete;
-    Radar4dDetectionComponent& operator=(const Radar4dDectionComponent&) = delete;
+    Radar4dDetectionComponent& operator=(const Radar4dDetectionComponent&) = delete;
 
   private:
-    static std::atomic<uint32_t> seq_num;
+    static std::atomic<uint32_t> seq_num_;
 
-    base::SensorInfo radar_info_;
-    std::string tf_child_frame_id_;
-    double radar_forward_distance;
+    // one entry per radar_name in config, sensors_[0] is the component channel
+    std::vector<std::unique_ptr<Radar4dSensorContext>> sensors_;
+    double radar_forward_distance_;
+    double batch_window_;
+    size_t publish_min_objects_;
     std::string odometry_channel_name_;
+    bool replay_ = false;
 
-    onboard::TransformWraper radar2world_trans_;
-    onboard::TransformWraper radar2novatel_trans_
     map::HDMapInput* hdmap_input_;
     std::shared_ptr<BasePreprocessor> radar_preprocessor_;
     std::shared_ptr<BaseRadarObstaclePerception> radar_perception_;
-    onboard::MsgBuffer<LocalizationEstimate> localization_subscriber_;
-    std::shared_ptr<apollo::cyber::Write<onboard::Sensor::SensorFrameMessage>> writer_;
+    onboard::LocalizationBuffer localization_buffer_;
+    std::shared_ptr<apollo::cyber::Writer<onboard::SensorFrameMessage>> writer_;
+    PublishCallback publish_callback_;
+
+    // scans waiting for the rest of their cycle, at most one per radar
+    std::vector<std::shared_ptr<Radar4dFrameContext>> pending_batch_;
+    // when the first scan of pending_batch_ arrived plus batch_window_
+    std::chrono::steady_clock::time_point batch_deadline_;
+    std::mutex batch_mutex_;
+    std::condition_variable batch_cv_;
+    bool stop_batch_flush_ = false;
+    std::thread batch_flush_thread_;
+    // the plugins are not reentrant, serialize the readers of all radars
+    std::mutex proc_mutex_;
+
+    // preprocess -> perception -> publish, nullptr when running serially
+    std::unique_ptr<StagePipeline<Radar4dFrameContext>> pipeline_;
+    // converts the objects of a frame to world in parallel, nullptr when
+    // publish_threads is 0
+    std::unique_ptr<ParallelFor> publish_pool_;
 };
-CYBER_REGISTER_COMPONENT(Radar4DDetectionComponent);
+CYBER_REGISTER_COMPONENT(Radar4dDetectionComponent);
 }
 }
 }
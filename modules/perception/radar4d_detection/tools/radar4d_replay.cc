@@ -0,0 +1,354 @@
+// Replays a cyber record through Radar4dDetectionComponent without a live
+// system and reports throughput, per frame latency and allocations.
+//
+//   radar4d_replay --record_file=demo.record \
+//       --component_config=radar4d_detection_config.pb.txt --replay_rate=0
+//
+// Scans of the configured radar channels are handed to the component on the
+// replay thread, localization goes straight into its buffer and /tf,
+// /tf_static go straight into the transform buffer, so a replay does not
+// depend on the cyber scheduler. The component runs in replay mode and does
+// not subscribe the live localization and radar channels. Outputs are
+// captured by a publish callback.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "cyber/common/file.h"
+#include "cyber/common/log.h"
+#include "cyber/cyber.h"
+#include "cyber/proto/component_conf.pb.h"
+#include "cyber/record/record_reader.h"
+#include "modules/common_msgs/transform_msgs/transform.pb.h"
+#include "modules/transform/buffer.h"
+#include "modules/perception/radar4d_detection/radar4d_detection_component.h"
+
+DEFINE_string(record_file, "", "record with radar, localization and tf");
+DEFINE_string(component_config, "",
+              "Radar4dDectionConfig text proto used by the component");
+DEFINE_string(localization_channel, "/apollo/localization/pose",
+              "localization channel in the record");
+DEFINE_string(radar_channel, "/apollo/sensor/oculii/PointCloud2",
+              "channel of the first radar, the others come from the config");
+DEFINE_double(replay_rate, 0.0,
+              "1.0 replays at the recorded rate, 0 as fast as possible");
+DEFINE_int32(warmup_frames, 10, "frames excluded from the statistics");
+DEFINE_string(report_file, "", "also write the report to this file");
+
+// Allocations are counted on the pipeline threads of the component and on
+// the replay thread while it is inside the component. Reading and parsing
+// the record and collecting the outputs are the harness and not counted.
+namespace {
+std::atomic<uint64_t> g_allocation_count{0};
+thread_local bool t_count_allocations = true;
+
+class AllocationCounting {
+ public:
+  explicit AllocationCounting(bool enabled) : previous_(t_count_allocations) {
+    t_count_allocations = enabled;
+  }
+  ~AllocationCounting() { t_count_allocations = previous_; }
+
+ private:
+  const bool previous_;
+};
+}  // namespace
+
+void* operator new(size_t size) {
+  if (t_count_allocations) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace apollo {
+namespace perception {
+namespace radar4d {
+
+using Clock = std::chrono::steady_clock;
+
+class Radar4dReplay {
+ public:
+  bool Init();
+  bool Run();
+
+ private:
+  void OnPublish(const std::shared_ptr<onboard::SensorFrameMessage>& message);
+  void FeedTransform(const transform::TransformStampeds& message,
+                     bool is_static);
+  void WaitForRecordTime(uint64_t record_time_ns);
+  std::string Report() const;
+
+  std::shared_ptr<Radar4dDetectionComponent> component_;
+  // radar channel -> index of the radar in the component config
+  std::map<std::string, size_t> radar_channels_;
+  // radar_name of the config, the sensor_id_ of the outputs
+  std::vector<std::string> radar_names_;
+
+  std::mutex mutex_;
+  // (sensor, scan timestamp) -> when it was handed to the component, radars
+  // of one cycle may share a timestamp
+  std::map<std::pair<std::string, double>, Clock::time_point> in_flight_;
+  std::vector<double> latencies_ms_;
+  uint64_t published_ = 0;
+  uint64_t fed_ = 0;
+  Clock::time_point last_publish_time_;
+
+  Clock::time_point replay_start_;
+  uint64_t first_record_time_ns_ = 0;
+  Clock::time_point measure_start_;
+  uint64_t measure_start_allocations_ = 0;
+  double elapsed_s_ = 0.0;
+  uint64_t allocations_ = 0;
+};
+
+bool Radar4dReplay::Init() {
+  Radar4dDectionConfig config;
+  if (!cyber::common::GetProtoFromFile(FLAGS_component_config, &config)) {
+    AERROR << "Failed to load component config " << FLAGS_component_config;
+    return false;
+  }
+  radar_channels_[FLAGS_radar_channel] = 0;
+  for (int i = 0; i < config.radar_channel_name_size(); ++i) {
+    radar_channels_[config.radar_channel_name(i)] = i + 1;
+  }
+  radar_names_.assign(config.radar_name().begin(), config.radar_name().end());
+
+  cyber::proto::ComponentConfig component_config;
+  component_config.set_name("radar4d_replay");
+  component_config.set_config_file_path(FLAGS_component_config);
+  component_config.add_readers()->set_channel(FLAGS_radar_channel);
+  component_ = std::make_shared<Radar4dDetectionComponent>();
+  component_->SetReplayMode(true);
+  component_->SetPublishCallback(
+      [this](const std::shared_ptr<onboard::SensorFrameMessage>& message) {
+        OnPublish(message);
+      });
+  if (!component_->Initialize(component_config)) {
+    AERROR << "Failed to init Radar4dDetectionComponent.";
+    return false;
+  }
+  return true;
+}
+
+bool Radar4dReplay::Run() {
+  cyber::record::RecordReader reader(FLAGS_record_file);
+  if (!reader.IsValid()) {
+    AERROR << "Failed to open record " << FLAGS_record_file;
+    return false;
+  }
+  AllocationCounting harness(false);
+  replay_start_ = Clock::now();
+  measure_start_ = replay_start_;
+  cyber::record::RecordMessage record_message;
+  while (reader.ReadMessage(&record_message)) {
+    const std::string& channel = record_message.channel_name;
+    if (channel == FLAGS_localization_channel) {
+      LocalizationEstimate localization;
+      if (localization.ParseFromString(record_message.content)) {
+        component_->FeedLocalization(localization);
+      }
+      continue;
+    }
+    if (channel == "/tf" || channel == "/tf_static") {
+      transform::TransformStampeds transforms;
+      if (transforms.ParseFromString(record_message.content)) {
+        FeedTransform(transforms, channel == "/tf_static");
+      }
+      continue;
+    }
+    auto radar = radar_channels_.find(channel);
+    if (radar == radar_channels_.end() ||
+        radar->second >= radar_names_.size()) {
+      continue;
+    }
+    auto scan = std::make_shared<drivers::OculiiPointCloud>();
+    if (!scan->ParseFromString(record_message.content)) {
+      AWARN << "Failed to parse scan on " << channel;
+      continue;
+    }
+    WaitForRecordTime(record_message.time);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (fed_ == static_cast<uint64_t>(FLAGS_warmup_frames)) {
+        latencies_ms_.clear();
+        published_ = 0;
+        measure_start_ = Clock::now();
+        measure_start_allocations_ =
+            g_allocation_count.load(std::memory_order_relaxed);
+      }
+      ++fed_;
+      in_flight_[{radar_names_[radar->second],
+                  scan->header().timestamp_sec()}] = Clock::now();
+    }
+    {
+      AllocationCounting component(true);
+      component_->FeedRadar(radar->second, scan);
+    }
+  }
+  {
+    // the last cycle has no next scan to close it
+    AllocationCounting component(true);
+    component_->FlushPendingBatch();
+  }
+
+  // The pipeline may still hold the last frames. Frames the component drops
+  // or fails never come out, so stop once nothing was published for a while.
+  uint64_t last_published = 0;
+  auto last_progress = Clock::now();
+  while (Clock::now() - last_progress < std::chrono::milliseconds(500)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (in_flight_.empty()) {
+        break;
+      }
+      if (published_ != last_published) {
+        last_published = published_;
+        last_progress = Clock::now();
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    elapsed_s_ = std::chrono::duration<double>(last_publish_time_ -
+                                               measure_start_)
+                     .count();
+  }
+  allocations_ = g_allocation_count.load(std::memory_order_relaxed) -
+                 measure_start_allocations_;
+
+  const std::string report = Report();
+  std::cout << report;
+  if (!FLAGS_report_file.empty()) {
+    std::ofstream(FLAGS_report_file) << report;
+  }
+  return true;
+}
+
+void Radar4dReplay::OnPublish(
+    const std::shared_ptr<onboard::SensorFrameMessage>& message) {
+  // called on the last pipeline thread
+  AllocationCounting harness(false);
+  const auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = in_flight_.find({message->sensor_id_, message->timestamp_});
+  if (iter == in_flight_.end()) {
+    return;
+  }
+  latencies_ms_.push_back(
+      std::chrono::duration<double, std::milli>(now - iter->second).count());
+  in_flight_.erase(iter);
+  ++published_;
+  last_publish_time_ = now;
+}
+
+// the same conversion as the /tf subscription of transform::Buffer
+void Radar4dReplay::FeedTransform(const transform::TransformStampeds& message,
+                                  bool is_static) {
+  for (const auto& transform : message.transforms()) {
+    geometry_msgs::TransformStamped stamped;
+    stamped.header.stamp = static_cast<uint64_t>(
+        transform.header().timestamp_sec() * 1e9);
+    stamped.header.frame_id = transform.header().frame_id();
+    stamped.header.seq = transform.header().sequence_num();
+    stamped.child_frame_id = transform.child_frame_id();
+    stamped.transform.translation.x = transform.transform().translation().x();
+    stamped.transform.translation.y = transform.transform().translation().y();
+    stamped.transform.translation.z = transform.transform().translation().z();
+    stamped.transform.rotation.x = transform.transform().rotation().qx();
+    stamped.transform.rotation.y = transform.transform().rotation().qy();
+    stamped.transform.rotation.z = transform.transform().rotation().qz();
+    stamped.transform.rotation.w = transform.transform().rotation().qw();
+    transform::Buffer::Instance()->setTransform(stamped, "radar4d_replay",
+                                                is_static);
+  }
+}
+
+void Radar4dReplay::WaitForRecordTime(uint64_t record_time_ns) {
+  if (FLAGS_replay_rate <= 0.0) {
+    return;
+  }
+  if (first_record_time_ns_ == 0) {
+    first_record_time_ns_ = record_time_ns;
+    replay_start_ = Clock::now();
+    return;
+  }
+  const double offset_s =
+      static_cast<double>(record_time_ns - first_record_time_ns_) * 1e-9 /
+      FLAGS_replay_rate;
+  std::this_thread::sleep_until(
+      replay_start_ + std::chrono::duration_cast<Clock::duration>(
+                          std::chrono::duration<double>(offset_s)));
+}
+
+std::string Radar4dReplay::Report() const {
+  std::vector<double> latencies = latencies_ms_;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    if (latencies.empty()) {
+      return 0.0;
+    }
+    const size_t index = std::min(
+        latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+    return latencies[index];
+  };
+  const uint64_t measured =
+      fed_ > static_cast<uint64_t>(FLAGS_warmup_frames)
+          ? fed_ - FLAGS_warmup_frames
+          : 0;
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3)
+      << "frames_fed: " << measured << "\n"
+      << "frames_published: " << published_ << "\n"
+      << "frames_dropped: " << measured - std::min(measured, published_)
+      << "\n"
+      << "frames_per_second: "
+      << (elapsed_s_ > 0.0 ? published_ / elapsed_s_ : 0.0) << "\n"
+      << "latency_p50_ms: " << percentile(0.5) << "\n"
+      << "latency_p90_ms: " << percentile(0.9) << "\n"
+      << "latency_p99_ms: " << percentile(0.99) << "\n"
+      << "latency_max_ms: " << (latencies.empty() ? 0.0 : latencies.back())
+      << "\n"
+      << "allocations_per_frame: "
+      << (measured > 0 ? static_cast<double>(allocations_) / measured : 0.0)
+      << "\n";
+  return out.str();
+}
+
+}  // namespace radar4d
+}  // namespace perception
+}  // namespace apollo
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  apollo::cyber::Init(argv[0]);
+  apollo::perception::radar4d::Radar4dReplay replay;
+  const bool ok = replay.Init() && replay.Run();
+  apollo::cyber::Clear();
+  return ok ? 0 : 1;
+}